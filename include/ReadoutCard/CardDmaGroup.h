@@ -0,0 +1,134 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file CardDmaGroup.h
+/// \brief Definition of the CardDmaGroup class.
+
+#ifndef O2_READOUTCARD_INCLUDE_CARDDMAGROUP_H_
+#define O2_READOUTCARD_INCLUDE_CARDDMAGROUP_H_
+
+#include "ReadoutCard/NamespaceAlias.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <boost/optional.hpp>
+#include "ReadoutCard/DmaChannelInterface.h"
+#include "ReadoutCard/Parameters.h"
+#include "ReadoutCard/ParameterTypes/PciAddress.h"
+#include "ReadoutCard/ParameterTypes/WaitPolicy.h"
+#include "ReadoutCard/Superpage.h"
+
+namespace o2
+{
+namespace roc
+{
+
+struct CardDmaGroupInternal;
+
+/// Drives a set of DMA channels, such as both endpoints of several CRUs, from a single thread, and merges their
+/// ready superpages into one queue.
+///
+/// While DMA is running, the group's poller thread is the only one calling into the channels. The user pushes
+/// superpages to a channel through the group, and pops the filled superpages of all channels from the group, tagged
+/// with the channel they came from. Links are given by Superpage::getLink().
+///
+/// pushSuperpage(), tryPopSuperpage() and waitForReady() must be called from a single thread.
+class CardDmaGroup
+{
+ public:
+  /// How the poller thread picks the channels to poll
+  struct PollPolicy {
+    enum type {
+      RoundRobin, ///< Every channel with superpages in flight is polled on each pass
+      Readiness,  ///< Channels that had nothing ready are polled less and less often, until they do again
+    };
+  };
+
+  struct Options {
+    PollPolicy::type pollPolicy = PollPolicy::RoundRobin;
+    /// Backoff of the poller thread while no channel has work, and of waitForReady()
+    WaitPolicy waitPolicy;
+    /// CPU to pin the poller thread to, or -1 to leave it unpinned
+    int cpu = -1;
+    /// Capacity of the push queue of each channel, and of the merged ready queue
+    uint32_t queueCapacity = 4096;
+  };
+
+  /// A ready superpage, with the channel it came from
+  struct ReadySuperpage {
+    size_t channel;        ///< Index of the channel in the group
+    PciAddress pciAddress; ///< PCI address of the channel's endpoint
+    Superpage superpage;   ///< The superpage, filled by the link given by Superpage::getLink()
+  };
+
+  /// Counters of the poller thread
+  struct Statistics {
+    uint64_t passes = 0;              ///< Passes over the channels
+    uint64_t channelPolls = 0;        ///< Channels polled
+    uint64_t channelSkips = 0;        ///< Channels skipped by the Readiness policy
+    uint64_t superpagesPushed = 0;    ///< Superpages pushed to the channels
+    uint64_t superpagesDelivered = 0; ///< Superpages moved to the merged ready queue
+  };
+
+  /// Creates a group of channels that were already opened
+  CardDmaGroup(std::vector<std::shared_ptr<DmaChannelInterface>> channels, Options options);
+  CardDmaGroup(std::vector<std::shared_ptr<DmaChannelInterface>> channels);
+
+  /// Opens a channel for each of the given parameters with the ChannelFactory, and groups them
+  CardDmaGroup(const std::vector<Parameters>& parameters, Options options);
+  CardDmaGroup(const std::vector<Parameters>& parameters);
+
+  /// Stops DMA if it is running
+  ~CardDmaGroup();
+
+  CardDmaGroup(const CardDmaGroup&) = delete;
+  CardDmaGroup& operator=(const CardDmaGroup&) = delete;
+
+  /// Starts DMA on every channel, then the poller thread
+  void startDma();
+
+  /// Stops the poller thread, then DMA on every channel. The superpages still in the channels or in the group's
+  /// queues can be popped afterwards, the unfilled ones not being ready.
+  /// Rethrows the exception that stopped the poller thread, if any.
+  void stopDma();
+
+  /// Queues a superpage to be pushed to a channel by the poller thread
+  /// \param channel Index of the channel in the group
+  /// \return False if DMA is not running or the channel's push queue is full
+  bool pushSuperpage(size_t channel, const Superpage& superpage);
+
+  /// Room left in the push queue of a channel
+  size_t getPushAvailable(size_t channel) const;
+
+  /// Pops a superpage from the merged ready queue
+  boost::optional<ReadySuperpage> tryPopSuperpage();
+
+  /// Waits until a superpage can be popped, backing off with the group's WaitPolicy
+  /// \return True if a superpage can be popped, false if the timeout expired
+  bool waitForReady(std::chrono::microseconds timeout);
+
+  size_t getChannelCount() const;
+
+  /// Gives access to a channel of the group. It must not be used while DMA is running.
+  DmaChannelInterface& getChannel(size_t channel);
+
+  Statistics getStatistics() const;
+
+ private:
+  bool poll();
+
+  std::unique_ptr<CardDmaGroupInternal> mInternal;
+};
+
+} // namespace roc
+} // namespace o2
+
+#endif // O2_READOUTCARD_INCLUDE_CARDDMAGROUP_H_
@@ -41,7 +41,8 @@ class ChannelFactory
   virtual ~ChannelFactory();
 
   /// Get an object to access a DMA channel with the given serial number and channel number.
-  /// Passing 'DUMMY_SERIAL_NUMBER' as serial number returns a dummy implementation
+  /// Passing the dummy serial ID (see getDummySerialId()) returns a software emulation of a CRU DMA channel, which
+  /// replays recorded data if the ReplayFiles parameter is set
   /// \param parameters Parameters for the channel
   DmaChannelSharedPtr getDmaChannel(const Parameters& parameters);
 
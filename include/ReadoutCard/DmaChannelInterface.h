@@ -18,7 +18,10 @@
 #define O2_READOUTCARD_INCLUDE_DMACHANNELINTERFACE_H_
 
 #include "ReadoutCard/NamespaceAlias.h"
+#include <array>
+#include <chrono>
 #include <cstdint>
+#include <vector>
 #include <boost/optional.hpp>
 #include "ReadoutCard/Parameters.h"
 #include "ReadoutCard/CardType.h"
@@ -31,6 +34,69 @@ namespace o2
 namespace roc
 {
 
+/// Namespace for the status returned by DmaChannelInterface::tryPushSuperpage()
+struct PushStatus {
+  enum type {
+    Ok,               ///< The superpage was added to the transfer queue
+    DmaNotStarted,    ///< The superpage was not pushed because DMA is not started
+    QueueFull,        ///< The superpage was not pushed because the transfer queue is full
+    InvalidSuperpage, ///< The superpage was not pushed because its size or offset is not valid for the DMA buffer
+  };
+};
+
+/// Statistics of the polls done by DmaChannelInterface::waitForReady()
+struct PollStatistics {
+  uint64_t productivePolls = 0; ///< Polls after which at least one superpage was ready
+  uint64_t emptyPolls = 0;      ///< Polls after which no superpage was ready
+  uint64_t yields = 0;          ///< Times the CPU was yielded between polls
+  uint64_t sleeps = 0;          ///< Times the thread slept between polls
+  uint64_t timeouts = 0;        ///< Calls that returned because the timeout expired
+  uint64_t superpagesReady = 0; ///< Superpages moved to the ready queue by the driver
+  uint64_t registerReads = 0;   ///< BAR read accesses done by the driver to track transfers, where counted (CRU)
+  uint64_t indexLags = 0;       ///< Of these, re-reads of a superpage size whose index lagged (CRU)
+};
+
+/// Statistics of the superpages of one link, see DmaChannelInterface::getStatistics()
+struct LinkStatistics {
+  /// Buckets of the fill time histogram. Bucket 0 counts the fill times under 1 us, bucket i the ones from 2^(i-1) us
+  /// up to 2^i us, and the last bucket also all the longer ones.
+  static constexpr size_t FILL_TIME_BUCKETS = 24;
+
+  uint32_t linkId = 0;
+  uint64_t superpagesPushed = 0;    ///< Superpages pushed to the card
+  uint64_t superpagesFilled = 0;    ///< Superpages found filled
+  uint64_t superpagesReclaimed = 0; ///< Superpages returned unfilled when DMA stopped
+  uint64_t bytesReceived = 0;       ///< Bytes received in the filled superpages
+  uint64_t superpagesInFirmware = 0; ///< Superpages pushed to the card and not yet filled or reclaimed
+  uint64_t firmwareCapacity = 0;    ///< Most superpages that can be pushed to the card
+  /// Filled superpages by fill time: the time from their push to the card to the driver finding them filled
+  std::array<uint64_t, FILL_TIME_BUCKETS> fillTimes{};
+};
+
+/// Snapshot of the statistics of a DMA channel since it was opened, see DmaChannelInterface::getStatistics()
+struct DmaChannelStatistics {
+  /// Per link, in the order of getDataTakingLinks(), followed by the CRU links being drained after removeLink(). The
+  /// C-RORC has a single entry, the emulator none.
+  std::vector<LinkStatistics> links;
+  uint64_t bufferSize = 0;           ///< Size of the DMA buffer
+  uint64_t bytesPushed = 0;          ///< Bytes of the superpages pushed by the user
+  uint64_t bytesPopped = 0;          ///< Bytes of the superpages popped by the user
+  uint64_t superpagesInFirmware = 0; ///< Superpages pushed to the card and not yet filled or reclaimed, on all links
+  uint64_t superpagesReady = 0;      ///< Superpages in the ready queue
+
+  /// Bytes of the DMA buffer held by the driver: in the transfer queue, in the card, or in the ready queue
+  uint64_t getBytesInDriver() const
+  {
+    return bytesPushed - bytesPopped;
+  }
+
+  /// Bytes of the DMA buffer held by the user, or not used for superpages
+  uint64_t getBytesHeldByUser() const
+  {
+    return bufferSize > getBytesInDriver() ? bufferSize - getBytesInDriver() : 0;
+  }
+};
+
 /// Interface for objects that provide an interface to control and use a DMA channel.
 class DmaChannelInterface
 {
@@ -54,6 +120,7 @@ class DmaChannelInterface
   ///  * Make sure the superpage is contained within a hugepage (see README.md for more info on hugepages)
   ///  * Enable your machine's IOMMU. In this case, the channel buffer that you register when opening a channel will
   ///    be completely contiguous as far as the card is concerned.
+  /// getSuperpageOffsets() gives the offsets at which superpages of a given size satisfy this.
   ///
   /// The user is responsible for making sure enqueued superpages do not overlap - the driver will dutifully overwrite
   /// your data if you tell it to do so.
@@ -70,6 +137,14 @@ class DmaChannelInterface
   /// \param superpage Superpage to push
   virtual bool pushSuperpage(Superpage superpage) = 0;
 
+  /// Adds superpage to the "transfer queue" of the given link, instead of letting the driver pick the link.
+  /// This allows a producer to keep per-link buffer regions, and to size superpages to each link's rate.
+  /// Only supported by the CRU. See pushSuperpage() for the rest.
+  /// \param superpage Superpage to push
+  /// \param linkId ID of the link, one of getDataTakingLinks()
+  /// \return False if DMA is not started
+  virtual bool pushSuperpage(Superpage superpage, uint32_t linkId) = 0;
+
   /// Gets the superpage at the front of the "ready queue". Does not pop it.
   /// Note that it returns a copy of the Superpage's values.
   virtual Superpage getSuperpage() = 0;
@@ -77,12 +152,103 @@ class DmaChannelInterface
   /// Pops and returns the superpage at the front of the "ready queue".
   virtual Superpage popSuperpage() = 0;
 
-  /// Handles internal driver business. Call in a loop. May be replaced by internal driver thread at some point.
+  /// Adds a batch of superpages to the "transfer queue".
+  /// Equivalent to calling pushSuperpage() for each superpage in order, but amortizes the per-call overhead.
+  /// Pushing stops at the first superpage that does not fit in the transfer queue; the caller keeps ownership of the
+  /// superpages that were not accepted.
+  ///
+  /// \param superpages Array of superpages to push
+  /// \param count Number of superpages in the array
+  /// \return The number of superpages accepted, counted from the start of the array
+  virtual size_t pushSuperpages(const Superpage* superpages, size_t count) = 0;
+
+  /// Pops a batch of superpages from the front of the "ready queue".
+  /// Equivalent to calling popSuperpage() while the ready queue is not empty, up to the given maximum.
+  ///
+  /// \param superpages Array the popped superpages are written to
+  /// \param maxCount Maximum number of superpages to pop; the array must hold at least this many
+  /// \return The number of superpages popped
+  virtual size_t popSuperpages(Superpage* superpages, size_t maxCount) = 0;
+
+  /// Non-throwing variant of pushSuperpage() for use in the hot path.
+  /// It does not allocate, and reports a full transfer queue or an invalid superpage through its return value.
+  /// \param superpage Superpage to push
+  /// \return PushStatus::Ok if the superpage was added to the transfer queue, else the reason it was not
+  virtual PushStatus::type tryPushSuperpage(const Superpage& superpage) = 0;
+
+  /// Non-throwing variant of getSuperpage() for use in the hot path. Does not pop the superpage.
+  /// \return A copy of the superpage at the front of the "ready queue", or an empty optional if the queue is empty
+  virtual boost::optional<Superpage> tryPeekSuperpage() = 0;
+
+  /// Non-throwing variant of popSuperpage() for use in the hot path.
+  /// \return The superpage popped from the front of the "ready queue", or an empty optional if the queue is empty
+  virtual boost::optional<Superpage> tryPopSuperpage() = 0;
+
+  /// Handles internal driver business. Call in a loop.
+  /// Does nothing if the internal driver thread is enabled (see Parameters::setDriverThreadEnabled()).
   virtual void fillSuperpages() = 0;
 
+  /// Waits until at least one superpage is in the "ready queue", calling fillSuperpages() while it waits.
+  /// While polls are unproductive, it backs off from back-to-back polling to yielding and then to sleeping, as
+  /// configured with the ReadyWaitPolicy parameter.
+  /// \param timeout Maximum time to wait
+  /// \return True if a superpage is ready, false if the timeout expired
+  virtual bool waitForReady(std::chrono::microseconds timeout) = 0;
+
+  /// Gets the file descriptor of an eventfd that becomes readable when superpages are moved to the "ready queue".
+  /// Its counter is increased by the number of superpages moved. The user should read it to reset it, before popping
+  /// the superpages. It allows waiting for several channels in one epoll loop, but note that superpages are only moved
+  /// when fillSuperpages() is called.
+  /// Requires the ReadyEventFdEnabled parameter.
+  /// \return The file descriptor, or -1 if not enabled. It is owned by the channel.
+  virtual int getReadyEventFd() = 0;
+
+  /// Gets the statistics of the polls done by waitForReady() since the channel was opened
+  virtual PollStatistics getPollStatistics() = 0;
+
+  /// Gets a snapshot of the per-link and buffer statistics of the channel. It does not access the card, and can be
+  /// called from any thread while the channel is in use.
+  virtual DmaChannelStatistics getStatistics() = 0;
+
   /// Gets the amount of superpages that can still be pushed into the "transfer queue" using pushSuperpage()
   virtual int getTransferQueueAvailable() = 0;
 
+  /// Gets the amount of superpages that can still be pushed to the given link using pushSuperpage(superpage, linkId)
+  /// \param linkId ID of the link, one of getDataTakingLinks()
+  virtual int getTransferQueueAvailable(uint32_t linkId) = 0;
+
+  /// Gets the offsets at which superpages of the given size can be placed in the DMA buffer, as many as fit, so that
+  /// each one is contiguous in the card's bus address space. With the IOMMU enabled the whole buffer is contiguous;
+  /// without it, superpages are kept within runs of hugepages that are adjacent on the bus, and a warning is logged
+  /// if this leaves part of the buffer unused.
+  /// \param superpageSize Size of the superpages in bytes
+  /// \return The offsets, in increasing order
+  virtual std::vector<size_t> getSuperpageOffsets(size_t superpageSize) = 0;
+
+  /// Gets the IDs of the links the channel takes data from. Empty if the card has no per-link queues (C-RORC).
+  virtual std::vector<uint32_t> getDataTakingLinks() = 0;
+
+  /// Starts taking data from a link, without stopping DMA on the other links. The link must be enabled in the firmware,
+  /// see roc-config. The queue capacities of the links are planned again, which resets what the link scheduler learned.
+  /// Only supported by the CRU.
+  /// \param linkId ID of the link
+  /// \throw InvalidLinkId if the link is not enabled in the firmware, or already taking data
+  virtual void addLink(uint32_t linkId) = 0;
+
+  /// Stops taking data from a link, without stopping DMA on the other links. No superpage is pushed to the link
+  /// anymore. The superpages pushed to it but still waiting for the driver are moved to the "ready queue" at once, not
+  /// filled. If the link is still enabled in the firmware, the superpages the card holds are drained: they keep arriving
+  /// in the "ready queue" as they are filled. If it was disabled in the firmware, they are moved to the "ready queue"
+  /// not filled, and the link can only be added back after DMA is restarted, since the card still holds their
+  /// descriptors. Only supported by the CRU.
+  /// \param linkId ID of the link, one of getDataTakingLinks()
+  /// \throw InvalidLinkId if the link is not taking data
+  virtual void removeLink(uint32_t linkId) = 0;
+
+  /// Adds and removes links so that the channel takes data from the links enabled in the firmware, as when it was
+  /// opened. See addLink() and removeLink(). Only supported by the CRU.
+  virtual void refreshLinks() = 0;
+
   /// Gets the amount of superpages currently in the "ready queue". If there is more than one available, the front
   /// superpage can be inspected with getSuperpage() or popped with popSuperpage().
   virtual int getReadyQueueSize() = 0;
@@ -0,0 +1,43 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file LinkSchedulerPolicy.h
+/// \brief Definition of the LinkSchedulerPolicy enum and supporting functions.
+
+#ifndef O2_READOUTCARD_INCLUDE_LINKSCHEDULERPOLICY_H_
+#define O2_READOUTCARD_INCLUDE_LINKSCHEDULERPOLICY_H_
+
+#include "ReadoutCard/NamespaceAlias.h"
+#include <string>
+
+namespace o2
+{
+namespace roc
+{
+
+/// Namespace for the enum of the policies deciding which CRU link gets the next superpage, and supporting functions
+struct LinkSchedulerPolicy {
+  enum type {
+    FreeSlot,     ///< Hand out free link slots in the order they were freed
+    RateWeighted, ///< Keep an amount of superpages in flight per link proportional to its completion rate
+    Controlled    ///< Adjust the superpages in flight per link, within bounds, from its FIFO empty and drop counters
+  };
+
+  /// Converts a LinkSchedulerPolicy to a string
+  static std::string toString(const LinkSchedulerPolicy::type& policy);
+
+  /// Converts a string to a LinkSchedulerPolicy
+  static LinkSchedulerPolicy::type fromString(const std::string& string);
+};
+
+} // namespace roc
+} // namespace o2
+
+#endif // O2_READOUTCARD_INCLUDE_LINKSCHEDULERPOLICY_H_
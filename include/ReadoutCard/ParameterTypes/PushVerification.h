@@ -0,0 +1,44 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file PushVerification.h
+/// \brief Definition of the PushVerification enum and supporting functions.
+
+#ifndef O2_READOUTCARD_INCLUDE_PUSHVERIFICATION_H_
+#define O2_READOUTCARD_INCLUDE_PUSHVERIFICATION_H_
+
+#include "ReadoutCard/NamespaceAlias.h"
+#include <string>
+
+namespace o2
+{
+namespace roc
+{
+
+/// Namespace for the enum of the policies deciding which C-RORC superpage push register writes are read back, and
+/// supporting functions
+struct PushVerification {
+  enum type {
+    Always,   ///< Read back the address and size registers after every push
+    SizeOnly, ///< Read back the size register only, which also holds the firmware push counter
+    Sampled   ///< Read back all the registers every Nth push only
+  };
+
+  /// Converts a PushVerification to a string
+  static std::string toString(const PushVerification::type& verification);
+
+  /// Converts a string to a PushVerification
+  static PushVerification::type fromString(const std::string& string);
+};
+
+} // namespace roc
+} // namespace o2
+
+#endif // O2_READOUTCARD_INCLUDE_PUSHVERIFICATION_H_
@@ -0,0 +1,37 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file WaitPolicy.h
+/// \brief Definition of the WaitPolicy struct
+
+#ifndef O2_READOUTCARD_INCLUDE_WAITPOLICY_H_
+#define O2_READOUTCARD_INCLUDE_WAITPOLICY_H_
+
+#include "ReadoutCard/NamespaceAlias.h"
+#include <cstdint>
+
+namespace o2
+{
+namespace roc
+{
+
+/// Backoff policy for polling loops that wait for superpages, such as DmaChannelInterface::waitForReady().
+/// The loop first polls back-to-back, then yields the CPU between polls, and finally sleeps between polls.
+/// It goes back to back-to-back polling as soon as a poll is productive.
+struct WaitPolicy {
+  uint32_t spinPolls = 1000;       ///< Number of back-to-back polls before yielding
+  uint32_t yieldPolls = 100;       ///< Number of polls with a yield in between, before sleeping
+  uint32_t sleepMicroseconds = 10; ///< Sleep time between polls after the spin and yield phases
+};
+
+} // namespace roc
+} // namespace o2
+
+#endif // O2_READOUTCARD_INCLUDE_WAITPOLICY_H_
@@ -22,6 +22,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 #include <boost/optional.hpp>
 #include <boost/variant.hpp>
 #include "ReadoutCard/ParameterTypes/BufferParameters.h"
@@ -30,6 +31,9 @@
 #include "ReadoutCard/ParameterTypes/PciSequenceNumber.h"
 #include "ReadoutCard/ParameterTypes/SerialId.h"
 #include "ReadoutCard/ParameterTypes/Hex.h"
+#include "ReadoutCard/ParameterTypes/LinkSchedulerPolicy.h"
+#include "ReadoutCard/ParameterTypes/PushVerification.h"
+#include "ReadoutCard/ParameterTypes/WaitPolicy.h"
 
 // CRU Specific
 #include "ReadoutCard/ParameterTypes/Clock.h"
@@ -177,6 +181,55 @@ class Parameters
   /// Type for the FEE ID map parameter
   using FeeIdMapType = std::map<uint32_t, uint32_t>;
 
+  /// Type for the ready wait policy parameter
+  using ReadyWaitPolicyType = WaitPolicy;
+
+  /// Type for the ready eventfd enabled parameter
+  using ReadyEventFdEnabledType = bool;
+
+  /// Type for the driver thread enabled parameter
+  using DriverThreadEnabledType = bool;
+
+  /// Type for the driver thread CPU parameter
+  using DriverThreadCpuType = int32_t;
+
+  /// Type for the link status batch read enabled parameter
+  using LinkStatusBatchReadEnabledType = bool;
+
+  /// Type for the link scheduler policy parameter
+  using LinkSchedulerPolicyType = LinkSchedulerPolicy::type;
+
+  /// Type for the LinkInFlightMin and LinkInFlightMax parameters
+  using LinkInFlightMinType = size_t;
+  using LinkInFlightMaxType = size_t;
+
+  /// Type for the fast restart enabled parameter
+  using FastRestartEnabledType = bool;
+
+  /// Type for the superpage timestamp enabled parameter
+  using SuperpageTimestampEnabledType = bool;
+
+  /// Type for the emulator data rate parameter
+  using EmulatorDataRateType = size_t;
+
+  /// Type for the replay files parameter
+  using ReplayFilesType = std::vector<std::string>;
+
+  /// Type for the replay speed parameter
+  using ReplaySpeedType = double;
+
+  /// Type for the replay loop parameter
+  using ReplayLoopEnabledType = bool;
+
+  /// Type for the CRORC pipeline depth parameter
+  using CrorcPipelineDepthType = size_t;
+
+  /// Type for the CrorcPushVerification parameter
+  using CrorcPushVerificationType = PushVerification::type;
+
+  /// Type for the CrorcPushVerificationInterval parameter
+  using CrorcPushVerificationIntervalType = size_t;
+
   // Setters
 
   /// Sets the CardId parameter
@@ -510,6 +563,171 @@ class Parameters
   /// \return Reference to this object for chaining calls
   auto setFeeIdMap(FeeIdMapType value) -> Parameters&;
 
+  /// Sets the ReadyWaitPolicy parameter
+  ///
+  /// Backoff policy used by DmaChannelInterface::waitForReady() while no superpage is ready.
+  /// If not set, the defaults of the WaitPolicy struct are used.
+  ///
+  /// \param value The value to set
+  /// \return Reference to this object for chaining calls
+  auto setReadyWaitPolicy(ReadyWaitPolicyType value) -> Parameters&;
+
+  /// Sets the ReadyEventFdEnabled parameter
+  ///
+  /// If enabled, the channel creates an eventfd that becomes readable when superpages are moved to the ready queue.
+  /// See DmaChannelInterface::getReadyEventFd().
+  ///
+  /// \param value The value to set
+  /// \return Reference to this object for chaining calls
+  auto setReadyEventFdEnabled(ReadyEventFdEnabledType value) -> Parameters&;
+
+  /// Sets the DriverThreadEnabled parameter
+  ///
+  /// If enabled, the DMA channel runs an internal driver thread while DMA is started. The thread does all the BAR
+  /// polling and superpage descriptor pushes, and fillSuperpages() becomes a no-op. The user thread only interacts with
+  /// the channel through lock-free queues.
+  /// By default the thread is pinned to the last CPU of the card's NUMA node, see setDriverThreadCpu().
+  ///
+  /// \param value The value to set
+  /// \return Reference to this object for chaining calls
+  auto setDriverThreadEnabled(DriverThreadEnabledType value) -> Parameters&;
+
+  /// Sets the DriverThreadCpu parameter
+  ///
+  /// CPU to pin the driver thread to, see setDriverThreadEnabled(). Give -1 to leave the thread unpinned.
+  /// If not set, the last CPU of the card's NUMA node is used.
+  ///
+  /// \param value The value to set
+  /// \return Reference to this object for chaining calls
+  auto setDriverThreadCpu(DriverThreadCpuType value) -> Parameters&;
+
+  /// Sets the LinkStatusBatchReadEnabled parameter
+  ///
+  /// CRU only. If enabled, the superpage counters of the links with superpages in flight are fetched with one block read
+  /// of the BAR per poll, spanning the lowest to the highest of them, instead of one read per link. Links with no
+  /// superpages in flight are not read at all.
+  ///
+  /// \param value The value to set
+  /// \return Reference to this object for chaining calls
+  auto setLinkStatusBatchReadEnabled(LinkStatusBatchReadEnabledType value) -> Parameters&;
+
+  /// Sets the LinkSchedulerPolicy parameter
+  ///
+  /// CRU only. Policy deciding which link gets the next superpage pushed. Defaults to LinkSchedulerPolicy::FreeSlot,
+  /// which hands out free link slots in constant time. LinkSchedulerPolicy::RateWeighted keeps an amount of superpages in
+  /// flight per link proportional to its completion rate, so that idle links do not hold on to buffer memory; this also
+  /// limits getTransferQueueAvailable(). LinkSchedulerPolicy::Controlled adjusts the superpages in flight per link
+  /// between LinkInFlightMin and LinkInFlightMax, from the card's superpage FIFO empty and dropped packets counters.
+  ///
+  /// \param value The value to set
+  /// \return Reference to this object for chaining calls
+  auto setLinkSchedulerPolicy(LinkSchedulerPolicyType value) -> Parameters&;
+
+  /// Sets the LinkInFlightMin parameter
+  ///
+  /// CRU only. With LinkSchedulerPolicy::Controlled, the fewest superpages kept in flight on a link, whatever its rate.
+  /// Defaults to 2.
+  ///
+  /// \param value The value to set
+  /// \return Reference to this object for chaining calls
+  auto setLinkInFlightMin(LinkInFlightMinType value) -> Parameters&;
+
+  /// Sets the LinkInFlightMax parameter
+  ///
+  /// CRU only. With LinkSchedulerPolicy::Controlled, the most superpages kept in flight on a link. Defaults to the link
+  /// queue capacity, which is also the highest value. The controller starts every link at this value.
+  ///
+  /// \param value The value to set
+  /// \return Reference to this object for chaining calls
+  auto setLinkInFlightMax(LinkInFlightMaxType value) -> Parameters&;
+
+  /// Sets the FastRestartEnabled parameter
+  ///
+  /// CRU only. If enabled, startDma() after a stopDma() that left no superpages in the card re-arms the DMA engine without
+  /// resetting the card, saving about 200 ms. The buffer registration, links and firmware features of the channel are
+  /// kept, and the link superpage counters are carried on from the card's. The data generator counters are not reset.
+  /// The first start, and any start following a stop that returned superpages still in the card, always reset it.
+  /// Defaults to false.
+  ///
+  /// \param value The value to set
+  /// \return Reference to this object for chaining calls
+  auto setFastRestartEnabled(FastRestartEnabledType value) -> Parameters&;
+
+  /// Sets the SuperpageTimestampEnabled parameter
+  ///
+  /// If enabled, the DMA channel records in each filled superpage the time at which it found it filled, see
+  /// Superpage::getArrivalTime(). Disabled by default, as it costs a clock read per superpage.
+  ///
+  /// \param value The value to set
+  /// \return Reference to this object for chaining calls
+  auto setSuperpageTimestampEnabled(SuperpageTimestampEnabledType value) -> Parameters&;
+
+  /// Sets the EmulatorDataRate parameter
+  ///
+  /// Software emulator only (dummy serial ID -1). Bytes per second generated over all the links of the LinkMask
+  /// parameter. Defaults to 0, which generates as fast as the generator thread can write the pages.
+  ///
+  /// \param value The value to set
+  /// \return Reference to this object for chaining calls
+  auto setEmulatorDataRate(EmulatorDataRateType value) -> Parameters&;
+
+  /// Sets the ReplayFiles parameter
+  ///
+  /// Software emulator only (dummy serial ID -1). Files recorded with `o2-roc-bench-dma --to-file-bin`, replayed in order
+  /// into the pushed superpages instead of generating data. The files must hold CRU pages starting with an RDH.
+  ///
+  /// \param value The value to set
+  /// \return Reference to this object for chaining calls
+  auto setReplayFiles(ReplayFilesType value) -> Parameters&;
+
+  /// Sets the ReplaySpeed parameter
+  ///
+  /// Replay only (see setReplayFiles()). Pace of the replay relative to the orbits in the RDHs of the recorded data: 1
+  /// replays in real time, 2 twice as fast, and so on. Defaults to 0, which replays as fast as possible.
+  ///
+  /// \param value The value to set
+  /// \return Reference to this object for chaining calls
+  auto setReplaySpeed(ReplaySpeedType value) -> Parameters&;
+
+  /// Sets the ReplayLoopEnabled parameter
+  ///
+  /// Replay only (see setReplayFiles()). Replays the files again from the start when their end is reached, instead of
+  /// stopping. Defaults to false.
+  ///
+  /// \param value The value to set
+  /// \return Reference to this object for chaining calls
+  auto setReplayLoopEnabled(ReplayLoopEnabledType value) -> Parameters&;
+
+  /// Sets the CrorcPipelineDepth parameter
+  ///
+  /// CRORC only. Number of superpages pushed to the firmware ahead of the one being filled, so that the channel does not
+  /// idle between superpages. Defaults to 1, at most CrorcDmaChannel::MAX_PIPELINE_DEPTH. Since the firmware reports the size
+  /// of the last filled superpage only, more than 1 requires the time frame detection to be disabled, so that all superpages
+  /// but the last one are filled completely; otherwise the channel falls back to 1.
+  ///
+  /// \param value The value to set
+  /// \return Reference to this object for chaining calls
+  auto setCrorcPipelineDepth(CrorcPipelineDepthType value) -> Parameters&;
+
+  /// Sets the CrorcPushVerification parameter
+  ///
+  /// CRORC only. Which register writes of a superpage push are read back and compared. Defaults to
+  /// PushVerification::Always, which reads back the address and size registers after every push.
+  /// PushVerification::SizeOnly reads back the size register only; its push counter still catches lost pushes.
+  /// PushVerification::Sampled reads back all the registers every CrorcPushVerificationInterval pushes.
+  ///
+  /// \param value The value to set
+  /// \return Reference to this object for chaining calls
+  auto setCrorcPushVerification(CrorcPushVerificationType value) -> Parameters&;
+
+  /// Sets the CrorcPushVerificationInterval parameter
+  ///
+  /// CRORC only. With PushVerification::Sampled, one push out of this many is verified. Defaults to 64.
+  ///
+  /// \param value The value to set
+  /// \return Reference to this object for chaining calls
+  auto setCrorcPushVerificationInterval(CrorcPushVerificationIntervalType value) -> Parameters&;
+
   // non-throwing getters
 
   /// Gets the AllowRejection parameter
@@ -663,6 +881,74 @@ class Parameters
   /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
   auto getFeeIdMap() const -> boost::optional<FeeIdMapType>;
 
+  /// Gets the ReadyWaitPolicy parameter
+  /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+  auto getReadyWaitPolicy() const -> boost::optional<ReadyWaitPolicyType>;
+
+  /// Gets the ReadyEventFdEnabled parameter
+  /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+  auto getReadyEventFdEnabled() const -> boost::optional<ReadyEventFdEnabledType>;
+
+  /// Gets the DriverThreadEnabled parameter
+  /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+  auto getDriverThreadEnabled() const -> boost::optional<DriverThreadEnabledType>;
+
+  /// Gets the DriverThreadCpu parameter
+  /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+  auto getDriverThreadCpu() const -> boost::optional<DriverThreadCpuType>;
+
+  /// Gets the LinkStatusBatchReadEnabled parameter
+  /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+  auto getLinkStatusBatchReadEnabled() const -> boost::optional<LinkStatusBatchReadEnabledType>;
+
+  /// Gets the LinkSchedulerPolicy parameter
+  /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+  auto getLinkSchedulerPolicy() const -> boost::optional<LinkSchedulerPolicyType>;
+
+  /// Gets the LinkInFlightMin parameter
+  /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+  auto getLinkInFlightMin() const -> boost::optional<LinkInFlightMinType>;
+
+  /// Gets the LinkInFlightMax parameter
+  /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+  auto getLinkInFlightMax() const -> boost::optional<LinkInFlightMaxType>;
+
+  /// Gets the FastRestartEnabled parameter
+  /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+  auto getFastRestartEnabled() const -> boost::optional<FastRestartEnabledType>;
+
+  /// Gets the SuperpageTimestampEnabled parameter
+  /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+  auto getSuperpageTimestampEnabled() const -> boost::optional<SuperpageTimestampEnabledType>;
+
+  /// Gets the EmulatorDataRate parameter
+  /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+  auto getEmulatorDataRate() const -> boost::optional<EmulatorDataRateType>;
+
+  /// Gets the ReplayFiles parameter
+  /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+  auto getReplayFiles() const -> boost::optional<ReplayFilesType>;
+
+  /// Gets the ReplaySpeed parameter
+  /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+  auto getReplaySpeed() const -> boost::optional<ReplaySpeedType>;
+
+  /// Gets the ReplayLoopEnabled parameter
+  /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+  auto getReplayLoopEnabled() const -> boost::optional<ReplayLoopEnabledType>;
+
+  /// Gets the CrorcPipelineDepth parameter
+  /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+  auto getCrorcPipelineDepth() const -> boost::optional<CrorcPipelineDepthType>;
+
+  /// Gets the CrorcPushVerification parameter
+  /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+  auto getCrorcPushVerification() const -> boost::optional<CrorcPushVerificationType>;
+
+  /// Gets the CrorcPushVerificationInterval parameter
+  /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+  auto getCrorcPushVerificationInterval() const -> boost::optional<CrorcPushVerificationIntervalType>;
+
   // Throwing getters
 
   /// Gets the AllowRejection parameter
@@ -855,6 +1141,91 @@ class Parameters
   /// \return The value
   auto getFeeIdMapRequired() const -> FeeIdMapType;
 
+  /// Gets the ReadyWaitPolicy parameter
+  /// \exception ParameterException The parameter was not present
+  /// \return The value
+  auto getReadyWaitPolicyRequired() const -> ReadyWaitPolicyType;
+
+  /// Gets the ReadyEventFdEnabled parameter
+  /// \exception ParameterException The parameter was not present
+  /// \return The value
+  auto getReadyEventFdEnabledRequired() const -> ReadyEventFdEnabledType;
+
+  /// Gets the DriverThreadEnabled parameter
+  /// \exception ParameterException The parameter was not present
+  /// \return The value
+  auto getDriverThreadEnabledRequired() const -> DriverThreadEnabledType;
+
+  /// Gets the DriverThreadCpu parameter
+  /// \exception ParameterException The parameter was not present
+  /// \return The value
+  auto getDriverThreadCpuRequired() const -> DriverThreadCpuType;
+
+  /// Gets the LinkStatusBatchReadEnabled parameter
+  /// \exception ParameterException The parameter was not present
+  /// \return The value
+  auto getLinkStatusBatchReadEnabledRequired() const -> LinkStatusBatchReadEnabledType;
+
+  /// Gets the LinkSchedulerPolicy parameter
+  /// \exception ParameterException The parameter was not present
+  /// \return The value
+  auto getLinkSchedulerPolicyRequired() const -> LinkSchedulerPolicyType;
+
+  /// Gets the LinkInFlightMin parameter
+  /// \exception ParameterException The parameter was not present
+  /// \return The value
+  auto getLinkInFlightMinRequired() const -> LinkInFlightMinType;
+
+  /// Gets the LinkInFlightMax parameter
+  /// \exception ParameterException The parameter was not present
+  /// \return The value
+  auto getLinkInFlightMaxRequired() const -> LinkInFlightMaxType;
+
+  /// Gets the FastRestartEnabled parameter
+  /// \exception ParameterException The parameter was not present
+  /// \return The value
+  auto getFastRestartEnabledRequired() const -> FastRestartEnabledType;
+
+  /// Gets the SuperpageTimestampEnabled parameter
+  /// \exception ParameterException The parameter was not present
+  /// \return The value
+  auto getSuperpageTimestampEnabledRequired() const -> SuperpageTimestampEnabledType;
+
+  /// Gets the EmulatorDataRate parameter
+  /// \exception ParameterException The parameter was not present
+  /// \return The value
+  auto getEmulatorDataRateRequired() const -> EmulatorDataRateType;
+
+  /// Gets the ReplayFiles parameter
+  /// \exception ParameterException The parameter was not present
+  /// \return The value
+  auto getReplayFilesRequired() const -> ReplayFilesType;
+
+  /// Gets the ReplaySpeed parameter
+  /// \exception ParameterException The parameter was not present
+  /// \return The value
+  auto getReplaySpeedRequired() const -> ReplaySpeedType;
+
+  /// Gets the ReplayLoopEnabled parameter
+  /// \exception ParameterException The parameter was not present
+  /// \return The value
+  auto getReplayLoopEnabledRequired() const -> ReplayLoopEnabledType;
+
+  /// Gets the CrorcPipelineDepth parameter
+  /// \exception ParameterException The parameter was not present
+  /// \return The value
+  auto getCrorcPipelineDepthRequired() const -> CrorcPipelineDepthType;
+
+  /// Gets the CrorcPushVerification parameter
+  /// \exception ParameterException The parameter was not present
+  /// \return The value
+  auto getCrorcPushVerificationRequired() const -> CrorcPushVerificationType;
+
+  /// Gets the CrorcPushVerificationInterval parameter
+  /// \exception ParameterException The parameter was not present
+  /// \return The value
+  auto getCrorcPushVerificationIntervalRequired() const -> CrorcPushVerificationIntervalType;
+
   // Helper functions
 
   /// Convenience function to make a Parameters object with card ID and channel number, since these are the most
@@ -16,10 +16,13 @@
 
 #include "ReadoutCard/NamespaceAlias.h"
 #include "ReadoutCard/BarInterface.h"
+#include "ReadoutCard/CardDmaGroup.h"
 #include "ReadoutCard/CardType.h"
 #include "ReadoutCard/ChannelFactory.h"
 #include "ReadoutCard/DmaChannelInterface.h"
 #include "ReadoutCard/Exception.h"
 #include "ReadoutCard/Parameters.h"
 #include "ReadoutCard/RegisterReadWriteInterface.h"
+#include "ReadoutCard/SharedSuperpagePool.h"
+#include "ReadoutCard/SuperpagePool.h"
 #include "ReadoutCard/Version.h"
@@ -18,6 +18,7 @@
 #define O2_READOUTCARD_INCLUDE_REGISTERREADWRITEINTERFACE_H_
 
 #include "ReadoutCard/NamespaceAlias.h"
+#include <cstddef>
 #include <cstdint>
 
 namespace o2
@@ -51,6 +52,19 @@ class RegisterReadWriteInterface
   /// \param value The value to be written into the register
   /// \throw May throw an UnsafeWriteAccess exception
   virtual void modifyRegister(int index, int position, int width, uint32_t value) = 0;
+
+  /// Reads a block of consecutive BAR registers. Implementations backed by a mapped BAR do one 32-bit read per register
+  /// without going through readRegister().
+  /// \param index The index of the first register
+  /// \param values Array receiving the register values
+  /// \param count The amount of registers to read
+  /// \throw May throw an UnsafeReadAccess exception
+  virtual void readRegisterBlock(int index, uint32_t* values, size_t count)
+  {
+    for (size_t i = 0; i < count; ++i) {
+      values[i] = readRegister(index + int(i));
+    }
+  }
 };
 
 } // namespace roc
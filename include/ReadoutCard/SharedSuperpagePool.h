@@ -0,0 +1,113 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file SharedSuperpagePool.h
+/// \brief Definition of the SharedSuperpagePool class.
+
+#ifndef O2_READOUTCARD_INCLUDE_SHAREDSUPERPAGEPOOL_H_
+#define O2_READOUTCARD_INCLUDE_SHAREDSUPERPAGEPOOL_H_
+
+#include "ReadoutCard/NamespaceAlias.h"
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "ReadoutCard/DmaChannelInterface.h"
+#include "ReadoutCard/ParameterTypes/BufferParameters.h"
+#include "ReadoutCard/Superpage.h"
+#include "ReadoutCard/SuperpagePoolBase.h"
+
+namespace o2
+{
+namespace roc
+{
+
+/// Carves one DMA buffer, registered with several channels, into superpages that the channels take from a common free
+/// list as they need them.
+///
+/// Every channel must have been opened with the same buffer. Channels of the same PCI device then share a single
+/// registration and scatter-gather list of it. Superpages are only placed at offsets that
+/// DmaChannelInterface::getSuperpageOffsets() gives for every channel.
+///
+/// Each channel has a quota: the most superpages it may hold, pushed to it or held by the user. Quotas start as equal
+/// shares of the buffer and can be changed at any time, so that memory follows the link rates. They may add up to more
+/// than the buffer, in which case the channels compete for the free superpages. A channel above its quota, after it
+/// was lowered, is not refilled until enough of its superpages are released.
+///
+/// refill(), tryAcquire() and acquire() of a channel call into that channel, and must be called from a single thread
+/// for each channel; different channels may be driven from different threads. Handles may be released from any
+/// thread. The channels must outlive the pool, and the handles must be released before the pool is destroyed.
+class SharedSuperpagePool : public SuperpagePoolBase
+{
+ public:
+  /// Accounting of a channel since the pool was created
+  struct ChannelStatistics {
+    size_t quota = 0;                ///< Most superpages the channel may hold
+    size_t held = 0;                 ///< Superpages pushed to the channel or held by the user
+    size_t peakHeld = 0;             ///< Highest value of held
+    uint64_t superpagesPushed = 0;   ///< Superpages pushed to the channel
+    uint64_t superpagesAcquired = 0; ///< Superpages handed out to the user
+    uint64_t superpagesReleased = 0; ///< Superpages given back by the user
+    /// Refills that found room in the channel but could not push, because of the quota or no free superpage
+    uint64_t starvedRefills = 0;
+  };
+
+  /// \param channels Channels the buffer is registered with. They must not be null.
+  /// \param buffer The buffer registered with every channel
+  /// \param superpageSize Size of the superpages, a multiple of 32 KiB
+  SharedSuperpagePool(const std::vector<DmaChannelInterface*>& channels, const buffer_parameters::Memory& buffer,
+                      size_t superpageSize);
+
+  /// Sets the most superpages a channel may hold
+  void setQuota(size_t channel, size_t superpages);
+
+  size_t getQuota(size_t channel) const;
+
+  /// Pushes free superpages to a channel, as many as it has room for within its quota
+  /// \return The amount of superpages pushed
+  size_t refill(size_t channel);
+
+  /// Refills a channel, then pops a superpage from its ready queue
+  /// \return A handle to the superpage, or an empty handle if none was ready
+  Handle tryAcquire(size_t channel);
+
+  /// Like tryAcquire(), but waits up to the given time for a superpage to be ready
+  Handle acquire(size_t channel, std::chrono::microseconds timeout);
+
+  size_t getChannelCount() const
+  {
+    return mChannels.size();
+  }
+
+  /// Amount of superpages held by no channel
+  size_t getFreeCount() const;
+
+  ChannelStatistics getStatistics(size_t channel) const;
+
+ private:
+  DmaChannelInterface& getChannel(size_t channel) const;
+
+  virtual DmaChannelInterface& getPoolChannel(size_t channel) const override;
+  virtual size_t refillChannel(size_t channel) override;
+  virtual void acquired(size_t channel) override;
+  virtual void release(size_t channel, size_t slot) override;
+
+  std::vector<DmaChannelInterface*> mChannels;
+
+  /// Protects the free slots and the accounting, since channels and handles may be used from several threads
+  mutable std::mutex mMutex;
+  std::vector<size_t> mFreeSlots;
+  std::vector<ChannelStatistics> mStatistics;
+};
+
+} // namespace roc
+} // namespace o2
+
+#endif // O2_READOUTCARD_INCLUDE_SHAREDSUPERPAGEPOOL_H_
@@ -20,6 +20,7 @@
 
 #include "ReadoutCard/NamespaceAlias.h"
 #include <cstddef>
+#include <cstdint>
 
 namespace o2
 {
@@ -27,12 +28,34 @@ namespace roc
 {
 
 /// Simple struct for holding basic info about a superpage
+/// It is packed to 32 bytes, so that two fit in a cache line of the superpage queues. As a consequence, the offset is
+/// limited to 48 bits, the sizes to 32 bits, and the arrival time to 55 bits. Setting a larger value throws an
+/// OutOfRangeException.
 struct Superpage {
  public:
-  Superpage() = default;
+  /// Largest offset
+  static constexpr uint64_t MAX_OFFSET = (uint64_t(1) << 48) - 1;
 
+  /// Largest size, and size of the received data
+  static constexpr uint64_t MAX_SIZE = UINT32_MAX;
+
+  /// Largest arrival time, over a year
+  static constexpr uint64_t MAX_ARRIVAL_TIME = (uint64_t(1) << 55) - 1;
+
+  Superpage() : Superpage(0, 0)
+  {
+  }
+
+  /// \throw OutOfRangeException The offset or the size does not fit
   Superpage(size_t offset, size_t size, void* userData = nullptr)
-    : mOffset(offset), mSize(size), mUserData(userData)
+    : mOffset(checkRange(offset, MAX_OFFSET, "offset")),
+      mSequence(0),
+      mUserData(userData),
+      mSize(checkRange(size, MAX_SIZE, "size")),
+      mReceived(0),
+      mArrivalTime(0),
+      mLink(-1),
+      mReady(false)
   {
   }
 
@@ -80,21 +103,24 @@ struct Superpage {
   }
 
   /// Set the size of the received data in bytes
+  /// \throw OutOfRangeException The size is larger than MAX_SIZE
   void setReceived(size_t received)
   {
-    mReceived = received;
+    mReceived = checkRange(received, MAX_SIZE, "received size");
   }
 
   /// Set the offset from the start of the DMA buffer to the start of the superpage
+  /// \throw OutOfRangeException The offset is larger than MAX_OFFSET
   void setOffset(size_t offset)
   {
-    mOffset = offset;
+    mOffset = checkRange(offset, MAX_OFFSET, "offset");
   }
 
   /// Set the size of the Superpage in bytes
+  /// \throw OutOfRangeException The size is larger than MAX_SIZE
   void setSize(size_t size)
   {
-    mSize = size;
+    mSize = checkRange(size, MAX_SIZE, "size");
   }
 
   /// Get the user data pointer
@@ -104,24 +130,69 @@ struct Superpage {
   }
 
   /// Set the link id
-  void setLink(int id = -1) {
+  void setLink(int id = -1)
+  {
     mLink = id;
   }
 
   /// Get the link id
-  int getLink() {
+  int getLink() const
+  {
     return mLink;
   }
 
+  /// Sequence number of the superpage on its link, in the order the card filled them. It wraps around at 2^16, which
+  /// is much more than can be in flight on a link, so it is enough to detect reordering.
+  uint16_t getSequence() const
+  {
+    return mSequence;
+  }
+
+  /// Set the sequence number of the superpage on its link
+  void setSequence(uint16_t sequence)
+  {
+    mSequence = sequence;
+  }
+
+  /// Time at which the driver found the superpage filled, in nanoseconds of std::chrono::steady_clock, or 0 if not
+  /// recorded. Only set if the SuperpageTimestampEnabled parameter is enabled. The channels record it modulo
+  /// MAX_ARRIVAL_TIME + 1, so it wraps after over a year of uptime.
+  uint64_t getArrivalTime() const
+  {
+    return mArrivalTime;
+  }
+
+  /// Set the arrival time in nanoseconds of std::chrono::steady_clock
+  /// \throw OutOfRangeException The time is larger than MAX_ARRIVAL_TIME
+  void setArrivalTime(uint64_t arrivalTime)
+  {
+    mArrivalTime = checkRange(arrivalTime, MAX_ARRIVAL_TIME, "arrival time");
+  }
+
  private:
-  size_t mOffset = 0;        ///< Offset from the start of the DMA buffer to the start of the superpage
-  size_t mSize = 0;          ///< Size of the superpage in bytes
-  void* mUserData = nullptr; ///< Pointer that users can use for whatever, e.g. to associate data with the superpage
-  size_t mReceived = 0;      ///< Size of the received data in bytes
-  bool mReady = false;       ///< Indicates this superpage is ready
-  int mLink = -1;            ///< The link producing the data
+  /// Returns the value if it is at most the maximum of its field, else throws
+  static uint64_t checkRange(uint64_t value, uint64_t max, const char* field)
+  {
+    if (value > max) {
+      throwOutOfRange(value, max, field);
+    }
+    return value;
+  }
+
+  [[noreturn]] static void throwOutOfRange(uint64_t value, uint64_t max, const char* field);
+
+  uint64_t mOffset : 48;      ///< Offset from the start of the DMA buffer to the start of the superpage
+  uint64_t mSequence : 16;    ///< Sequence number on the link
+  void* mUserData;            ///< Pointer that users can use for whatever, e.g. to associate data with the superpage
+  uint32_t mSize;             ///< Size of the superpage in bytes
+  uint32_t mReceived;         ///< Size of the received data in bytes
+  uint64_t mArrivalTime : 55; ///< Arrival time in nanoseconds of the steady clock
+  int64_t mLink : 8;          ///< The link producing the data
+  uint64_t mReady : 1;        ///< Indicates this superpage is ready
 };
 
+static_assert(sizeof(Superpage) == 32, "Superpage is expected to be packed to 32 bytes");
+
 } // namespace roc
 } // namespace o2
 
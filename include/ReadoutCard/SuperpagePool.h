@@ -0,0 +1,126 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file SuperpagePool.h
+/// \brief Definition of the SuperpagePool class.
+
+#ifndef O2_READOUTCARD_INCLUDE_SUPERPAGEPOOL_H_
+#define O2_READOUTCARD_INCLUDE_SUPERPAGEPOOL_H_
+
+#include "ReadoutCard/NamespaceAlias.h"
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+#include <boost/optional.hpp>
+#include "ReadoutCard/DmaChannelInterface.h"
+#include "ReadoutCard/ParameterTypes/BufferParameters.h"
+#include "ReadoutCard/Superpage.h"
+#include "ReadoutCard/SuperpagePoolBase.h"
+
+namespace o2
+{
+namespace roc
+{
+
+/// Carves the DMA buffer of a channel into superpages, keeps the channel supplied with the free ones, and hands out
+/// the filled ones as handles that give the superpage back to the pool when released.
+///
+/// The buffer is either carved into superpages of a single size, pushed with pushSuperpage(superpage), or split in
+/// equal shares between links, each carved into superpages of its own size and pushed to its link with
+/// pushSuperpage(superpage, linkId). Superpages are only placed at the offsets given by
+/// DmaChannelInterface::getSuperpageOffsets(), so that each one is contiguous in the card's bus address space. All
+/// superpages are free at first.
+///
+/// refill(), tryAcquire() and acquire() call into the channel, and must be called from a single thread. Handles may be
+/// released from any thread; their superpages are pushed again by the next refill. Superpages held by the user are
+/// not pushed, so a slow consumer holds the card back exactly like when pushing by hand.
+///
+/// The channel must outlive the pool, and the handles must be released before the pool is destroyed.
+class SuperpagePool : public SuperpagePoolBase
+{
+ public:
+  /// Counters of the pool since it was created
+  struct Statistics {
+    uint64_t superpagesPushed = 0;   ///< Superpages pushed to the channel
+    uint64_t superpagesAcquired = 0; ///< Superpages handed out to the user
+    uint64_t superpagesReleased = 0; ///< Superpages given back by the user
+    /// Refills that found room in the channel but no free superpage, because the user held all the others
+    uint64_t starvedRefills = 0;
+  };
+
+  /// Carves the buffer into superpages of the given size, pushed without a link
+  /// \param channel Channel the buffer is registered with
+  /// \param buffer The buffer registered with the channel
+  /// \param superpageSize Size of the superpages, a multiple of 32 KiB
+  SuperpagePool(DmaChannelInterface& channel, const buffer_parameters::Memory& buffer, size_t superpageSize);
+
+  /// Splits the buffer in equal shares between the given links, and carves each share into superpages of the size of
+  /// its link. Only supported by channels that take superpages per link, see DmaChannelInterface::pushSuperpage().
+  /// \param channel Channel the buffer is registered with
+  /// \param buffer The buffer registered with the channel
+  /// \param linkSuperpageSizes Size of the superpages of each link, a multiple of 32 KiB
+  SuperpagePool(DmaChannelInterface& channel, const buffer_parameters::Memory& buffer,
+                const std::map<uint32_t, size_t>& linkSuperpageSizes);
+
+  /// Pushes free superpages to the channel, as many as it has room for
+  /// \return The amount of superpages pushed
+  size_t refill();
+
+  /// Refills the channel, then pops a superpage from the ready queue
+  /// \return A handle to the superpage, or an empty handle if none was ready
+  Handle tryAcquire()
+  {
+    return tryAcquireFrom(0);
+  }
+
+  /// Like tryAcquire(), but waits up to the given time for a superpage to be ready
+  Handle acquire(std::chrono::microseconds timeout)
+  {
+    return acquireFrom(0, timeout);
+  }
+
+  /// Amount of superpages neither pushed to the channel nor held by the user
+  size_t getFreeCount() const;
+
+  Statistics getStatistics() const;
+
+ private:
+  /// The superpages of a link, or of the whole buffer if the pool does not push to links
+  struct Group {
+    boost::optional<uint32_t> linkId;
+    std::vector<size_t> freeSlots;
+  };
+
+  void addGroup(boost::optional<uint32_t> linkId, size_t offset, size_t size, size_t superpageSize);
+
+  virtual DmaChannelInterface& getPoolChannel(size_t channel) const override;
+  virtual size_t refillChannel(size_t channel) override;
+  virtual void acquired(size_t channel) override;
+  virtual void release(size_t channel, size_t slot) override;
+
+  DmaChannelInterface& mChannel;
+  const size_t mBufferSize;
+
+  std::vector<Group> mGroups;
+
+  /// Group of each slot
+  std::vector<size_t> mSlotGroups;
+
+  /// Protects the free slots and the statistics, since handles may be released from another thread
+  mutable std::mutex mMutex;
+  Statistics mStatistics;
+};
+
+} // namespace roc
+} // namespace o2
+
+#endif // O2_READOUTCARD_INCLUDE_SUPERPAGEPOOL_H_
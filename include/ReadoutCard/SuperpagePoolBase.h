@@ -0,0 +1,158 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file SuperpagePoolBase.h
+/// \brief Definition of the SuperpagePoolBase class.
+
+#ifndef O2_READOUTCARD_INCLUDE_SUPERPAGEPOOLBASE_H_
+#define O2_READOUTCARD_INCLUDE_SUPERPAGEPOOLBASE_H_
+
+#include "ReadoutCard/NamespaceAlias.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <boost/optional.hpp>
+#include "ReadoutCard/DmaChannelInterface.h"
+#include "ReadoutCard/ParameterTypes/BufferParameters.h"
+#include "ReadoutCard/Superpage.h"
+
+namespace o2
+{
+namespace roc
+{
+
+/// Common part of the pools that carve a DMA buffer into superpages and hand out the filled ones as handles: the
+/// handles, the carving of the buffer into slots, and the acquisition of the filled superpages. The pools decide which
+/// free superpages are pushed to which channel.
+class SuperpagePoolBase
+{
+ public:
+  /// Granularity of the superpage sizes
+  static constexpr size_t SIZE_GRANULARITY = 32 * 1024;
+
+  /// A superpage acquired from a pool. It goes back to the pool when released or destroyed.
+  class Handle
+  {
+   public:
+    /// Creates an empty handle
+    Handle() = default;
+    Handle(Handle&& other) noexcept;
+    Handle& operator=(Handle&& other) noexcept;
+    Handle(const Handle&) = delete;
+    Handle& operator=(const Handle&) = delete;
+    ~Handle();
+
+    /// Returns true if the handle holds a superpage
+    explicit operator bool() const
+    {
+      return mPool != nullptr;
+    }
+
+    /// Index of the channel the superpage was popped from. Always 0 for a pool of a single channel.
+    size_t getChannel() const
+    {
+      return mChannel;
+    }
+
+    /// The superpage as popped from the channel. It is not ready if it was returned unfilled when DMA stopped.
+    const Superpage& getSuperpage() const
+    {
+      return mSuperpage;
+    }
+
+    const Superpage* operator->() const
+    {
+      return &mSuperpage;
+    }
+
+    /// Address of the start of the superpage in the DMA buffer
+    char* getData() const;
+
+    /// Gives the superpage back to the pool, leaving the handle empty. Does nothing if it is empty.
+    void release();
+
+   private:
+    friend class SuperpagePoolBase;
+    Handle(SuperpagePoolBase* pool, size_t channel, size_t slot, const Superpage& superpage);
+
+    SuperpagePoolBase* mPool = nullptr;
+    size_t mChannel = 0;
+    size_t mSlot = 0;
+    Superpage mSuperpage;
+  };
+
+  SuperpagePoolBase(const SuperpagePoolBase&) = delete;
+  SuperpagePoolBase& operator=(const SuperpagePoolBase&) = delete;
+
+  /// Total amount of superpages carved from the buffer
+  size_t getSuperpageCount() const
+  {
+    return mSlots.size();
+  }
+
+ protected:
+  /// \param name Name of the pool class, for exception messages
+  /// \param buffer The buffer registered with the channels
+  SuperpagePoolBase(std::string name, const buffer_parameters::Memory& buffer);
+  virtual ~SuperpagePoolBase() = default;
+
+  /// Finds the superpages of the given size within a range of the buffer that are contiguous in the bus address space
+  /// of every channel, and adds them as slots. Ranges must be added in increasing order of offset.
+  /// \param linkId Link the superpages are for, if any, for exception messages
+  /// \param freeSlots Stack of free slots the new slots are pushed on, so that they are taken in order of offset
+  /// \exception ParameterException The size is not a non-zero multiple of SIZE_GRANULARITY, or no superpage fits
+  void addSlots(const std::vector<DmaChannelInterface*>& channels, size_t superpageSize, size_t offset, size_t size,
+                boost::optional<uint32_t> linkId, std::vector<size_t>& freeSlots);
+
+  /// The superpage of a slot, as pushed to a channel
+  Superpage getSlotSuperpage(size_t slot) const
+  {
+    return Superpage(mSlots[slot].offset, mSlots[slot].size);
+  }
+
+  /// Refills a channel, then pops a superpage from its ready queue
+  Handle tryAcquireFrom(size_t channel);
+
+  /// Like tryAcquireFrom(), but waits up to the given time for a superpage to be ready
+  Handle acquireFrom(size_t channel, std::chrono::microseconds timeout);
+
+  /// Channel of the given index
+  virtual DmaChannelInterface& getPoolChannel(size_t channel) const = 0;
+
+  /// Pushes free superpages to a channel
+  virtual size_t refillChannel(size_t channel) = 0;
+
+  /// Counts a superpage handed out to the user
+  virtual void acquired(size_t channel) = 0;
+
+  /// Takes back a superpage released by the user. May be called from any thread.
+  virtual void release(size_t channel, size_t slot) = 0;
+
+  const std::string mName;
+  char* const mBufferAddress;
+
+ private:
+  /// A superpage carved from the buffer
+  struct Slot {
+    size_t offset;
+    size_t size;
+  };
+
+  size_t findSlot(const Superpage& superpage) const;
+
+  /// Superpages ordered by offset
+  std::vector<Slot> mSlots;
+};
+
+} // namespace roc
+} // namespace o2
+
+#endif // O2_READOUTCARD_INCLUDE_SUPERPAGEPOOLBASE_H_
@@ -58,6 +58,11 @@ void BarInterfaceBase::modifyRegister(int index, int position, int width, uint32
   mPdaBar->modifyRegister(index, position, width, value);
 }
 
+void BarInterfaceBase::readRegisterBlock(int index, uint32_t* values, size_t count)
+{
+  mPdaBar->readRegisterBlock(index, values, count);
+}
+
 void BarInterfaceBase::log(const std::string& logMessage, ILMessageOption ilgMsgOption)
 {
   Logger::get() << mLoggerPrefix << logMessage << ilgMsgOption << endm;
@@ -42,6 +42,7 @@ class BarInterfaceBase : public BarInterface
   virtual uint32_t readRegister(int index) override;
   virtual void writeRegister(int index, uint32_t value) override;
   virtual void modifyRegister(int index, int position, int width, uint32_t value) override;
+  virtual void readRegisterBlock(int index, uint32_t* values, size_t count) override;
 
   virtual int getIndex() const override
   {
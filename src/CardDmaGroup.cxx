@@ -0,0 +1,332 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file CardDmaGroup.cxx
+/// \brief Implementation of the CardDmaGroup class.
+
+#include "ReadoutCard/CardDmaGroup.h"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <thread>
+#include <boost/exception/diagnostic_information.hpp>
+#include "folly/ProducerConsumerQueue.h"
+#include "DriverThread.h"
+#include "ExceptionInternal.h"
+#include "ReadoutCard/ChannelFactory.h"
+#include "ReadoutCard/Logger.h"
+#include "Utilities/Polling.h"
+
+namespace o2
+{
+namespace roc
+{
+
+namespace
+{
+/// Most passes the Readiness policy skips an idle channel for
+constexpr uint32_t MAX_SKIP_PASSES = 16;
+
+std::vector<std::shared_ptr<DmaChannelInterface>> openChannels(const std::vector<Parameters>& parameters)
+{
+  std::vector<std::shared_ptr<DmaChannelInterface>> channels;
+  for (const auto& channelParameters : parameters) {
+    channels.push_back(ChannelFactory().getDmaChannel(channelParameters));
+  }
+  return channels;
+}
+} // namespace
+
+struct CardDmaGroupChannel {
+  CardDmaGroupChannel(std::shared_ptr<DmaChannelInterface> dmaChannel, uint32_t queueCapacity)
+    : channel(std::move(dmaChannel)), pciAddress(channel->getPciAddress()), pushQueue(queueCapacity + 1)
+  {
+  }
+
+  std::shared_ptr<DmaChannelInterface> channel;
+  const PciAddress pciAddress;
+  /// Superpages queued by the user, pushed to the channel by the poller thread
+  folly::ProducerConsumerQueue<Superpage> pushQueue;
+
+  // Only used by the poller thread while DMA runs
+  size_t inFlight = 0;     ///< Superpages pushed to the channel and not popped yet
+  uint32_t skipPasses = 0; ///< Passes to skip after the channel's last unproductive poll
+  uint32_t skipsLeft = 0;  ///< Passes left to skip
+};
+
+struct CardDmaGroupInternal {
+  CardDmaGroupInternal(std::vector<std::shared_ptr<DmaChannelInterface>> dmaChannels, CardDmaGroup::Options groupOptions)
+    : options(groupOptions), readyQueue(groupOptions.queueCapacity + 1)
+  {
+    if (dmaChannels.empty()) {
+      BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("CardDmaGroup needs at least one channel"));
+    }
+    if (options.queueCapacity == 0) {
+      BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("CardDmaGroup queue capacity must be non-zero"));
+    }
+    for (auto& channel : dmaChannels) {
+      if (!channel) {
+        BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("CardDmaGroup channel is null"));
+      }
+      channels.push_back(std::make_unique<CardDmaGroupChannel>(std::move(channel), options.queueCapacity));
+    }
+  }
+
+  CardDmaGroupChannel& getChannel(size_t index) const
+  {
+    if (index >= channels.size()) {
+      BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("CardDmaGroup channel index out of range")
+                                                 << ErrorInfo::Index(index));
+    }
+    return *channels[index];
+  }
+
+  const CardDmaGroup::Options options;
+  std::vector<std::unique_ptr<CardDmaGroupChannel>> channels;
+  /// Ready superpages of all channels, written by the poller thread
+  folly::ProducerConsumerQueue<CardDmaGroup::ReadySuperpage> readyQueue;
+  /// Superpages collected from the channels and push queues when DMA stopped
+  std::deque<CardDmaGroup::ReadySuperpage> reclaimed;
+  std::unique_ptr<DriverThread> driverThread;
+  bool running = false;
+
+  struct {
+    std::atomic<uint64_t> passes{ 0 };
+    std::atomic<uint64_t> channelPolls{ 0 };
+    std::atomic<uint64_t> channelSkips{ 0 };
+    std::atomic<uint64_t> superpagesPushed{ 0 };
+    std::atomic<uint64_t> superpagesDelivered{ 0 };
+  } counters;
+};
+
+CardDmaGroup::CardDmaGroup(std::vector<std::shared_ptr<DmaChannelInterface>> channels, Options options)
+  : mInternal(std::make_unique<CardDmaGroupInternal>(std::move(channels), options))
+{
+}
+
+CardDmaGroup::CardDmaGroup(std::vector<std::shared_ptr<DmaChannelInterface>> channels)
+  : CardDmaGroup(std::move(channels), Options())
+{
+}
+
+CardDmaGroup::CardDmaGroup(const std::vector<Parameters>& parameters, Options options)
+  : CardDmaGroup(openChannels(parameters), options)
+{
+}
+
+CardDmaGroup::CardDmaGroup(const std::vector<Parameters>& parameters)
+  : CardDmaGroup(openChannels(parameters), Options())
+{
+}
+
+CardDmaGroup::~CardDmaGroup()
+{
+  try {
+    stopDma();
+  } catch (const std::exception& exception) {
+    Logger::get() << "[CardDmaGroup] Failed to stop DMA: " << boost::diagnostic_information(exception)
+                  << LogErrorDevel_(4225) << endm;
+  }
+}
+
+void CardDmaGroup::startDma()
+{
+  if (mInternal->running) {
+    return;
+  }
+
+  size_t started = 0;
+  try {
+    for (; started < mInternal->channels.size(); ++started) {
+      mInternal->channels[started]->channel->startDma();
+    }
+
+    for (auto& state : mInternal->channels) {
+      state->inFlight = 0;
+      state->skipPasses = 0;
+      state->skipsLeft = 0;
+    }
+    mInternal->driverThread = std::make_unique<DriverThread>([this] { return poll(); }, mInternal->options.waitPolicy,
+                                                             mInternal->options.cpu, "[CardDmaGroup] ");
+  } catch (const std::exception&) {
+    // Leave no channel half of a running group. A channel that also fails to stop must not hide the original error,
+    // or keep the channels after it running.
+    for (size_t i = 0; i < started; ++i) {
+      try {
+        mInternal->channels[i]->channel->stopDma();
+      } catch (const std::exception& exception) {
+        Logger::get() << "[CardDmaGroup] Failed to stop channel " << i << " after failed start: "
+                      << boost::diagnostic_information(exception) << LogErrorDevel_(4225) << endm;
+      }
+    }
+    throw;
+  }
+  mInternal->running = true;
+}
+
+void CardDmaGroup::stopDma()
+{
+  if (!mInternal->running) {
+    return;
+  }
+  mInternal->running = false;
+
+  std::exception_ptr exception = mInternal->driverThread->stop();
+  mInternal->driverThread.reset();
+
+  for (size_t i = 0; i < mInternal->channels.size(); ++i) {
+    auto& state = *mInternal->channels[i];
+    try {
+      state.channel->stopDma();
+    } catch (const std::exception&) {
+      if (!exception) {
+        exception = std::current_exception();
+      }
+    }
+    while (auto superpage = state.channel->tryPopSuperpage()) {
+      mInternal->reclaimed.push_back(ReadySuperpage{ i, state.pciAddress, *superpage });
+    }
+    while (auto superpage = state.pushQueue.frontPtr()) {
+      mInternal->reclaimed.push_back(ReadySuperpage{ i, state.pciAddress, *superpage });
+      state.pushQueue.popFront();
+    }
+    state.inFlight = 0;
+  }
+
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+}
+
+bool CardDmaGroup::poll()
+{
+  auto& internal = *mInternal;
+  const bool readiness = internal.options.pollPolicy == PollPolicy::Readiness;
+  uint64_t polls = 0;
+  uint64_t skips = 0;
+  uint64_t totalPushed = 0;
+  uint64_t totalDelivered = 0;
+
+  for (size_t i = 0; i < internal.channels.size(); ++i) {
+    auto& state = *internal.channels[i];
+    if (state.inFlight == 0 && state.pushQueue.isEmpty()) {
+      continue;
+    }
+    if (readiness && state.skipsLeft > 0) {
+      state.skipsLeft--;
+      skips++;
+      continue;
+    }
+    polls++;
+
+    size_t pushed = 0;
+    while (auto superpage = state.pushQueue.frontPtr()) {
+      auto status = state.channel->tryPushSuperpage(*superpage);
+      if (status == PushStatus::InvalidSuperpage) {
+        BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("CardDmaGroup superpage rejected by the channel")
+                                          << ErrorInfo::Index(i)
+                                          << ErrorInfo::Offset(superpage->getOffset()));
+      }
+      if (status != PushStatus::Ok) {
+        break;
+      }
+      state.pushQueue.popFront();
+      pushed++;
+    }
+
+    state.channel->fillSuperpages();
+
+    // A full merged queue leaves the superpages in the channel, holding it back until the user pops
+    size_t delivered = 0;
+    while (!internal.readyQueue.isFull()) {
+      auto superpage = state.channel->tryPopSuperpage();
+      if (!superpage) {
+        break;
+      }
+      internal.readyQueue.write(ReadySuperpage{ i, state.pciAddress, *superpage });
+      delivered++;
+    }
+
+    state.inFlight += pushed;
+    state.inFlight -= std::min(state.inFlight, delivered);
+    if (pushed > 0 || delivered > 0) {
+      state.skipPasses = 0;
+    } else {
+      state.skipPasses = std::min(std::max<uint32_t>(1, state.skipPasses * 2), MAX_SKIP_PASSES);
+    }
+    state.skipsLeft = state.skipPasses;
+    totalPushed += pushed;
+    totalDelivered += delivered;
+  }
+
+  Utilities::addRelaxed(internal.counters.passes);
+  Utilities::addRelaxed(internal.counters.channelPolls, polls);
+  Utilities::addRelaxed(internal.counters.channelSkips, skips);
+  Utilities::addRelaxed(internal.counters.superpagesPushed, totalPushed);
+  Utilities::addRelaxed(internal.counters.superpagesDelivered, totalDelivered);
+  return totalPushed > 0 || totalDelivered > 0;
+}
+
+bool CardDmaGroup::pushSuperpage(size_t channel, const Superpage& superpage)
+{
+  auto& state = mInternal->getChannel(channel);
+  return mInternal->running && state.pushQueue.write(superpage);
+}
+
+size_t CardDmaGroup::getPushAvailable(size_t channel) const
+{
+  return mInternal->options.queueCapacity - mInternal->getChannel(channel).pushQueue.sizeGuess();
+}
+
+auto CardDmaGroup::tryPopSuperpage() -> boost::optional<ReadySuperpage>
+{
+  if (auto superpage = mInternal->readyQueue.frontPtr()) {
+    ReadySuperpage ready = *superpage;
+    mInternal->readyQueue.popFront();
+    return ready;
+  }
+  if (!mInternal->reclaimed.empty()) {
+    ReadySuperpage ready = mInternal->reclaimed.front();
+    mInternal->reclaimed.pop_front();
+    return ready;
+  }
+  return boost::none;
+}
+
+bool CardDmaGroup::waitForReady(std::chrono::microseconds timeout)
+{
+  return Utilities::pollWithBackoff(mInternal->options.waitPolicy, timeout,
+                                    [&] { return !mInternal->readyQueue.isEmpty() || !mInternal->reclaimed.empty(); });
+}
+
+size_t CardDmaGroup::getChannelCount() const
+{
+  return mInternal->channels.size();
+}
+
+DmaChannelInterface& CardDmaGroup::getChannel(size_t channel)
+{
+  return *mInternal->getChannel(channel).channel;
+}
+
+auto CardDmaGroup::getStatistics() const -> Statistics
+{
+  const auto& counters = mInternal->counters;
+  Statistics statistics;
+  statistics.passes = counters.passes.load(std::memory_order_relaxed);
+  statistics.channelPolls = counters.channelPolls.load(std::memory_order_relaxed);
+  statistics.channelSkips = counters.channelSkips.load(std::memory_order_relaxed);
+  statistics.superpagesPushed = counters.superpagesPushed.load(std::memory_order_relaxed);
+  statistics.superpagesDelivered = counters.superpagesDelivered.load(std::memory_order_relaxed);
+  return statistics;
+}
+
+} // namespace roc
+} // namespace o2
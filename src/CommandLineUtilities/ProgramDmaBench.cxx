@@ -15,9 +15,11 @@
 /// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
 /// \author Kostas Alexopoulos (kostas.alexopoulos@cern.ch)
 
+#include <algorithm>
 #include <chrono>
 #include <iomanip>
 #include <iostream>
+#include <numeric>
 #include <future>
 #include <fstream>
 #include <random>
@@ -92,6 +94,8 @@ struct TimeLimit {
 struct SuperpageInfo {
   size_t bufferOffset;
   size_t effectiveSize;
+  /// Holds the superpage when it was acquired from the SuperpagePool
+  SuperpagePool::Handle handle;
 };
 } // Anonymous namespace
 
@@ -123,6 +127,10 @@ class ProgramDmaBench : public Program
     options.add_options()("bar-hammer",
                           po::bool_switch(&mOptions.barHammer),
                           "Stress the BAR with repeated writes and measure performance");
+    options.add_options()("batch-size",
+                          po::value<size_t>(&mOptions.batchSize)->default_value(1),
+                          "Number of superpages exchanged per push/pop call. 1 uses the single-item pushSuperpage() and "
+                          "popSuperpage() path, higher values use pushSuperpages() and popSuperpages()");
     options.add_options()("bytes",
                           SuffixOption<uint64_t>::make(&mOptions.maxBytes)->default_value("0"),
                           "Limit of bytes to transfer. Give 0 for infinite.");
@@ -133,18 +141,53 @@ class ProgramDmaBench : public Program
                           SuffixOption<size_t>::make(&mBufferSize)->default_value("1Gi"),
                           "Buffer size in bytes. Rounded down to 2 MiB multiple. Minimum of 2 MiB. Use 2 MiB hugepage by default; |"
                           "if buffer size is a multiple of 1 GiB, will try to use GiB hugepages");
+    options.add_options()("crorc-pipeline-depth",
+                          po::value<size_t>(&mOptions.crorcPipelineDepth)->default_value(1),
+                          "CRORC only: number of superpages pushed to the firmware at a time. More than 1 requires the time "
+                          "frame detection to be disabled");
+    options.add_options()("crorc-push-verification",
+                          po::value<std::string>(&mOptions.crorcPushVerificationString)->default_value("always"),
+                          "CRORC only: superpage push register writes read back [always, size-only, sampled]");
+    options.add_options()("crorc-push-verification-interval",
+                          po::value<size_t>(&mOptions.crorcPushVerificationInterval)->default_value(64),
+                          "CRORC only: with sampled push verification, one push out of this many is verified");
     options.add_options()("data-source",
                           po::value<std::string>(&mOptions.dataSourceString)->default_value("INTERNAL"),
                           "Data source [FEE, INTERNAL, DIU, SIU, DDG]");
     options.add_options()("dma-channel",
                           po::value<int>(&mOptions.dmaChannel)->default_value(0),
                           "DMA channel selection (note: C-RORC has channels 0 to 5, CRU only 0)");
+    options.add_options()("emulator-links",
+                          po::value<std::string>(&mOptions.emulatorLinks)->default_value("0"),
+                          "Emulator only (--id=-1): links to generate data for, e.g. '0-3,8'");
+    options.add_options()("emulator-rate",
+                          SuffixOption<size_t>::make(&mOptions.emulatorDataRate)->default_value("0"),
+                          "Emulator only (--id=-1): total data rate in bytes per second. Give 0 for no limit");
     options.add_options()("error-check-frequency",
                           po::value<uint64_t>(&mOptions.errorCheckFrequency)->default_value(1),
                           "Frequency of dma pages to check for errors");
     options.add_options()("fast-check",
                           po::bool_switch(&mOptions.fastCheckEnabled),
                           "Enable fast error checking");
+    options.add_options()("fast-restart",
+                          po::bool_switch(&mOptions.fastRestart),
+                          "CRU only: restart DMA without resetting the card when it holds no superpages");
+    options.add_options()("link-batch-read",
+                          po::bool_switch(&mOptions.linkBatchRead),
+                          "CRU only: read the superpage counters of the links in one block read per poll, skipping links "
+                          "with no superpages in flight");
+    options.add_options()("link-in-flight-max",
+                          po::value<size_t>(&mOptions.linkInFlightMax)->default_value(0),
+                          "CRU only: most superpages in flight per link with the controlled link scheduler, 0 for the "
+                          "link queue capacity");
+    options.add_options()("link-in-flight-min",
+                          po::value<size_t>(&mOptions.linkInFlightMin)->default_value(0),
+                          "CRU only: fewest superpages in flight per link with the controlled link scheduler, 0 for the "
+                          "default");
+    options.add_options()("link-scheduler",
+                          po::value<std::string>(&mOptions.linkSchedulerString)->default_value("free-slot"),
+                          "CRU only: policy deciding which link gets the next superpage [free-slot, rate-weighted, "
+                          "controlled]");
     Options::addOptionCardId(options);
     options.add_options()("max-rdh-packetcount",
                           po::value<size_t>(&mOptions.maxRdhPacketCounter)->default_value(255),
@@ -169,7 +212,8 @@ class ProgramDmaBench : public Program
                           "Card DMA page size");
     options.add_options()("pause-push",
                           po::value<uint64_t>(&mOptions.pausePush)->default_value(1),
-                          "Push thread pause time in microseconds if no work can be done");
+                          "Push thread pause time in microseconds if no work can be done. With --wait-ready, this is "
+                          "the sleep time of the wait policy");
     options.add_options()("pause-read",
                           po::value<uint64_t>(&mOptions.pauseRead)->default_value(10),
                           "Readout thread pause time in microseconds if no work can be done");
@@ -179,9 +223,32 @@ class ProgramDmaBench : public Program
     options.add_options()("random-pause",
                           po::bool_switch(&mOptions.randomPause),
                           "Randomly pause readout");
+    options.add_options()("replay-file",
+                          po::value<std::vector<std::string>>(&mOptions.replayFiles)->multitoken(),
+                          "Emulator only (--id=-1): replay the given files, recorded with --to-file-bin, instead of "
+                          "generating data. Use with --data-source=FEE");
+    options.add_options()("replay-loop",
+                          po::bool_switch(&mOptions.replayLoop),
+                          "Emulator only (--id=-1): replay the files again when their end is reached");
+    options.add_options()("replay-speed",
+                          po::value<double>(&mOptions.replaySpeed)->default_value(0.0),
+                          "Emulator only (--id=-1): replay speed relative to the recorded orbits, 1 for real time. Give 0 "
+                          "to replay as fast as possible");
+    options.add_options()("restart-cycles",
+                          po::value<size_t>(&mOptions.restartCycles)->default_value(0),
+                          "After the benchmark, time this many DMA stop/start cycles of the open channel, without "
+                          "superpages pushed");
     options.add_options()("stbrd",
                           po::bool_switch(&mOptions.stbrd),
                           "Set the STBRD trigger command for the CRORC");
+    options.add_options()("superpage-pool",
+                          po::bool_switch(&mOptions.superpagePool),
+                          "Let a SuperpagePool carve the buffer and push the superpages, instead of pushing them from the "
+                          "benchmark's own free queue");
+    options.add_options()("superpage-timestamp",
+                          po::bool_switch(&mOptions.superpageTimestamp),
+                          "Record the arrival time of superpages, and report how long they spent in the card's queue and "
+                          "in the ready queue");
     options.add_options()("superpage-size",
                           SuffixOption<size_t>::make(&mSuperpageSize)->default_value("1Mi"),
                           "Superpage size in bytes. Note that it can't be larger than the buffer. If the IOMMU is not enabled, the "
@@ -198,6 +265,10 @@ class ProgramDmaBench : public Program
     options.add_options()("to-file-bin",
                           po::value<std::string>(&mOptions.fileOutputPathBin),
                           "Read out to given file in binary format (only contains raw data from pages)");
+    options.add_options()("wait-ready",
+                          po::bool_switch(&mOptions.waitReady),
+                          "Push thread waits for superpages with waitForReady() and a spin/yield/sleep policy, instead of "
+                          "sleeping a fixed --pause-push time");
     options.add_options()("bypass-fw-check",
                           po::bool_switch(&mOptions.bypassFirmwareCheck),
                           "Flag to bypass the firmware checker");
@@ -227,6 +298,34 @@ class ProgramDmaBench : public Program
     params.setDmaPageSize(mOptions.dmaPageSize);
     params.setDataSource(DataSource::fromString(mOptions.dataSourceString));
     params.setFirmwareCheckEnabled(!mOptions.bypassFirmwareCheck);
+    if (mOptions.waitReady) {
+      WaitPolicy waitPolicy;
+      waitPolicy.sleepMicroseconds = mOptions.pausePush;
+      params.setReadyWaitPolicy(waitPolicy);
+    }
+    params.setLinkStatusBatchReadEnabled(mOptions.linkBatchRead);
+    params.setLinkSchedulerPolicy(LinkSchedulerPolicy::fromString(mOptions.linkSchedulerString));
+    if (mOptions.linkInFlightMin != 0) {
+      params.setLinkInFlightMin(mOptions.linkInFlightMin);
+    }
+    if (mOptions.linkInFlightMax != 0) {
+      params.setLinkInFlightMax(mOptions.linkInFlightMax);
+    }
+    params.setFastRestartEnabled(mOptions.fastRestart);
+    params.setSuperpageTimestampEnabled(mOptions.superpageTimestamp);
+    params.setCrorcPipelineDepth(mOptions.crorcPipelineDepth);
+    params.setCrorcPushVerification(PushVerification::fromString(mOptions.crorcPushVerificationString));
+    params.setCrorcPushVerificationInterval(mOptions.crorcPushVerificationInterval);
+    auto serialId = boost::get<SerialId>(&cardId);
+    if (serialId && serialId->getSerial() == SERIAL_DUMMY) {
+      params.setLinkMask(Parameters::linkMaskFromString(mOptions.emulatorLinks));
+      params.setEmulatorDataRate(mOptions.emulatorDataRate);
+      if (!mOptions.replayFiles.empty()) {
+        params.setReplayFiles(mOptions.replayFiles);
+        params.setReplaySpeed(mOptions.replaySpeed);
+        params.setReplayLoopEnabled(mOptions.replayLoop);
+      }
+    }
 
     mDataSource = params.getDataSourceRequired();
 
@@ -282,12 +381,19 @@ class ProgramDmaBench : public Program
     std::cout << "Buffer size: " << mBufferSize << std::endl;
     std::cout << "Superpage size: " << mSuperpageSize << std::endl;
     std::cout << "Superpages in buffer: " << mSuperpagesInBuffer << std::endl;
+    if (mOptions.superpageTimestamp) {
+      mArrivalStats.pushTimes.resize(mSuperpagesInBuffer);
+    }
     std::cout << "Superpage limit: " << mSuperpageLimit << std::endl;
     std::cout << "DMA page size: " << mPageSize << std::endl;
     if (mOptions.bufferFullCheck) {
       std::cout << "Buffer-Full Check enabled" << std::endl;
       mBufferFullCheck = true;
     }
+    if (mOptions.superpagePool && (mOptions.bufferFullCheck || mOptions.superpageTimestamp)) {
+      BOOST_THROW_EXCEPTION(ParameterException()
+                            << ErrorInfo::Message("--superpage-pool can't be combined with --buffer-full-check or --superpage-timestamp"));
+    }
 
     if (!mOptions.noErrorCheck) {
       if (mOptions.errorCheckFrequency < 0x1 || mOptions.errorCheckFrequency > 0xff) {
@@ -323,6 +429,11 @@ class ProgramDmaBench : public Program
     std::cout << "Card NUMA node: " << mChannel->getNumaNode() << std::endl;
     std::cout << "Card firmware info: " << mChannel->getFirmwareInfo().value_or("unknown") << std::endl;
 
+    if (mOptions.superpagePool) {
+      mSuperpagePool = std::make_unique<SuperpagePool>(
+        *mChannel, buffer_parameters::Memory{ mMemoryMappedFile->getAddress(), mMemoryMappedFile->getSize() }, mSuperpageSize);
+    }
+
     std::cout << "Starting benchmark" << std::endl;
     mChannel->startDma();
 
@@ -359,6 +470,9 @@ class ProgramDmaBench : public Program
 
     outputErrors();
     outputStats();
+    if (mOptions.restartCycles > 0) {
+      outputRestartLatency(mOptions.restartCycles);
+    }
     std::cout << "Benchmark complete" << std::endl;
   }
 
@@ -376,8 +490,16 @@ class ProgramDmaBench : public Program
     /// arrive, they are passed via the readoutQueue to the readout thread. When the readout thread is done with it,
     /// it is put back in the freeQueue.
     folly::ProducerConsumerQueue<size_t> freeQueue{ static_cast<uint32_t>(mSuperpagesInBuffer) + 1 };
-    for (size_t i = 0; i < mSuperpagesInBuffer; ++i) {
-      size_t offset = i * mSuperpageSize;
+    // Without the IOMMU, superpages can only be placed where the buffer is contiguous in bus address space
+    auto offsets = mChannel->getSuperpageOffsets(mSuperpageSize);
+    if (offsets.empty()) {
+      throw std::runtime_error("No superpage fits in a bus-contiguous part of the buffer");
+    }
+    if (offsets.size() < mSuperpagesInBuffer) {
+      std::cout << "Superpages contiguous in bus address space: " << offsets.size() << " of " << mSuperpagesInBuffer
+                << std::endl;
+    }
+    for (size_t offset : offsets) {
       if (!freeQueue.write(offset)) {
         BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Something went horribly wrong"));
       }
@@ -434,10 +556,71 @@ class ProgramDmaBench : public Program
       }
     });
 
+    // Exchanges superpages with the channel using the batched pushSuperpages() and popSuperpages() calls
+    auto pushAndPopBatched = [&](std::vector<Superpage>& batch) {
+      // Gather as many free superpages as the transfer queue can take, and push them in one call
+      size_t available = std::min(size_t(std::max(mChannel->getTransferQueueAvailable(), 0)), batch.size());
+      size_t count = 0;
+      size_t offsetRead;
+      while (count < available && freeQueue.read(offsetRead)) {
+        batch[count] = Superpage(offsetRead, mSuperpageSize);
+        recordPush(offsetRead);
+        count++;
+      }
+      if (count > 0) {
+        auto start = std::chrono::steady_clock::now();
+        size_t pushed = mChannel->pushSuperpages(batch.data(), count);
+        mPushCalls.add(start, pushed);
+        updatePeakInFlight();
+        if (pushed != count) {
+          BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Channel accepted fewer superpages than were available"));
+        }
+      }
+
+      // Pop filled superpages in one call and move them to the readout queue. The readout queue can hold every
+      // superpage of the buffer, so writing to it cannot fail.
+      auto start = std::chrono::steady_clock::now();
+      size_t popped = mChannel->popSuperpages(batch.data(), batch.size());
+      if (popped == 0) {
+        return;
+      }
+      mPopCalls.add(start, popped);
+      for (size_t i = 0; i < popped; ++i) {
+        fetchAddSuperpagesPushed();
+        if (mBufferFullCheck && (mSuperpagesPushed.load(std::memory_order_relaxed) == mSuperpageLimit)) {
+          mBufferFullTimeFinish = std::chrono::high_resolution_clock::now();
+          mDmaLoopBreak = true;
+        }
+        recordPop(batch[i]);
+        auto received = batch[i].isReady() ? batch[i].getReceived() : 0;
+        readoutQueue.write(SuperpageInfo{ batch[i].getOffset(), received, {} });
+      }
+    };
+
+    // Exchanges superpages with the channel through the SuperpagePool, which pushes the superpages released by the
+    // readout thread
+    auto acquireFromPool = [&] {
+      while (auto handle = mSuperpagePool->tryAcquire()) {
+        fetchAddSuperpagesPushed();
+        auto received = handle->isReady() ? handle->getReceived() : 0;
+        readoutQueue.write(SuperpageInfo{ handle->getOffset(), received, std::move(handle) });
+      }
+    };
+
     // Thread for pushing & checking arrivals
     auto pushFuture = std::async(std::launch::async, [&] {
       try {
         RandomPauses pauses{};
+        std::vector<Superpage> batch(mOptions.batchSize);
+
+        // Pause when no work can be done, either a fixed time or until a superpage is ready
+        auto rest = [&] {
+          if (mOptions.waitReady) {
+            mChannel->waitForReady(LOW_PRIORITY_INTERVAL);
+          } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(mOptions.pausePush));
+          }
+        };
 
         while (!isStopDma()) {
           // Check if we need to stop in the case of a superpage limit
@@ -453,6 +636,18 @@ class ProgramDmaBench : public Program
 
           bool shouldRest = true;
 
+          if (mSuperpagePool) {
+            acquireFromPool();
+            rest();
+            continue;
+          }
+
+          if (mOptions.batchSize > 1) {
+            pushAndPopBatched(batch);
+            rest();
+            continue;
+          }
+
           while (mChannel->getTransferQueueAvailable() != 0) {
             Superpage superpage;
             size_t offsetRead;
@@ -460,7 +655,11 @@ class ProgramDmaBench : public Program
             if (freeQueue.read(offsetRead)) {
               superpage.setSize(mSuperpageSize);
               superpage.setOffset(offsetRead);
+              recordPush(offsetRead);
+              auto start = std::chrono::steady_clock::now();
               mChannel->pushSuperpage(superpage);
+              mPushCalls.add(start, 1);
+              updatePeakInFlight();
             } else {
               // freeQueue is backed up and we should rest
               shouldRest = true;
@@ -479,8 +678,11 @@ class ProgramDmaBench : public Program
             }
 
             // Move full superpage to readout queue
-            if (superpage.isReady() && readoutQueue.write(SuperpageInfo{ superpage.getOffset(), superpage.getReceived() })) {
+            if (superpage.isReady() && readoutQueue.write(SuperpageInfo{ superpage.getOffset(), superpage.getReceived(), {} })) {
+              recordPop(superpage);
+              auto start = std::chrono::steady_clock::now();
               mChannel->popSuperpage();
+              mPopCalls.add(start, 1);
             } else {
               // readyQueue(=readout) is backed up, so rest a while
               shouldRest = true;
@@ -489,7 +691,7 @@ class ProgramDmaBench : public Program
           }
 
           if (shouldRest) {
-            std::this_thread::sleep_for(std::chrono::microseconds(mOptions.pausePush));
+            rest();
           }
         }
       } catch (std::exception& e) {
@@ -542,7 +744,9 @@ class ProgramDmaBench : public Program
 
           // Page has been read out
           // Add superpage back to free queue
-          if (!freeQueue.write(superpageInfo.bufferOffset)) {
+          if (superpageInfo.handle) {
+            superpageInfo.handle.release();
+          } else if (!freeQueue.write(superpageInfo.bufferOffset)) {
             mDmaLoopBreak = true;
             BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Something went horribly wrong"));
           }
@@ -1023,6 +1227,59 @@ class ProgramDmaBench : public Program
       put("Total time needed to fill the buffer (ns) ", std::chrono::duration_cast<std::chrono::nanoseconds>(mBufferFullTimeFinish - mBufferFullTimeStart).count());
     }
 
+    auto putCalls = [&](auto name, const ApiCallStats& stats) {
+      if (stats.calls == 0) {
+        return;
+      }
+      put((b::format("%1% calls") % name).str(), stats.calls.load());
+      put((b::format("%1% superpages/call") % name).str(), double(stats.superpages) / stats.calls);
+      put((b::format("%1% ns/call") % name).str(), double(stats.nanoseconds) / stats.calls);
+      put((b::format("%1% ns/superpage") % name).str(), double(stats.nanoseconds) / stats.superpages);
+    };
+    putCalls("Push", mPushCalls);
+    putCalls("Pop", mPopCalls);
+    if (mSuperpagePool) {
+      auto pool = mSuperpagePool->getStatistics();
+      put("Pool superpages pushed", pool.superpagesPushed);
+      put("Pool starved refills", pool.starvedRefills);
+    }
+    put("Peak in-flight", mPeakInFlight.load());
+    put("Peak in-flight (MiB)", double(mPeakInFlight.load() * mSuperpageSize) / (1024 * 1024));
+
+    if (mArrivalStats.superpages > 0) {
+      put("Card queue time avg (us)", double(mArrivalStats.cardQueueNanoseconds) / mArrivalStats.superpages / 1000);
+      put("Card queue time max (us)", double(mArrivalStats.cardQueueMaxNanoseconds) / 1000);
+      put("Ready queue time avg (us)", double(mArrivalStats.readyQueueNanoseconds) / mArrivalStats.superpages / 1000);
+      put("Out of sequence superpages", mArrivalStats.outOfSequence);
+    }
+
+    auto polls = mChannel->getPollStatistics();
+    if (mOptions.waitReady) {
+      put("Productive polls", polls.productivePolls);
+      put("Empty polls", polls.emptyPolls);
+      put("Poll yields", polls.yields);
+      put("Poll sleeps", polls.sleeps);
+    }
+    if (polls.registerReads > 0 && polls.superpagesReady > 0) {
+      put("BAR reads", polls.registerReads);
+      put("BAR reads/superpage", double(polls.registerReads) / polls.superpagesReady);
+      put("Size index lags", polls.indexLags);
+    }
+
+    for (const auto& link : mChannel->getStatistics().links) {
+      // Upper bound of the histogram bucket holding the median fill time
+      uint64_t seen = 0;
+      size_t bucket = 0;
+      while (bucket + 1 < link.fillTimes.size() && (seen += link.fillTimes[bucket]) * 2 < link.superpagesFilled) {
+        bucket++;
+      }
+      put((b::format("Link %d superpages") % link.linkId).str(), link.superpagesFilled);
+      put((b::format("Link %d MB") % link.linkId).str(), double(link.bytesReceived) / (1000 * 1000));
+      if (link.superpagesFilled > 0) {
+        put((b::format("Link %d fill time (us)") % link.linkId).str(), (b::format("< %d median") % (uint64_t(1) << bucket)).str());
+      }
+    }
+
     if (mOptions.barHammer) {
       size_t writeSize = sizeof(uint32_t);
       double hammerCount = mBarHammer->getCount();
@@ -1038,6 +1295,40 @@ class ProgramDmaBench : public Program
     cout << '\n';
   }
 
+  /// Times stop/start cycles of the channel, which keeps its buffer registration. The first start may be slower, as it
+  /// has to reset the card if superpages were reclaimed when the benchmark stopped.
+  void outputRestartLatency(size_t cycles)
+  {
+    auto microseconds = [](TimePoint start) {
+      return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    };
+    std::vector<double> startTimes;
+    std::vector<double> stopTimes;
+    for (size_t i = 0; i < cycles; ++i) {
+      auto start = std::chrono::steady_clock::now();
+      mChannel->startDma();
+      startTimes.push_back(microseconds(start));
+
+      start = std::chrono::steady_clock::now();
+      mChannel->stopDma();
+      stopTimes.push_back(microseconds(start));
+
+      while (mChannel->getReadyQueueSize() > 0) {
+        mChannel->popSuperpage();
+      }
+    }
+
+    auto put = [&](auto label, const std::vector<double>& times) {
+      auto minMax = std::minmax_element(times.begin(), times.end());
+      double mean = std::accumulate(times.begin(), times.end(), 0.0) / times.size();
+      cout << b::format("  %-24s  %.1f / %.1f / %.1f\n") % label % *minMax.first % mean % *minMax.second;
+    };
+    cout << "\n  Restart latency over " << cycles << " cycles (us, min / mean / max)" << (mOptions.fastRestart ? ", fast restart" : "") << '\n';
+    put("DMA start", startTimes);
+    put("DMA stop", stopTimes);
+    cout << '\n';
+  }
+
   void outputErrors()
   {
     auto errorStr = mErrorStream.str();
@@ -1197,11 +1488,113 @@ class ProgramDmaBench : public Program
     uint32_t timeFrameLength = 256;
     bool printSuperpageChange = false;
     bool noTimeFrameCheck = false;
+    size_t batchSize = 1;
+    bool waitReady = false;
+    bool linkBatchRead = false;
+    std::string linkSchedulerString;
+    size_t linkInFlightMin = 0;
+    size_t linkInFlightMax = 0;
+    bool fastRestart = false;
+    size_t restartCycles = 0;
+    bool superpageTimestamp = false;
+    bool superpagePool = false;
+    size_t crorcPipelineDepth = 1;
+    std::string crorcPushVerificationString;
+    size_t crorcPushVerificationInterval = 64;
+    std::string emulatorLinks;
+    size_t emulatorDataRate = 0;
+    std::vector<std::string> replayFiles;
+    double replaySpeed = 0.0;
+    bool replayLoop = false;
   } mOptions;
 
+  /// Time spent in the channel's push or pop calls, to compare the per-call overhead of the single-item and the
+  /// batched paths
+  struct ApiCallStats {
+    std::atomic<uint64_t> calls{ 0 };
+    std::atomic<uint64_t> superpages{ 0 };
+    std::atomic<uint64_t> nanoseconds{ 0 };
+
+    void add(TimePoint start, size_t count)
+    {
+      auto duration = std::chrono::steady_clock::now() - start;
+      calls.fetch_add(1, std::memory_order_relaxed);
+      superpages.fetch_add(count, std::memory_order_relaxed);
+      nanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(), std::memory_order_relaxed);
+    }
+  };
+
+  /// Statistics of the push calls
+  ApiCallStats mPushCalls;
+
+  /// Statistics of the pop calls
+  ApiCallStats mPopCalls;
+
+  /// Highest amount of superpages pushed to the channel and not popped yet, to show how much of the buffer the driver
+  /// holds on to
+  std::atomic<uint64_t> mPeakInFlight{ 0 };
+
+  void updatePeakInFlight()
+  {
+    uint64_t inFlight = mPushCalls.superpages.load(std::memory_order_relaxed) - mPopCalls.superpages.load(std::memory_order_relaxed);
+    if (inFlight > mPeakInFlight.load(std::memory_order_relaxed)) {
+      mPeakInFlight.store(inFlight, std::memory_order_relaxed);
+    }
+  }
+
+  /// Time superpages spend in the card's queue and in the ready queue, from their arrival timestamps. Only accessed by
+  /// the push thread, and after it finished.
+  struct ArrivalStats {
+    std::vector<uint64_t> pushTimes; ///< Push time of each superpage of the buffer, in ns of the steady clock
+    std::array<boost::optional<uint16_t>, MAX_LINKS + 1> nextSequence; ///< Expected next sequence number per link
+    uint64_t superpages = 0;
+    uint64_t cardQueueNanoseconds = 0;
+    uint64_t cardQueueMaxNanoseconds = 0;
+    uint64_t readyQueueNanoseconds = 0;
+    uint64_t outOfSequence = 0;
+  } mArrivalStats;
+
+  static uint64_t getSteadyNanoseconds()
+  {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+  }
+
+  void recordPush(size_t offset)
+  {
+    if (mOptions.superpageTimestamp) {
+      mArrivalStats.pushTimes[offset / mSuperpageSize] = getSteadyNanoseconds();
+    }
+  }
+
+  void recordPop(const Superpage& superpage)
+  {
+    if (!mOptions.superpageTimestamp || !superpage.isReady() || superpage.getArrivalTime() == 0) {
+      return;
+    }
+    auto& stats = mArrivalStats;
+    auto arrival = superpage.getArrivalTime();
+    auto cardQueue = arrival - stats.pushTimes[superpage.getOffset() / mSuperpageSize];
+    stats.superpages++;
+    stats.cardQueueNanoseconds += cardQueue;
+    stats.cardQueueMaxNanoseconds = std::max(stats.cardQueueMaxNanoseconds, cardQueue);
+    stats.readyQueueNanoseconds += getSteadyNanoseconds() - arrival;
+
+    // Superpages without a link (C-RORC) use the last entry
+    auto link = superpage.getLink();
+    auto& next = stats.nextSequence[(link >= 0 && link < MAX_LINKS) ? link : MAX_LINKS];
+    if (next && *next != superpage.getSequence()) {
+      stats.outOfSequence++;
+    }
+    next = uint16_t(superpage.getSequence() + 1);
+  }
+
   /// The DMA channel
   std::shared_ptr<DmaChannelInterface> mChannel;
 
+  /// Pool of the superpages of the buffer, with --superpage-pool
+  std::unique_ptr<SuperpagePool> mSuperpagePool;
+
   /// The type of the card we're using
   CardType::type mCardType;
 
@@ -49,6 +49,15 @@ struct PacketMonitoringInfo {
   uint32_t packetsReceived;
 };
 
+/// Superpage pushes since the data receiver was last stopped
+struct PushStatistics {
+  uint64_t pushes = 0;
+  uint64_t verifiedPushes = 0; ///< Pushes with at least one register read back
+  uint64_t errors = 0;         ///< Read back mismatches and exceptions
+  uint64_t totalLatencyNanoseconds = 0;
+  uint64_t maxLatencyNanoseconds = 0;
+};
+
 } // namespace Crorc
 } // namespace roc
 } // namespace o2
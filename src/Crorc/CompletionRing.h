@@ -0,0 +1,151 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file CompletionRing.h
+/// \brief Definition of the CompletionRing class, reading the superpage completions from the superpage info buffer
+
+#ifndef O2_READOUTCARD_CRORC_COMPLETIONRING_H_
+#define O2_READOUTCARD_CRORC_COMPLETIONRING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <boost/optional.hpp>
+
+namespace o2
+{
+namespace roc
+{
+
+/// Consumer of the superpage completions the C-RORC firmware writes to the superpage info DMA buffer.
+///
+/// Older firmware only writes the size of the last filled superpage and an 8-bit counter of the filled superpages, so
+/// the size of the other superpages filled since the last poll is not known. Firmware writing the completion ring
+/// announces it with RING_MAGIC, and writes the size of every filled superpage to the ring entry of its producer index
+/// before incrementing that index. The scheme is chosen at the first completion after reset(), so both kinds of
+/// firmware are supported by the same buffer.
+///
+/// Not thread-safe: only used by the thread doing the driver work. Lock-free with respect to the firmware.
+class CompletionRing
+{
+ public:
+  /// Value of the ringMagic field when the firmware writes the completion ring
+  static constexpr uint32_t RING_MAGIC = 0x474e4952;
+
+  /// Amount of entries of the completion ring
+  static constexpr uint32_t RING_ENTRIES = 256;
+
+  /// Layout of the superpage info buffer
+  struct Layout {
+    volatile uint32_t size;          ///< Size in bytes of the last filled superpage, old firmware only
+    volatile uint32_t count;         ///< Counter of the filled superpages, 8 bits wide, old firmware only
+    volatile uint32_t producerIndex; ///< Amount of ring entries written, wraps around at 32 bits
+    volatile uint32_t ringMagic;     ///< RING_MAGIC if the firmware writes the ring
+    volatile uint32_t sizes[RING_ENTRIES]; ///< Size in bytes of the filled superpages, at producerIndex % RING_ENTRIES
+  };
+
+  /// \param buffer The superpage info buffer, at least sizeof(Layout) bytes
+  CompletionRing(void* buffer) : mLayout(reinterpret_cast<Layout*>(buffer))
+  {
+  }
+
+  /// Clears the buffer and forgets the scheme in use, to be called before the firmware starts writing to it
+  void reset()
+  {
+    mLayout->size = 0;
+    mLayout->count = 0xff; // The first count written by the firmware is 0
+    mLayout->producerIndex = 0;
+    mLayout->ringMagic = 0;
+    mConsumerIndex = 0;
+    mCount = 0xff;
+    mScheme = Scheme::Unknown;
+  }
+
+  /// \return True if the firmware was found writing the completion ring
+  bool isRingActive() const
+  {
+    return mScheme == Scheme::Ring;
+  }
+
+  /// Hands the superpages filled since the last call, in the order they were filled, to a function
+  /// \param maxSuperpages Most superpages to hand out, the rest is kept for the next call
+  /// \param function Called with the size of each superpage in bytes. The size is empty for the superpages that old
+  ///   firmware filled completely without reporting their size.
+  /// \return The number of superpages handed out
+  template <typename Function>
+  size_t consume(size_t maxSuperpages, Function function)
+  {
+    if (mScheme == Scheme::Unknown) {
+      if (mLayout->producerIndex != mConsumerIndex && mLayout->ringMagic == RING_MAGIC) {
+        mScheme = Scheme::Ring;
+      } else if (mLayout->count != mCount) {
+        mScheme = mLayout->ringMagic == RING_MAGIC ? Scheme::Ring : Scheme::Counter;
+      } else {
+        return 0;
+      }
+    }
+    return (mScheme == Scheme::Ring) ? consumeRing(maxSuperpages, function) : consumeCounter(maxSuperpages, function);
+  }
+
+ private:
+  enum class Scheme {
+    Unknown,
+    Counter,
+    Ring
+  };
+
+  template <typename Function>
+  size_t consumeRing(size_t maxSuperpages, Function function)
+  {
+    uint32_t available = mLayout->producerIndex - mConsumerIndex;
+    // The entries are written before the producer index
+    std::atomic_thread_fence(std::memory_order_acquire);
+    size_t consumed = 0;
+    while (consumed < available && consumed < maxSuperpages) {
+      uint32_t size = mLayout->sizes[mConsumerIndex % RING_ENTRIES];
+      function(boost::optional<uint32_t>(size));
+      mConsumerIndex++;
+      consumed++;
+    }
+    return consumed;
+  }
+
+  template <typename Function>
+  size_t consumeCounter(size_t maxSuperpages, Function function)
+  {
+    uint32_t count = mLayout->count;
+    uint32_t available = (count - mCount) & 0xff;
+    size_t consumed = 0;
+    while (consumed < available && consumed < maxSuperpages) {
+      consumed++;
+      // Only the last filled superpage can be partially filled, see CrorcDmaChannel::deviceStartDma()
+      if (consumed == available) {
+        uint32_t size = mLayout->size;
+        function(boost::optional<uint32_t>(size));
+      } else {
+        function(boost::optional<uint32_t>());
+      }
+    }
+    mCount = (mCount + consumed) & 0xff;
+    return consumed;
+  }
+
+  Layout* const mLayout;
+  /// Ring entries consumed
+  uint32_t mConsumerIndex = 0;
+  /// Counter value of the last superpage consumed, with the counter scheme
+  uint32_t mCount = 0xff;
+  Scheme mScheme = Scheme::Unknown;
+};
+
+} // namespace roc
+} // namespace o2
+
+#endif // O2_READOUTCARD_CRORC_COMPLETIONRING_H_
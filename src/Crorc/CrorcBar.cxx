@@ -15,12 +15,14 @@
 /// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
 /// \author Kostas Alexopoulos (kostas.alexopoulos@cern.ch)
 
+#include <algorithm>
 #include <chrono>
 #include <thread>
 
 #include "Crorc/Constants.h"
 #include "Crorc/Crorc.h"
 #include "Crorc/CrorcBar.h"
+#include "ExceptionInternal.h"
 
 #include "ReadoutCard/ChannelFactory.h"
 #include "ReadoutCard/ParameterTypes/SerialId.h"
@@ -40,8 +42,13 @@ CrorcBar::CrorcBar(const Parameters& parameters, std::unique_ptr<RocPciDevice> r
     mDynamicOffset(parameters.getDynamicOffsetEnabled().get_value_or(false)),
     mLinkMask(parameters.getLinkMask().get_value_or(std::set<uint32_t>{ 0, 1, 2, 3, 4, 5 })),
     mTimeFrameLength(parameters.getTimeFrameLength().get_value_or(0x100)),
-    mTimeFrameDetectionEnabled(parameters.getTimeFrameDetectionEnabled().get_value_or(true))
+    mTimeFrameDetectionEnabled(parameters.getTimeFrameDetectionEnabled().get_value_or(true)),
+    mPushVerification(parameters.getCrorcPushVerification().get_value_or(PushVerification::Always)),
+    mPushVerificationInterval(parameters.getCrorcPushVerificationInterval().get_value_or(64))
 {
+  if (mPushVerificationInterval == 0) {
+    BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message(getLoggerPrefix() + "Push verification interval must be at least 1"));
+  }
 }
 
 CrorcBar::CrorcBar(std::shared_ptr<Pda::PdaBar> bar)
@@ -376,6 +383,9 @@ void CrorcBar::stopDataReceiver()
   nSPpush = 0;
   nSPpushErr = 0;
   nSPcounter = 0;
+  nSPpushVerified = 0;
+  mPushLatencyTotal = 0;
+  mPushLatencyMax = 0;
 }
 
 void CrorcBar::pushSuperpageAddressAndSize(uintptr_t blockAddress, uint32_t blockLength)
@@ -386,6 +396,8 @@ void CrorcBar::pushSuperpageAddressAndSize(uintptr_t blockAddress, uint32_t bloc
   writeRegister(Crorc::Registers::SP_WR_SIZE.index, blockLength);
 */
 
+  auto start = std::chrono::steady_clock::now();
+
   uint32_t vwr; // value to write
   uint32_t vxp; // value expected on read back (not always = vwr)
   uint32_t vrd; // value read back
@@ -402,36 +414,70 @@ void CrorcBar::pushSuperpageAddressAndSize(uintptr_t blockAddress, uint32_t bloc
     return 0;
   };
 
+  // Each read back is a blocking PCIe round trip, so the policy may skip some of them
+  bool verifyAddress = true;
+  bool verifySize = true;
+  if (mPushVerification == PushVerification::SizeOnly) {
+    verifyAddress = false;
+  } else if (mPushVerification == PushVerification::Sampled) {
+    verifyAddress = verifySize = (nSPpush % mPushVerificationInterval) == 0;
+  }
+
   try {
     nSPpush++;
+    if (verifySize) {
+      nSPpushVerified++;
+    }
 
     ix = Crorc::Registers::SP_WR_ADDR_HIGH.index;
     vxp = vwr = arch64() ? (blockAddress >> 32) : 0x0;
     writeRegister(ix, vwr);
-    vrd = readRegister(ix);
-    checkSuccess();
+    if (verifyAddress) {
+      vrd = readRegister(ix);
+      checkSuccess();
+    }
 
     ix = Crorc::Registers::SP_WR_ADDR_LOW.index;
     vxp = vwr = blockAddress & 0xffffffff;
     writeRegister(ix, vwr);
-    vrd = readRegister(ix);
-    checkSuccess();
+    if (verifyAddress) {
+      vrd = readRegister(ix);
+      checkSuccess();
+    }
 
+    // The counter is kept up to date on unverified pushes too, so a push lost in between shows up as a mismatch on the
+    // next verified one. Resynchronizing on the device counter reports such a loss once, not on every later push.
     ix = Crorc::Registers::SP_WR_SIZE.index;
     vxp = vwr = blockLength;
     vxp = (vwr << 8) | (++nSPcounter); // weird feature of crorc
     writeRegister(ix, vwr);
-    vrd = readRegister(ix);
-    if (!checkSuccess()) {
+    if (verifySize) {
+      vrd = readRegister(ix);
+      checkSuccess();
       nSPcounter = vrd & 0xFF;
     }
   } catch(...) {
     nSPpushErr++;
     log("pushSuperpageAddress exception", LogErrorDevel_(4699));
   }
+
+  uint64_t latency = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+  mPushLatencyTotal += latency;
+  mPushLatencyMax = std::max(mPushLatencyMax, latency);
   return;
 }
 
+Crorc::PushStatistics CrorcBar::getPushStatistics() const
+{
+  Crorc::PushStatistics statistics;
+  statistics.pushes = nSPpush;
+  statistics.verifiedPushes = nSPpushVerified;
+  statistics.errors = nSPpushErr;
+  statistics.totalLatencyNanoseconds = mPushLatencyTotal;
+  statistics.maxLatencyNanoseconds = mPushLatencyMax;
+  return statistics;
+}
+
 void CrorcBar::startDataGenerator()
 {
   modifyRegister(Crorc::Registers::DATA_GENERATOR_CFG.index, 31, 1, 0x1);
@@ -57,6 +57,7 @@ class CrorcBar final : public BarInterfaceBase
 
   void resetDevice(bool withSiu);
   void flushSuperpages();
+  bool getTimeFrameDetectionEnabled();
   void startDataReceiver(uintptr_t superpageInfoBusAddress);
   void stopDataReceiver();
   void startDataGenerator();
@@ -67,6 +68,7 @@ class CrorcBar final : public BarInterfaceBase
   bool checkLinkUp();
   void assertLinkUp();
   void pushSuperpageAddressAndSize(uintptr_t blockAddress, uint32_t blockLength);
+  Crorc::PushStatistics getPushStatistics() const;
   void setLoopback();
   void setDiuLoopback();
   void setSiuLoopback();
@@ -75,6 +77,7 @@ class CrorcBar final : public BarInterfaceBase
   int nSPpush = 0; // total pages pushed
   int nSPpushErr = 0; // number of push errors
   uint8_t nSPcounter = 0; // 8-bit push counter as in device
+  int nSPpushVerified = 0; // pushes read back
 
  private:
   std::map<int, Crorc::Link> initializeLinkMap();
@@ -93,7 +96,6 @@ class CrorcBar final : public BarInterfaceBase
   void setTimeFrameLength(uint16_t timeFrameLength);
   uint16_t getTimeFrameLength();
   void setTimeFrameDetectionEnabled(bool enabled);
-  bool getTimeFrameDetectionEnabled();
   void getOpticalPowers(std::map<int, Crorc::Link>& linkMap);
 
   void resetSiu();
@@ -105,6 +107,11 @@ class CrorcBar final : public BarInterfaceBase
   std::set<uint32_t> mLinkMask;
   uint16_t mTimeFrameLength;
   bool mTimeFrameDetectionEnabled;
+  PushVerification::type mPushVerification = PushVerification::Always;
+  size_t mPushVerificationInterval = 64;
+
+  uint64_t mPushLatencyTotal = 0; // nanoseconds
+  uint64_t mPushLatencyMax = 0; // nanoseconds
 };
 
 } // namespace roc
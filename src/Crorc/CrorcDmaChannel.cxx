@@ -16,6 +16,7 @@
 /// \author Kostas Alexopoulos (kostas.alexopoulos@cern.ch)
 
 #include "CrorcDmaChannel.h"
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <sstream>
@@ -37,7 +38,8 @@ CrorcDmaChannel::CrorcDmaChannel(const Parameters& parameters)
   : DmaChannelPdaBase(parameters, allowedChannels()),
     mPageSize(parameters.getDmaPageSize().get_value_or(DMA_PAGE_SIZE)), // 8 kB default for uniformity with CRU
     mSTBRD(parameters.getStbrdEnabled().get_value_or(false)),
-    mDataSource(parameters.getDataSource().get_value_or(DataSource::Internal)) // Internal loopback by default
+    mDataSource(parameters.getDataSource().get_value_or(DataSource::Internal)), // Internal loopback by default
+    mPipelineDepthRequested(parameters.getCrorcPipelineDepth().get_value_or(1))
 {
   // Check that the DMA page is valid
   if (mPageSize != DMA_PAGE_SIZE) {
@@ -51,6 +53,11 @@ CrorcDmaChannel::CrorcDmaChannel(const Parameters& parameters)
                                          << ErrorInfo::DataSource(mDataSource));
   }
 
+  if (mPipelineDepthRequested < 1 || mPipelineDepthRequested > MAX_PIPELINE_DEPTH) {
+    BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message(getLoggerPrefix() + "CRORC pipeline depth must be between 1 and " +
+                                                                     std::to_string(MAX_PIPELINE_DEPTH)));
+  }
+
   mGeneratorEnabled = (mDataSource == DataSource::Fee) ? false : true;
 
   // Set mRDYRX if generator is disabled and mSTBRD is false
@@ -61,6 +68,8 @@ CrorcDmaChannel::CrorcDmaChannel(const Parameters& parameters)
   // Prep for BAR
   auto bar = ChannelFactory().getBar(parameters);
   crorcBar = std::move(std::dynamic_pointer_cast<CrorcBar>(bar)); // Initialize bar
+  mRegisterLock = RegisterLock::get(getPciAddress().toString());
+  initializeLinkCounters({ 0 }, INTERMEDIATE_QUEUE_CAPACITY);
 
   // Create and register our Superpage info (size + count) buffer
   log("Initializing Superpage info buffer", LogDebugDevel_(4300));
@@ -84,8 +93,8 @@ CrorcDmaChannel::CrorcDmaChannel(const Parameters& parameters)
     mSuperpageInfoAddressBus = entry.addressBus;
   }
 
-  // Start this from 0xff, as the first valid count to be written will be 0x0
-  getSuperpageInfoUser()->count = 0xff;
+  mCompletionRing = std::make_unique<CompletionRing>(reinterpret_cast<void*>(mSuperpageInfoAddressUser));
+  mCompletionRing->reset();
 
   if (mDataSource == DataSource::Fee || mDataSource == DataSource::Siu) {
     deviceResetChannel(ResetLevel::InternalSiu);
@@ -101,14 +110,27 @@ auto CrorcDmaChannel::allowedChannels() -> AllowedChannels
 
 CrorcDmaChannel::~CrorcDmaChannel()
 {
+  stopDriverThread();
 }
 
 void CrorcDmaChannel::deviceStartDma()
 {
   // reset fifo ready counters
-  getSuperpageInfoUser()->size = 0;
-  getSuperpageInfoUser()->count = 0xff;
-  mSPAvailCount = 0xff;
+  mCompletionRing->reset();
+  mSuperpageCounter = 0;
+  mRegisterLockStatistics = RegisterLock::Statistics();
+
+  // Older firmware only reports the size of the last superpage filled. With time frame detection, superpages may be
+  // closed before they are full, so the size of each one has to be read before the next one is filled. The depth is
+  // restored once the firmware is found writing the completion ring, see deviceFillSuperpages().
+  mPipelineDepth = mPipelineDepthRequested;
+  if (mPipelineDepth > 1 && getBar()->getTimeFrameDetectionEnabled()) {
+    log("Time frame detection is enabled, pushing one superpage at a time to the firmware", LogWarningDevel_(4304));
+    mPipelineDepth = 1;
+  }
+  if (mPipelineDepth > 1) {
+    log((boost::format("Pushing up to %1% superpages at a time to the firmware") % mPipelineDepth).str(), LogInfoDevel_(4305));
+  }
 
   deviceResetChannel(ResetLevel::Internal);
 
@@ -147,20 +169,36 @@ void CrorcDmaChannel::deviceStopDma()
     }
   }
   getBar()->flushSuperpages();
+
+  auto pushes = getBar()->getPushStatistics();
+  if (pushes.pushes > 0) {
+    log((boost::format("Superpage pushes: %1%, verified: %2%, errors: %3%, latency mean: %4% ns, max: %5% ns") %
+         pushes.pushes % pushes.verifiedPushes % pushes.errors % (pushes.totalLatencyNanoseconds / pushes.pushes) %
+         pushes.maxLatencyNanoseconds)
+          .str(),
+        LogInfoDevel_(4306));
+  }
+  const auto& locking = mRegisterLockStatistics;
+  if (locking.contentions > 0) {
+    log((boost::format("Register lock acquisitions: %1%, contended: %2%, wait mean: %3% ns, max: %4% ns") %
+         locking.acquisitions % locking.contentions % (locking.totalWaitNanoseconds / locking.contentions) %
+         locking.maxWaitNanoseconds)
+          .str(),
+        LogInfoDevel_(4307));
+  }
   getBar()->stopDataReceiver();
 
-  // handling of last superpage pushed, being it ready or not
+  // handling of the superpages pushed, being they ready or not. The flushed one is the last one filled.
+  uint64_t returned = mCompletionRing->consume(mIntermediateQueue.sizeGuess(),
+                                               [&](boost::optional<uint32_t> size) { transferFilledSuperpage(size); });
   while (!mIntermediateQueue.isEmpty()) {
     auto superpage = mIntermediateQueue.frontPtr();
-    if (isASuperpageAvailable()) {
-      superpage->setReceived(getSuperpageInfoUser()->size); // length in bytes
-      superpage->setReady(true);
-    } else {
-      superpage->setReceived(0); // page was not used yet
-      superpage->setReady(false);
-    }
+    superpage->setReceived(0); // page was not used yet
+    superpage->setReady(false);
+    getLinkCounters(0).reclaimed();
     mReadyQueue.write(*superpage);
     mIntermediateQueue.popFront();
+    returned++;
     // printf("\n*** %04d *** final pop 0x%p : intermediate -> ready (size %d)\n\n", __LINE__, (void*)(superpage->getOffset()), (int)superpage->getReceived());
   }
 
@@ -171,8 +209,11 @@ void CrorcDmaChannel::deviceStopDma()
     superpage->setReady(false);
     mReadyQueue.write(*superpage);
     mTransferQueue.popFront();
+    returned++;
     // printf("\n*** %04d *** final pop 0x%p : transfer -> ready\n\n", __LINE__, (void*)(superpage->getOffset()));
   }
+
+  notifyReady(returned);
 }
 
 void CrorcDmaChannel::deviceResetChannel(ResetLevel::type resetLevel)
@@ -212,6 +253,17 @@ int CrorcDmaChannel::getTransferQueueAvailable()
   return TRANSFER_QUEUE_CAPACITY - mTransferQueue.sizeGuess();
 }
 
+int CrorcDmaChannel::getTransferQueueAvailable(uint32_t)
+{
+  // The C-RORC has a single queue, superpages can't be pushed to a specific link
+  return 0;
+}
+
+std::vector<uint32_t> CrorcDmaChannel::getDataTakingLinks()
+{
+  return {};
+}
+
 int CrorcDmaChannel::getReadyQueueSize()
 {
   return mReadyQueue.sizeGuess();
@@ -238,65 +290,136 @@ bool CrorcDmaChannel::pushSuperpage(Superpage superpage)
   }
 
   mTransferQueue.write(superpage);
+  countUserPush(superpage);
 
   return true;
 }
 
+bool CrorcDmaChannel::pushSuperpage(Superpage, uint32_t)
+{
+  BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(getLoggerPrefix() + "Pushing a superpage to a specific link is not supported by the C-RORC"));
+}
+
 auto CrorcDmaChannel::popSuperpage() -> Superpage
 {
   if (mReadyQueue.isEmpty()) {
     BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(getLoggerPrefix() + "Could not pop superpage, ready queue was empty"));
   }
-  auto superpage = mReadyQueue.frontPtr();
+  auto superpage = *mReadyQueue.frontPtr();
   mReadyQueue.popFront();
-  return *superpage;
+  countUserPops(&superpage, 1);
+  return superpage;
 }
 
-bool CrorcDmaChannel::isASuperpageAvailable()
+size_t CrorcDmaChannel::pushSuperpages(const Superpage* superpages, size_t count)
 {
-  uint32_t newCount = getSuperpageInfoUser()->count;
-  uint32_t diff;
+  if (mDmaState != DmaState::STARTED) {
+    return 0;
+  }
 
-  if (newCount < mSPAvailCount) { // handle overflow
-    diff = ((0xff + 1) - 0xff) + newCount;
-  } else {
-    diff = newCount - mSPAvailCount;
+  size_t pushed = 0;
+  while (pushed < count && mTransferQueue.sizeGuess() < TRANSFER_QUEUE_CAPACITY) {
+    checkSuperpage(superpages[pushed]);
+    mTransferQueue.write(superpages[pushed]);
+    countUserPush(superpages[pushed]);
+    pushed++;
   }
-  mSPAvailCount = newCount;
 
-  return diff > 0;
+  return pushed;
 }
 
-std::mutex lockFillSuperpages;
+size_t CrorcDmaChannel::popSuperpages(Superpage* superpages, size_t maxCount)
+{
+  size_t popped = popFront(mReadyQueue, superpages, maxCount);
+  countUserPops(superpages, popped);
+  return popped;
+}
 
-void CrorcDmaChannel::fillSuperpages()
+PushStatus::type CrorcDmaChannel::tryPushSuperpage(const Superpage& superpage)
 {
-  // ensure there is no concurrency to access registers
-  // because this causes HW problems, cf issue O2-3772
-  std::unique_lock<std::mutex> lock(lockFillSuperpages);
+  if (mDmaState != DmaState::STARTED) {
+    return PushStatus::DmaNotStarted;
+  }
 
-  // Check for arrivals & handle them
-  if (!mIntermediateQueue.isEmpty() && isASuperpageAvailable()) {
+  if (!isSuperpageValid(superpage)) {
+    return PushStatus::InvalidSuperpage;
+  }
 
-    auto superpage = mIntermediateQueue.frontPtr();
-    superpage->setReceived(getSuperpageInfoUser()->size); // length in bytes
-    superpage->setReady(true);
-    mReadyQueue.write(*superpage);
-    mIntermediateQueue.popFront();
-    // printf("\n*** %04d *** pop 0x%p : intermediate -> ready (size %d)\n\n", __LINE__, (void*)(superpage->getOffset()), (int)superpage->getReceived());
+  if (mTransferQueue.sizeGuess() >= TRANSFER_QUEUE_CAPACITY) {
+    return PushStatus::QueueFull;
   }
 
-  // Push single Superpage to the firmware when available
-  if (mIntermediateQueue.isEmpty() && !mTransferQueue.isEmpty()) {
-    auto inSuperpage = mTransferQueue.frontPtr();
-    mTransferQueue.popFront();
+  mTransferQueue.write(superpage);
+  countUserPush(superpage);
+
+  return PushStatus::Ok;
+}
+
+boost::optional<Superpage> CrorcDmaChannel::tryPeekSuperpage()
+{
+  return tryPeekFront(mReadyQueue);
+}
+
+boost::optional<Superpage> CrorcDmaChannel::tryPopSuperpage()
+{
+  auto superpage = tryPopFront(mReadyQueue);
+  if (superpage) {
+    countUserPops(&*superpage, 1);
+  }
+  return superpage;
+}
+
+void CrorcDmaChannel::transferFilledSuperpage(boost::optional<uint32_t> size)
+{
+  auto superpage = mIntermediateQueue.frontPtr();
+  stampArrivalTime(*superpage);
+  superpage->setSequence(mSuperpageCounter++);
+  superpage->setReceived(size.get_value_or(superpage->getSize())); // length in bytes
+  superpage->setReady(true);
+  getLinkCounters(0).filled(superpage->getReceived(), getSteadyTime());
+  mReadyQueue.write(*superpage);
+  mIntermediateQueue.popFront();
+  // printf("\n*** %04d *** pop 0x%p : intermediate -> ready (size %d)\n\n", __LINE__, (void*)(superpage->getOffset()), (int)superpage->getReceived());
+}
+
+size_t CrorcDmaChannel::deviceFillSuperpages()
+{
+  // ensure there is no concurrency to access registers of the card
+  // because this causes HW problems, cf issue O2-3772
+  auto lock = mRegisterLock->acquire(mRegisterLockStatistics);
+
+  // Check for arrivals & handle them. Superpages are filled in the order they were pushed.
+  size_t transferred = 0;
+  if (!mIntermediateQueue.isEmpty()) {
+    transferred = mCompletionRing->consume(mIntermediateQueue.sizeGuess(),
+                                           [&](boost::optional<uint32_t> size) { transferFilledSuperpage(size); });
+    notifyReady(transferred);
+  }
+
+  if (mPipelineDepth < mPipelineDepthRequested && mCompletionRing->isRingActive()) {
+    log((boost::format("Firmware reports the size of every superpage, pushing up to %1% superpages at a time") %
+         mPipelineDepthRequested)
+          .str(),
+        LogInfoDevel_(4308));
+    mPipelineDepth = mPipelineDepthRequested;
+  }
+
+  // Keep the firmware's queue topped up with superpages
+  while (mIntermediateQueue.sizeGuess() < mPipelineDepth) {
+    auto inSuperpage = tryPopFront(mTransferQueue);
+    if (!inSuperpage) {
+      break;
+    }
 
     auto busAddress = getBusOffsetAddress(inSuperpage->getOffset());
     getBar()->pushSuperpageAddressAndSize(busAddress, inSuperpage->getSize());
+    getLinkCounters(0).pushed(getSteadyTime());
 
     mIntermediateQueue.write(*inSuperpage);
     // printf("\n*** %04d *** push 0x%p : transfer -> intermediate\n\n", __LINE__, (void*)(inSuperpage->getOffset()));
   }
+
+  return transferred;
 }
 
 // Return a boolean that denotes whether the transfer queue is empty
@@ -23,8 +23,9 @@
 #include <boost/scoped_ptr.hpp>
 #include "DmaChannelPdaBase.h"
 #include "CrorcBar.h"
+#include "Crorc/CompletionRing.h"
+#include "Crorc/RegisterLock.h"
 #include "ReadoutCard/Parameters.h"
-#include "folly/ProducerConsumerQueue.h"
 
 namespace o2
 {
@@ -49,13 +50,20 @@ class CrorcDmaChannel final : public DmaChannelPdaBase
   virtual boost::optional<std::string> getFirmwareInfo() override;
 
   virtual bool pushSuperpage(Superpage superpage) override;
+  virtual bool pushSuperpage(Superpage superpage, uint32_t linkId) override;
 
   virtual int getTransferQueueAvailable() override;
+  virtual int getTransferQueueAvailable(uint32_t linkId) override;
+  virtual std::vector<uint32_t> getDataTakingLinks() override;
   virtual int getReadyQueueSize() override;
 
   virtual Superpage getSuperpage() override;
   virtual Superpage popSuperpage() override;
-  virtual void fillSuperpages() override;
+  virtual size_t pushSuperpages(const Superpage* superpages, size_t count) override;
+  virtual size_t popSuperpages(Superpage* superpages, size_t maxCount) override;
+  virtual PushStatus::type tryPushSuperpage(const Superpage& superpage) override;
+  virtual boost::optional<Superpage> tryPeekSuperpage() override;
+  virtual boost::optional<Superpage> tryPopSuperpage() override;
   virtual bool isTransferQueueEmpty() override;
   virtual bool isReadyQueueFull() override;
   virtual int32_t getDroppedPackets() override;
@@ -63,10 +71,14 @@ class CrorcDmaChannel final : public DmaChannelPdaBase
 
   AllowedChannels allowedChannels();
 
+  /// Max amount of superpages pushed to the firmware at a time, see the CrorcPipelineDepth parameter
+  static constexpr size_t MAX_PIPELINE_DEPTH = 16;
+
  protected:
   virtual void deviceStartDma() override;
   virtual void deviceStopDma() override;
   virtual void deviceResetChannel(ResetLevel::type resetLevel = ResetLevel::InternalSiu) override;
+  virtual size_t deviceFillSuperpages() override;
 
  private:
   /// Superpage size supported by the CRORC backend
@@ -80,21 +92,18 @@ class CrorcDmaChannel final : public DmaChannelPdaBase
   static constexpr size_t TRANSFER_QUEUE_CAPACITY_ALLOCATIONS = TRANSFER_QUEUE_CAPACITY + 1; // folly Queue needs + 1
 
   /// Max amount of superpages in the intermediate queue (i.e. pushed superpage).
-  /// CRORC FW only handles a single superpage at a time
-  static constexpr size_t INTERMEDIATE_QUEUE_CAPACITY = 1;
+  static constexpr size_t INTERMEDIATE_QUEUE_CAPACITY = MAX_PIPELINE_DEPTH;
   static constexpr size_t INTERMEDIATE_QUEUE_CAPACITY_ALLOCATIONS = INTERMEDIATE_QUEUE_CAPACITY + 1;
 
   /// Max amount of superpages in the ready queue (i.e. finished transfer).
-  /// This is an arbitrary size, can easily be increased if more headroom is needed.
-  static constexpr size_t READY_QUEUE_CAPACITY = TRANSFER_QUEUE_CAPACITY;
-  static constexpr size_t READY_QUEUE_CAPACITY_ALLOCATIONS = TRANSFER_QUEUE_CAPACITY_ALLOCATIONS;
+  /// Large enough to take all the superpages in flight when DMA stops.
+  static constexpr size_t READY_QUEUE_CAPACITY = TRANSFER_QUEUE_CAPACITY + INTERMEDIATE_QUEUE_CAPACITY;
+  static constexpr size_t READY_QUEUE_CAPACITY_ALLOCATIONS = READY_QUEUE_CAPACITY + 1; // folly Queue needs + 1
 
   /// Minimum number of superpages needed to bootstrap DMA
   //static constexpr size_t DMA_START_REQUIRED_SUPERPAGES = 1;
   //static constexpr size_t DMA_START_REQUIRED_SUPERPAGES = READYFIFO_ENTRIES;
 
-  using SuperpageQueue = folly::ProducerConsumerQueue<Superpage>;
-
   /// Enables data receiving in the RORC
   void startDataReceiving();
 
@@ -124,7 +133,7 @@ class CrorcDmaChannel final : public DmaChannelPdaBase
   /// Queue for superpages that are pushed from the Readout thread
   SuperpageQueue mTransferQueue{ TRANSFER_QUEUE_CAPACITY_ALLOCATIONS };
 
-  /// Queue for the superpage that is pushed to the firmware
+  /// Queue for the superpages that are pushed to the firmware
   SuperpageQueue mIntermediateQueue{ INTERMEDIATE_QUEUE_CAPACITY_ALLOCATIONS };
 
   /// Queue for superpages that are filled
@@ -150,24 +159,29 @@ class CrorcDmaChannel final : public DmaChannelPdaBase
   /// Enables the data generator
   bool mGeneratorEnabled;
 
-  /// Check the SuperpageInfo buffer for superpage availability
-  bool isASuperpageAvailable();
+  /// Amount of superpages to keep pushed to the firmware, as requested
+  const size_t mPipelineDepthRequested;
 
-  /// A convenience struct to access the Superpage info DMA buffer
-  struct SuperpageInfo {
-    volatile uint32_t size;  // size of the written superpage in bytes (24 bits)
-    volatile uint32_t count; // incrementing counter that signals a completed write (8 bits)
-  };
+  /// Amount of superpages to keep pushed to the firmware since DMA start
+  size_t mPipelineDepth = 1;
 
-  const size_t kSuperpageInfoSize = 2 * sizeof(uint32_t);
+  /// Moves the oldest superpage pushed to the firmware to the ready queue
+  /// \param size Bytes received, or empty if the superpage was filled completely
+  void transferFilledSuperpage(boost::optional<uint32_t> size);
 
-  SuperpageInfo* getSuperpageInfoUser()
-  {
-    return reinterpret_cast<SuperpageInfo*>(mSuperpageInfoAddressUser);
-  }
+  const size_t kSuperpageInfoSize = sizeof(CompletionRing::Layout);
+
+  /// Reads the superpage completions from the Superpage info DMA buffer
+  std::unique_ptr<CompletionRing> mCompletionRing;
+
+  // Counter for the superpages found filled since DMA start, used as their sequence number
+  uint32_t mSuperpageCounter = 0;
+
+  /// Serializes the register accesses with the other channels of the card
+  std::shared_ptr<RegisterLock> mRegisterLock;
 
-  // Counter for the available (from the fw) superpages
-  uint32_t mSPAvailCount = 0xff;
+  /// Contention on the register lock since DMA start
+  RegisterLock::Statistics mRegisterLockStatistics;
 };
 
 } // namespace roc
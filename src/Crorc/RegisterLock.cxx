@@ -0,0 +1,55 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file RegisterLock.cxx
+/// \brief Implementation of the RegisterLock class
+
+#include "Crorc/RegisterLock.h"
+#include <algorithm>
+#include <chrono>
+#include <map>
+
+namespace o2
+{
+namespace roc
+{
+
+std::shared_ptr<RegisterLock> RegisterLock::get(const std::string& card)
+{
+  static std::mutex registryMutex;
+  static std::map<std::string, std::weak_ptr<RegisterLock>> registry;
+
+  std::lock_guard<std::mutex> guard(registryMutex);
+  auto& entry = registry[card];
+  auto lock = entry.lock();
+  if (!lock) {
+    lock = std::make_shared<RegisterLock>();
+    entry = lock;
+  }
+  return lock;
+}
+
+std::unique_lock<std::mutex> RegisterLock::acquire(Statistics& statistics)
+{
+  statistics.acquisitions++;
+  std::unique_lock<std::mutex> lock(mMutex, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    auto start = std::chrono::steady_clock::now();
+    lock.lock();
+    uint64_t wait = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    statistics.contentions++;
+    statistics.totalWaitNanoseconds += wait;
+    statistics.maxWaitNanoseconds = std::max(statistics.maxWaitNanoseconds, wait);
+  }
+  return lock;
+}
+
+} // namespace roc
+} // namespace o2
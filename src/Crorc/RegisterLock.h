@@ -0,0 +1,56 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file RegisterLock.h
+/// \brief Definition of the RegisterLock class, serializing the register accesses of the channels of a card
+
+#ifndef O2_READOUTCARD_CRORC_REGISTERLOCK_H_
+#define O2_READOUTCARD_CRORC_REGISTERLOCK_H_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace o2
+{
+namespace roc
+{
+
+/// Lock shared by the DMA channels of one card in the process, so that they do not access the card registers
+/// concurrently, which causes hardware problems on the C-RORC (O2-3772). Channels of different cards do not contend.
+class RegisterLock
+{
+ public:
+  /// Contention seen by one user of the lock. Not thread-safe: each user keeps its own.
+  struct Statistics {
+    uint64_t acquisitions = 0;
+    /// Acquisitions that had to wait for another user
+    uint64_t contentions = 0;
+    uint64_t totalWaitNanoseconds = 0;
+    uint64_t maxWaitNanoseconds = 0;
+  };
+
+  /// Gets the lock of a card, created on first use and shared while any user holds it
+  /// \param card Identifier of the card, e.g. its PCI address
+  static std::shared_ptr<RegisterLock> get(const std::string& card);
+
+  /// Acquires the lock. The wait is only timed when the lock is already held.
+  /// \param statistics Statistics of the caller, updated with the acquisition
+  std::unique_lock<std::mutex> acquire(Statistics& statistics);
+
+ private:
+  std::mutex mMutex;
+};
+
+} // namespace roc
+} // namespace o2
+
+#endif // O2_READOUTCARD_CRORC_REGISTERLOCK_H_
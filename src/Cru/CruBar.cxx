@@ -154,27 +154,31 @@ uint32_t CruBar::getSuperpageCount(uint32_t link)
   return readRegister(Cru::Registers::LINK_SUPERPAGE_COUNT.get(link).index);
 }
 
+/// Get the size of the next superpage completed by a link
+/// \param link Link number
+/// \return The size in bytes, or 0 if the firmware does not report it
 uint32_t CruBar::getSuperpageSize(uint32_t link)
 {
-  writeRegister(Cru::Registers::LINK_SUPERPAGE_SIZE.get(link).index, 0xbadcafe); // write a dummy value to update the FIFO
-  uint32_t superpageSizeFifo = readRegister(Cru::Registers::LINK_SUPERPAGE_SIZE.get(link).index);
-  uint32_t superpageSize = Utilities::getBits(superpageSizeFifo, 0, 23); // [0-23] -> superpage size (in bytes)
-  if (superpageSize == 0) {                                              // No reason to check for index -> superpageSize == 0 -> CRU FW < v3.4.0
-    return 0;
+  uint32_t superpageSize = 0;
+  SuperpageSizeReader::Statistics statistics;
+  if (getSuperpageSizes(link, &superpageSize, 1, statistics) == 0) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(getLoggerPrefix() + "Superpage size FIFO index did not catch up")
+                                      << ErrorInfo::LinkId(link));
   }
-  uint32_t superpageSizeIndex = Utilities::getBits(superpageSizeFifo, 24, 31); // [24-31] -> superpage index (0-255)
-
-  while (superpageSizeIndex != mSuperpageSizeIndexCounter[link]) { // In case the PCIe bus wasn't fast enough
-    superpageSizeFifo = readRegister(Cru::Registers::LINK_SUPERPAGE_SIZE.get(link).index);
-    superpageSize = Utilities::getBits(superpageSizeFifo, 0, 23);
-    superpageSizeIndex = Utilities::getBits(superpageSizeFifo, 24, 31);
-  }
-
-  mSuperpageSizeIndexCounter[link] = (superpageSizeIndex + 1) % 256;
-
   return superpageSize;
 }
 
+/// Get the sizes of the next superpages completed by a link, with a bounded amount of re-reads if the FIFO lags
+/// \param link Link number
+/// \param sizes Array receiving the sizes, in bytes
+/// \param count Amount of completed superpages
+/// \param statistics Counters to add the register accesses to
+/// \return The amount of sizes read. Less than count if the FIFO index did not catch up within the retry budget.
+size_t CruBar::getSuperpageSizes(uint32_t link, uint32_t* sizes, size_t count, SuperpageSizeReader::Statistics& statistics)
+{
+  return mSuperpageSizeReader.read(link, sizes, count, statistics);
+}
+
 uint32_t CruBar::getSuperpageFifoEmptyCounter(uint32_t link)
 {
   if (link >= Cru::MAX_LINKS) {
@@ -210,8 +214,8 @@ void CruBar::resetCard()
 /// Resets internal counters
 void CruBar::resetInternalCounters()
 {
-  // clear internal superpage size index counter array
-  std::fill(mSuperpageSizeIndexCounter, mSuperpageSizeIndexCounter + Cru::MAX_LINKS, 0);
+  // clear internal superpage size index counters
+  mSuperpageSizeReader.reset();
 }
 
 /// Injects a single error into the generated data stream
@@ -27,6 +27,7 @@
 #include "Cru/Constants.h"
 #include "Cru/FirmwareFeatures.h"
 #include "ExceptionInternal.h"
+#include "Cru/SuperpageSizeReader.h"
 #include "Pda/PdaBar.h"
 #include "ReadoutCard/Parameters.h"
 #include "ReadoutCard/PatternPlayer.h"
@@ -71,6 +72,7 @@ class CruBar final : public BarInterfaceBase
   void pushSuperpageDescriptor(uint32_t link, uint32_t pages, uintptr_t busAddress);
   uint32_t getSuperpageCount(uint32_t link);
   uint32_t getSuperpageSize(uint32_t link);
+  size_t getSuperpageSizes(uint32_t link, uint32_t* sizes, size_t count, SuperpageSizeReader::Statistics& statistics);
   uint32_t getSuperpageFifoEmptyCounter(uint32_t link);
   void startDmaEngine();
   void stopDmaEngine();
@@ -191,8 +193,8 @@ class CruBar final : public BarInterfaceBase
   int mSerial;
   int mEndpoint;
 
-  /// Per-link counter to verify superpage sizes received are valid
-  uint32_t mSuperpageSizeIndexCounter[Cru::MAX_LINKS] = { 0 };
+  /// Reads the superpage sizes, keeping per-link counters to verify they are valid
+  SuperpageSizeReader mSuperpageSizeReader{ *this };
 };
 
 } // namespace roc
@@ -30,6 +30,12 @@ namespace o2
 namespace roc
 {
 
+namespace
+{
+/// Interval between the updates of the controlled link scheduler, in nanoseconds
+constexpr uint64_t CONTROL_INTERVAL = 100 * 1000 * 1000;
+} // namespace
+
 CruDmaChannel::CruDmaChannel(const Parameters& parameters)
   : DmaChannelPdaBase(parameters, allowedChannels()),
     mDataSource(parameters.getDataSource().get_value_or(DataSource::Internal)), // DG loopback mode by default
@@ -58,6 +64,8 @@ CruDmaChannel::CruDmaChannel(const Parameters& parameters)
   cruBar = std::move(std::dynamic_pointer_cast<CruBar>(bar));   // Initialize BAR 0
   cruBar2 = std::move(std::dynamic_pointer_cast<CruBar>(bar2)); // Initialize BAR 2
   mFeatures = getBar()->getFirmwareFeatures();                  // Get which features of the firmware are enabled
+  mSuperpageCountReader = std::make_unique<SuperpageCountReader>(*getBar(),
+                                                                 parameters.getLinkStatusBatchReadEnabled().get_value_or(false));
 
   if (mFeatures.standalone) { //TODO: ??
     std::stringstream stream;
@@ -79,6 +87,7 @@ CruDmaChannel::CruDmaChannel(const Parameters& parameters)
     }
 
     mLinkQueueCapacity = maxSuperpageDescriptors;
+    mSuperpageSizes.resize(mLinkQueueCapacity);
     mReadyQueueCapacity = maxSuperpageDescriptors * Cru::MAX_LINKS;
   }
 
@@ -92,9 +101,10 @@ CruDmaChannel::CruDmaChannel(const Parameters& parameters)
       stream << link << " ";
       //Implicit constructors are deleted for the folly Queue. Workaround to keep the Link struct with a queue * field.
       std::shared_ptr<SuperpageQueue> linkQueue = std::make_shared<SuperpageQueue>(mLinkQueueCapacity + 1); // folly queue needs + 1
-      Link newLink = { static_cast<LinkId>(link), 0, linkQueue };
+      Link newLink = { static_cast<LinkId>(link), 0, linkQueue, std::make_shared<std::atomic<size_t>>(0) };
       mLinks.push_back(newLink);
     }
+    mActiveLinkCount = mLinks.size();
 
     log(stream.str(), LogInfoDevel_(4252));
 
@@ -102,7 +112,26 @@ CruDmaChannel::CruDmaChannel(const Parameters& parameters)
       BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(getLoggerPrefix() + "No links are enabled. Check with roc-status. Configure with roc-config."));
     }
 
-    mReadyQueue = std::make_unique<SuperpageQueue>(mReadyQueueCapacity + 1); // folly queue needs + 1
+    // Room for the superpages pushed through the scheduler, plus the ones pushed to a specific link, on as many links
+    // as addLink() can add
+    const size_t pendingCapacity = 2 * mLinkQueueCapacity * Cru::MAX_LINKS;
+    mPendingSuperpages = std::make_unique<PendingSuperpages>(pendingCapacity);
+    // Arrivals stop at mReadyQueueCapacity, the rest is room for the superpages returned when DMA stops or a link is
+    // removed: all the ones in the link queues and the pending ones
+    const size_t inFlightCapacity = mLinkQueueCapacity * Cru::MAX_LINKS + pendingCapacity;
+    mReadyQueue = std::make_unique<SuperpageQueue>(mReadyQueueCapacity + inFlightCapacity + 1); // folly queue needs + 1
+    mLinkSchedulerPolicy = parameters.getLinkSchedulerPolicy().get_value_or(LinkSchedulerPolicy::FreeSlot);
+    mLinkInFlightBounds = { parameters.getLinkInFlightMin().get_value_or(RateWeightedLinkScheduler::MIN_IN_FLIGHT),
+                            parameters.getLinkInFlightMax().get_value_or(mLinkQueueCapacity) };
+    mRestartTracker = std::make_unique<RestartTracker>(*mSuperpageCountReader,
+                                                       parameters.getFastRestartEnabled().get_value_or(false));
+    createLinkScheduler();
+    if (mControlledScheduler) {
+      auto bounds = mControlledScheduler->getBounds();
+      log((format("Controlling superpages in flight per link, between %d and %d") % bounds.minInFlight % bounds.maxInFlight).str(),
+          LogInfoDevel_(4259));
+    }
+    initializeLinkCounters(getDataTakingLinks(), mLinkQueueCapacity);
   }
 }
 
@@ -114,6 +143,7 @@ auto CruDmaChannel::allowedChannels() -> AllowedChannels
 
 CruDmaChannel::~CruDmaChannel()
 {
+  stopDriverThread();
   setBufferNonReady();
   if (mReadyQueue->sizeGuess() > 0) {
     log((format("Remaining superpages in the ready queue: %1%") % mReadyQueue->sizeGuess()).str(), LogDebugDevel_(4253));
@@ -146,20 +176,43 @@ void CruDmaChannel::deviceStartDma()
     getBar2()->disableDataTaking(); // Make sure we don't start from a bad state - shall be done before reset
   }
 
-  // Reset CRU (should be done after link mask set)
-  resetCru();
+  // Reset CRU (should be done after link mask set), unless the card holds no superpage descriptors and a fast restart
+  // was asked for
+  if (mRestartTracker->start()) {
+    resetCru();
+  } else {
+    log("Restarting DMA without resetting the card", LogInfoDevel_(4263));
+  }
+
+  // The links drained since the previous start are dropped, and the reset clears the descriptors of stale links
+  if (mLinks.size() > mActiveLinkCount) {
+    mLinks.resize(mActiveLinkCount);
+    updateLinkCounters(getDataTakingLinks(), mLinkQueueCapacity);
+  }
+  mStaleLinks.clear();
 
-  // Initialize link queues
+  // Initialize link queues. Without a reset, the card carries on counting superpages from where it stopped.
+  SuperpageCountReader::LinkMask linksToRead;
+  for (const auto& link : mLinks) {
+    linksToRead.set(link.id);
+  }
+  countRegisterReads(mRestartTracker->readStartCounts(linksToRead));
   for (auto& link : mLinks) {
     while (!link.queue->isEmpty()) {
       link.queue->popFront();
+      getLinkCounters(&link - mLinks.data()).reclaimed();
     }
-    link.superpageCounter = 0;
+    link.superpageCounter = mRestartTracker->getStartCount(link.id);
+    *link.inFlight = 0;
   }
   while (!mReadyQueue->isEmpty()) {
     mReadyQueue->popFront();
   }
-  mLinkQueuesTotalAvailable = mLinkQueueCapacity * mLinks.size();
+  mPendingSuperpages->takeAll([](const Superpage&) {});
+  mLinkScheduler->reset();
+  mLinkQueuesTotalAvailable = mLinkScheduler->getAvailable();
+  resetLinkSchedulerControl();
+  mSuperpagesInFlight = 0;
 
   // Start DMA
   setBufferReady();
@@ -190,7 +243,8 @@ void CruDmaChannel::deviceStopDma()
   getBar2()->disableDataTaking();
 
   // Transfer remaining (filled) superpages to ReadyQueue
-  fillSuperpages();
+  // Note: the driver thread, if any, has been stopped at this point
+  notifyReady(transferArrivedSuperpages());
 
   // Return any superpages that have been pushed up in the meantime but won't get filled
   reclaimSuperpages();
@@ -198,15 +252,30 @@ void CruDmaChannel::deviceStopDma()
 
 void CruDmaChannel::reclaimSuperpages()
 {
+  uint64_t reclaimed = 0;
+
+  // Superpages the driver thread did not get to push to a link
+  mPendingSuperpages->takeAll([&](const Superpage& superpage) {
+    if (superpage.getLink() < 0) {
+      mLinkQueuesTotalAvailable++;
+    }
+    returnPendingSuperpage(superpage);
+    reclaimed++;
+  });
+
   for (auto& link : mLinks) {
     while (!link.queue->isEmpty()) {
-      transferSuperpageFromLinkToReady(link, true); // Reclaim pages, do *not* set as ready
+      transferSuperpageFromLinkToReady(link, 0, true); // Reclaim pages, do *not* set as ready
+      reclaimed++;
+      mRestartTracker->descriptorsLeft();
     }
 
     if (!link.queue->isEmpty()) {
       log((format("Superpage queue of link %1% not empty after DMA stop. Superpages unclaimed.") % link.id).str(), LogErrorDevel_(4255));
     }
   }
+
+  notifyReady(reclaimed);
 }
 
 void CruDmaChannel::deviceResetChannel(ResetLevel::type resetLevel)
@@ -217,6 +286,7 @@ void CruDmaChannel::deviceResetChannel(ResetLevel::type resetLevel)
     BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(getLoggerPrefix() + "The CRU can only be reset internally"));
   }
   resetCru();
+  mRestartTracker->cardReset();
 }
 
 CardType::type CruDmaChannel::getCardType()
@@ -233,23 +303,27 @@ void CruDmaChannel::resetCru()
   getBar()->resetInternalCounters();
 }
 
-auto CruDmaChannel::getNextLinkIndex() -> LinkIndex
+bool CruDmaChannel::pushSuperpage(Superpage superpage)
 {
-  auto smallestQueueIndex = std::numeric_limits<LinkIndex>::max();
-  auto smallestQueueSize = std::numeric_limits<size_t>::max();
+  if (mDmaState != DmaState::STARTED) {
+    return false;
+  }
 
-  for (size_t i = 0; i < mLinks.size(); ++i) {
-    auto queueSize = mLinks[i].queue->sizeGuess();
-    if (queueSize < smallestQueueSize) {
-      smallestQueueIndex = i;
-      smallestQueueSize = queueSize;
-    }
+  checkSuperpage(superpage);
+
+  if (mLinkQueuesTotalAvailable <= 0) {
+    // Note: the transfer queue refers to the firmware, not the mLinkIndexQueue which contains the LinkIds for links
+    // that can still be pushed into (essentially the opposite of the firmware's queue).
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(getLoggerPrefix() + "Could not push superpage, transfer queue was full"));
   }
 
-  return smallestQueueIndex;
+  enqueueSuperpage(superpage);
+  mFirstSPPushed = true;
+
+  return true;
 }
 
-bool CruDmaChannel::pushSuperpage(Superpage superpage)
+bool CruDmaChannel::pushSuperpage(Superpage superpage, uint32_t linkId)
 {
   if (mDmaState != DmaState::STARTED) {
     return false;
@@ -257,15 +331,63 @@ bool CruDmaChannel::pushSuperpage(Superpage superpage)
 
   checkSuperpage(superpage);
 
-  if (mLinkQueuesTotalAvailable == 0) {
-    // Note: the transfer queue refers to the firmware, not the mLinkIndexQueue which contains the LinkIds for links
-    // that can still be pushed into (essentially the opposite of the firmware's queue).
-    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(getLoggerPrefix() + "Could not push superpage, transfer queue was full"));
+  auto& link = getLink(linkId);
+  if (*link.inFlight >= mLinkQueueCapacity) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(getLoggerPrefix() + "Could not push superpage, link queue was full")
+                                      << ErrorInfo::LinkId(linkId));
+  }
+
+  enqueueSuperpageToLink(link, superpage);
+  mFirstSPPushed = true;
+
+  return true;
+}
+
+size_t CruDmaChannel::pushSuperpages(const Superpage* superpages, size_t count)
+{
+  if (mDmaState != DmaState::STARTED) {
+    return 0;
+  }
+
+  size_t pushed = 0;
+  while (pushed < count && mLinkQueuesTotalAvailable > 0) {
+    checkSuperpage(superpages[pushed]);
+    enqueueSuperpage(superpages[pushed]);
+    pushed++;
   }
 
+  if (pushed > 0) {
+    mFirstSPPushed = true;
+  }
+
+  return pushed;
+}
+
+void CruDmaChannel::pushSuperpageToNextLink(const Superpage& superpage)
+{
   // Get the next link to push
-  auto& link = mLinks[getNextLinkIndex()];
+  auto linkIndex = mLinkScheduler->takeSlot();
+  if (linkIndex < 0) {
+    // The push is only done when the scheduler has slots available
+    // This should never happen
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(getLoggerPrefix() + "Could not push superpage, no link slot available"));
+  }
+  auto& link = mLinks[linkIndex];
+  (*link.inFlight)++;
+  pushSuperpageToFirmware(link, superpage);
+}
+
+void CruDmaChannel::pushSuperpageToUserLink(Link& link, const Superpage& superpage)
+{
+  // Let the scheduler know the slot is taken, and pass on any change in the slots it grants
+  int64_t availableBefore = mLinkScheduler->getAvailable();
+  mLinkScheduler->takeSlotOnLink(&link - mLinks.data());
+  mLinkQueuesTotalAvailable += int64_t(mLinkScheduler->getAvailable()) - availableBefore;
+  pushSuperpageToFirmware(link, superpage);
+}
 
+void CruDmaChannel::pushSuperpageToFirmware(Link& link, const Superpage& superpage)
+{
   if (link.queue->sizeGuess() >= mLinkQueueCapacity) {
     // Is the link's FIFO out of space?
     // This should never happen
@@ -277,10 +399,80 @@ bool CruDmaChannel::pushSuperpage(Superpage superpage)
   auto dmaPages = superpage.getSize() / mDmaPageSize;
   auto busAddress = getBusOffsetAddress(superpage.getOffset());
   getBar()->pushSuperpageDescriptor(link.id, dmaPages, busAddress);
+  getLinkCounters(&link - mLinks.data()).pushed(getSteadyTime());
+}
 
-  mFirstSPPushed = true;
+auto CruDmaChannel::getLink(LinkId linkId) -> Link&
+{
+  auto link = findLink(linkId);
+  if (!link || !isLinkActive(*link)) {
+    BOOST_THROW_EXCEPTION(InvalidLinkId() << ErrorInfo::Message(getLoggerPrefix() + "Link is not taking data")
+                                          << ErrorInfo::LinkId(linkId));
+  }
+  return *link;
+}
 
-  return true;
+auto CruDmaChannel::findLink(LinkId linkId) -> Link*
+{
+  for (auto& link : mLinks) {
+    if (link.id == linkId) {
+      return &link;
+    }
+  }
+  return nullptr;
+}
+
+void CruDmaChannel::enqueueSuperpage(const Superpage& superpage)
+{
+  countUserPush(superpage);
+  mLinkQueuesTotalAvailable--;
+  mSuperpagesInFlight++;
+  if (isDriverThreadEnabled()) {
+    // The pending queue has room for all the superpages the scheduler can grant, so this can't fail
+    // The link is set by the driver thread
+    Superpage pending = superpage;
+    pending.setLink(-1);
+    mPendingSuperpages->write(pending);
+  } else {
+    pushSuperpageToNextLink(superpage);
+  }
+}
+
+void CruDmaChannel::enqueueSuperpageToLink(Link& link, Superpage superpage)
+{
+  countUserPush(superpage);
+  (*link.inFlight)++;
+  mSuperpagesInFlight++;
+  if (isDriverThreadEnabled()) {
+    // The pending queue has room for a full queue per link on top of what the scheduler grants, so this can't fail
+    superpage.setLink(link.id);
+    mPendingSuperpages->write(superpage);
+  } else {
+    pushSuperpageToUserLink(link, superpage);
+  }
+}
+
+void CruDmaChannel::pushPendingSuperpages()
+{
+  // A superpage that can't be pushed yet is set aside, without holding back the ones for the other links
+  mPendingSuperpages->push([&](const Superpage& superpage) {
+    if (superpage.getLink() >= 0) {
+      // Pushed by the user to a link. A superpage pushed through the scheduler may have taken the link's last slot
+      // in the meantime, in which case it waits until one is freed.
+      auto& link = getLink(superpage.getLink());
+      if (link.queue->sizeGuess() >= mLinkQueueCapacity) {
+        return false;
+      }
+      pushSuperpageToUserLink(link, superpage);
+    } else {
+      // The scheduler may grant fewer slots than were available when the superpage was pushed
+      if (mLinkScheduler->getAvailable() == 0) {
+        return false;
+      }
+      pushSuperpageToNextLink(superpage);
+    }
+    return true;
+  });
 }
 
 auto CruDmaChannel::getSuperpage() -> Superpage
@@ -298,52 +490,162 @@ auto CruDmaChannel::popSuperpage() -> Superpage
   }
   auto superpage = *mReadyQueue->frontPtr();
   mReadyQueue->popFront();
+  countUserPops(&superpage, 1);
 
   return superpage;
 }
 
+size_t CruDmaChannel::popSuperpages(Superpage* superpages, size_t maxCount)
+{
+  size_t popped = popFront(*mReadyQueue, superpages, maxCount);
+  countUserPops(superpages, popped);
+  return popped;
+}
+
+PushStatus::type CruDmaChannel::tryPushSuperpage(const Superpage& superpage)
+{
+  if (mDmaState != DmaState::STARTED) {
+    return PushStatus::DmaNotStarted;
+  }
+
+  if (!isSuperpageValid(superpage)) {
+    return PushStatus::InvalidSuperpage;
+  }
+
+  if (mLinkQueuesTotalAvailable <= 0) {
+    return PushStatus::QueueFull;
+  }
+
+  enqueueSuperpage(superpage);
+  mFirstSPPushed = true;
+
+  return PushStatus::Ok;
+}
+
+boost::optional<Superpage> CruDmaChannel::tryPeekSuperpage()
+{
+  return tryPeekFront(*mReadyQueue);
+}
+
+boost::optional<Superpage> CruDmaChannel::tryPopSuperpage()
+{
+  auto superpage = tryPopFront(*mReadyQueue);
+  if (superpage) {
+    countUserPops(&*superpage, 1);
+  }
+  return superpage;
+}
+
 void CruDmaChannel::pushSuperpageToLink(Link& link, const Superpage& superpage)
 {
-  mLinkQueuesTotalAvailable--;
   link.queue->write(superpage);
 }
 
-void CruDmaChannel::transferSuperpageFromLinkToReady(Link& link, bool reclaim)
+void CruDmaChannel::transferSuperpageFromLinkToReady(Link& link, uint32_t superpageSize, bool reclaim)
 {
   if (link.queue->isEmpty()) {
     BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(getLoggerPrefix() + "Could not transfer Superpage from link to ready queue, link queue is empty"));
   }
 
+  auto& counters = getLinkCounters(&link - mLinks.data());
   if (!reclaim) {
+    stampArrivalTime(*link.queue->frontPtr());
     link.queue->frontPtr()->setReady(true);
-    uint32_t superpageSize = getBar()->getSuperpageSize(link.id);
     if (superpageSize == 0) {
       link.queue->frontPtr()->setReceived(link.queue->frontPtr()->getSize()); // force the full superpage size for backwards compatibility
     } else {
       link.queue->frontPtr()->setReceived(superpageSize);
     }
+    counters.filled(link.queue->frontPtr()->getReceived(), getSteadyTime());
   } else {
     link.queue->frontPtr()->setReady(false);
     link.queue->frontPtr()->setReceived(0);
+    counters.reclaimed();
   }
 
   link.queue->frontPtr()->setLink(link.id);
-  mReadyQueue->write(*link.queue->frontPtr());
+  link.queue->frontPtr()->setSequence(link.superpageCounter);
+  writeReady(*link.queue->frontPtr());
   link.queue->popFront();
   link.superpageCounter++;
-  mLinkQueuesTotalAvailable++;
+  (*link.inFlight)--;
+  mSuperpagesInFlight--;
+  releaseLinkSlot(link, !reclaim);
+}
+
+void CruDmaChannel::releaseLinkSlot(const Link& link, bool completed)
+{
+  // A link being drained has no slots in the scheduler
+  if (!isLinkActive(link)) {
+    return;
+  }
+
+  // The scheduler may grant more or fewer slots after this, pass the difference on to the user
+  int64_t availableBefore = mLinkScheduler->getAvailable();
+  mLinkScheduler->releaseSlot(&link - mLinks.data(), completed);
+  mLinkQueuesTotalAvailable += int64_t(mLinkScheduler->getAvailable()) - availableBefore;
+}
+
+size_t CruDmaChannel::deviceFillSuperpages()
+{
+  // Hand the superpages pushed by the user to the firmware, if the driver thread is doing that
+  pushPendingSuperpages();
+
+  auto transferred = transferArrivedSuperpages();
+  notifyReady(transferred);
+
+  if (mControlledScheduler && getSteadyTime() >= mNextControlTime) {
+    controlLinkScheduler();
+  }
+  return transferred;
 }
 
-void CruDmaChannel::fillSuperpages()
+void CruDmaChannel::controlLinkScheduler()
 {
+  mNextControlTime = getSteadyTime() + CONTROL_INTERVAL;
+
+  // The counters wrap around, so the differences are taken on 32 bits
+  std::vector<uint64_t> fifoEmptyEvents(mActiveLinkCount);
+  for (size_t i = 0; i < mActiveLinkCount; ++i) {
+    uint32_t counter = getBar()->getSuperpageFifoEmptyCounter(mLinks[i].id);
+    fifoEmptyEvents[i] = uint32_t(counter - mControlFifoEmptyCounters[i]);
+    mControlFifoEmptyCounters[i] = counter;
+  }
+  uint32_t droppedPackets = uint32_t(getDroppedPackets());
+  uint32_t newDroppedPackets = droppedPackets - mControlDroppedPackets;
+  mControlDroppedPackets = droppedPackets;
+
+  int64_t availableBefore = mLinkScheduler->getAvailable();
+  auto decisions = mControlledScheduler->control(fifoEmptyEvents, newDroppedPackets);
+  mLinkQueuesTotalAvailable += int64_t(mLinkScheduler->getAvailable()) - availableBefore;
+
+  static ILAutoMuteToken logToken(LogInfoDevel_(4260), 10, 60);
+  for (const auto& decision : decisions) {
+    Logger::get().log(logToken, "%s", (mLoggerPrefix + (format("Superpages in flight on link %d: %d -> %d (%s)") % mLinks[decision.link].id % decision.previousTarget % decision.target % InFlightController::toString(decision.reason)).str()).c_str());
+  }
+}
 
-  /*if (mDmaState != DmaState::STARTED) { //Would block fillSuperpages from deviceStopDma()
-    //return;
-  }*/
+size_t CruDmaChannel::transferArrivedSuperpages()
+{
+  // Read the superpage counters. Links with no superpages in flight are skipped in batched mode, and always once they
+  // are being drained.
+  SuperpageCountReader::LinkMask linksToRead;
+  for (const auto& link : mLinks) {
+    if ((!mSuperpageCountReader->isBatched() && isLinkActive(link)) || !link.queue->isEmpty()) {
+      linksToRead.set(link.id);
+    }
+  }
+  uint64_t registerReads = mSuperpageCountReader->read(linksToRead);
 
   // Check for arrivals & handle them
+  size_t transferred = 0;
+  SuperpageSizeReader::Statistics sizeStatistics;
   for (auto& link : mLinks) {
-    int32_t superpageCount = getBar()->getSuperpageCount(link.id);
+    if (!linksToRead.test(link.id)) {
+      continue;
+    }
+
+    int32_t superpageCount = mSuperpageCountReader->getSuperpageCount(link.id);
     uint32_t amountAvailable = superpageCount - link.superpageCounter;
     if (amountAvailable > link.queue->sizeGuess()) {
 
@@ -356,27 +658,276 @@ void CruDmaChannel::fillSuperpages()
                             << ErrorInfo::Message(getLoggerPrefix() + "FATAL: Firmware reported more superpages available than should be present in FIFO"));
     }
 
-    while (amountAvailable) {
-      if (mReadyQueue->sizeGuess() >= mReadyQueueCapacity) {
-        break;
-      }
+    // Don't take more than the ready queue can hold
+    size_t readyAvailable = mReadyQueueCapacity - std::min<size_t>(mReadyQueue->sizeGuess(), mReadyQueueCapacity);
+    size_t amountToTransfer = std::min<size_t>(amountAvailable, readyAvailable);
+    if (amountToTransfer == 0) {
+      continue;
+    }
+
+    // Get the sizes of all the arrived superpages of the link in one go
+    size_t sized = getBar()->getSuperpageSizes(link.id, mSuperpageSizes.data(), amountToTransfer, sizeStatistics);
+    if (sized < amountToTransfer) {
+      // The rest is picked up by the next call
+      static ILAutoMuteToken logToken(LogWarningDevel_(4258), 10, 60);
+      Logger::get().log(logToken, "%s", (mLoggerPrefix + (format("Superpage size FIFO index of link %d lagging, retry budget exhausted") % link.id).str()).c_str());
+    }
 
-      transferSuperpageFromLinkToReady(link);
-      amountAvailable--;
+    for (size_t i = 0; i < sized; ++i) {
+      transferSuperpageFromLinkToReady(link, mSuperpageSizes[i]);
+      transferred++;
     }
   }
+
+  countRegisterReads(registerReads + sizeStatistics.reads, sizeStatistics.indexLags);
+  return transferred;
 }
 
 int CruDmaChannel::getTransferQueueAvailable()
 {
-  return mLinkQueuesTotalAvailable;
+  return std::max<int64_t>(mLinkQueuesTotalAvailable, 0);
+}
+
+int CruDmaChannel::getTransferQueueAvailable(uint32_t linkId)
+{
+  auto inFlight = getLink(linkId).inFlight->load();
+  return inFlight < mLinkQueueCapacity ? mLinkQueueCapacity - inFlight : 0;
+}
+
+std::vector<uint32_t> CruDmaChannel::getDataTakingLinks()
+{
+  std::vector<uint32_t> links;
+  for (size_t i = 0; i < mActiveLinkCount; ++i) {
+    links.push_back(mLinks[i].id);
+  }
+  return links;
+}
+
+void CruDmaChannel::addLink(uint32_t linkId)
+{
+  changeLinks({ linkId }, {});
+}
+
+void CruDmaChannel::removeLink(uint32_t linkId)
+{
+  changeLinks({}, { linkId });
+}
+
+void CruDmaChannel::refreshLinks()
+{
+  std::set<LinkId> enabled;
+  for (auto id : getBar2()->getDataTakingLinks()) {
+    enabled.insert(id);
+  }
+
+  std::set<LinkId> added;
+  for (auto id : enabled) {
+    auto link = findLink(id);
+    if (link && isLinkActive(*link)) {
+      continue;
+    }
+    if (mStaleLinks.count(id)) {
+      log((format("Link %1% is enabled, but can only be added back after DMA is restarted") % id).str(), LogWarningDevel_(4262));
+      continue;
+    }
+    added.insert(id);
+  }
+
+  std::set<LinkId> removed;
+  for (size_t i = 0; i < mActiveLinkCount; ++i) {
+    if (!enabled.count(mLinks[i].id)) {
+      removed.insert(mLinks[i].id);
+    }
+  }
+
+  if (!added.empty() || !removed.empty()) {
+    changeLinks(added, removed);
+  }
+}
+
+void CruDmaChannel::changeLinks(const std::set<LinkId>& added, const std::set<LinkId>& removed)
+{
+  std::set<LinkId> enabled;
+  for (auto id : getBar2()->getDataTakingLinks()) {
+    enabled.insert(id);
+  }
+
+  // Check all the links before changing anything
+  for (auto id : added) {
+    auto link = findLink(id);
+    if (link && isLinkActive(*link)) {
+      BOOST_THROW_EXCEPTION(InvalidLinkId() << ErrorInfo::Message(getLoggerPrefix() + "Link is already taking data")
+                                            << ErrorInfo::LinkId(id));
+    }
+    if (!enabled.count(id)) {
+      BOOST_THROW_EXCEPTION(InvalidLinkId() << ErrorInfo::Message(getLoggerPrefix() + "Link is not enabled. Configure with roc-config.")
+                                            << ErrorInfo::LinkId(id));
+    }
+    if (mStaleLinks.count(id)) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(getLoggerPrefix() + "Link can only be added back after DMA is restarted, "
+                                                                                  "the card still holds superpages returned from it")
+                                        << ErrorInfo::LinkId(id));
+    }
+  }
+  for (auto id : removed) {
+    getLink(id);
+  }
+  if (mActiveLinkCount + added.size() <= removed.size()) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(getLoggerPrefix() + "Can not remove the last link taking data, stop DMA instead"));
+  }
+
+  size_t returned = 0;
+  runWithDriverThreadStopped([&] {
+    const bool started = mDmaState == DmaState::STARTED;
+    if (started) {
+      // Deliver what the card filled so far
+      notifyReady(transferArrivedSuperpages());
+    }
+
+    // The superpages waiting to be pushed to a removed link go back to the user, the others keep their order
+    std::vector<Superpage> pending;
+    size_t pendingScheduled = 0;
+    mPendingSuperpages->takeAll([&](const Superpage& superpage) {
+      if (superpage.getLink() >= 0 && removed.count(superpage.getLink())) {
+        returnPendingSuperpage(superpage);
+        returned++;
+      } else {
+        pendingScheduled += (superpage.getLink() < 0) ? 1 : 0;
+        pending.push_back(superpage);
+      }
+    });
+    for (const auto& superpage : pending) {
+      mPendingSuperpages->write(superpage);
+    }
+
+    std::vector<Link> active;
+    std::vector<Link> draining;
+    for (auto& link : mLinks) {
+      if (!removed.count(link.id)) {
+        (isLinkActive(link) || added.count(link.id) ? active : draining).push_back(link);
+      } else if (link.queue->isEmpty()) {
+        // Nothing to drain
+      } else if (enabled.count(link.id)) {
+        // The card still fills the superpages it holds
+        draining.push_back(link);
+      } else {
+        // The link was disabled, its superpages won't be filled
+        while (!link.queue->isEmpty()) {
+          transferSuperpageFromLinkToReady(link, 0, true);
+          returned++;
+        }
+        mStaleLinks.insert(link.id);
+        mRestartTracker->descriptorsLeft();
+      }
+    }
+
+    // The card counts the superpages of a link from the last DMA start
+    SuperpageCountReader::LinkMask newLinks;
+    for (auto id : added) {
+      if (!findLink(id)) {
+        newLinks.set(id);
+      }
+    }
+    if (started && newLinks.any()) {
+      countRegisterReads(mSuperpageCountReader->read(newLinks));
+    }
+    for (auto id : added) {
+      if (newLinks.test(id)) {
+        uint32_t superpageCounter = started ? mSuperpageCountReader->getSuperpageCount(id) : 0;
+        auto linkQueue = std::make_shared<SuperpageQueue>(mLinkQueueCapacity + 1); // folly queue needs + 1
+        active.push_back({ id, superpageCounter, linkQueue, std::make_shared<std::atomic<size_t>>(0) });
+      }
+    }
+
+    mActiveLinkCount = active.size();
+    mLinks = std::move(active);
+    mLinks.insert(mLinks.end(), draining.begin(), draining.end());
+
+    std::vector<uint32_t> linkIds;
+    for (const auto& link : mLinks) {
+      linkIds.push_back(link.id);
+    }
+    updateLinkCounters(linkIds, mLinkQueueCapacity);
+
+    // Plan the link queues again
+    createLinkScheduler();
+    mLinkQueuesTotalAvailable = int64_t(mLinkScheduler->getAvailable()) - int64_t(pendingScheduled);
+    if (started) {
+      resetLinkSchedulerControl();
+    }
+    notifyReady(returned);
+  });
+
+  std::stringstream stream;
+  stream << "Using link(s): ";
+  for (size_t i = 0; i < mActiveLinkCount; ++i) {
+    stream << mLinks[i].id << " ";
+  }
+  if (mLinks.size() > mActiveLinkCount) {
+    stream << "- draining link(s): ";
+    for (size_t i = mActiveLinkCount; i < mLinks.size(); ++i) {
+      stream << mLinks[i].id << " ";
+    }
+  }
+  stream << "- returned " << returned << " superpage(s)";
+  log(stream.str(), LogInfoDevel_(4261));
+}
+
+void CruDmaChannel::createLinkScheduler()
+{
+  if (mLinkSchedulerPolicy == LinkSchedulerPolicy::Controlled) {
+    auto scheduler = std::make_unique<ControlledLinkScheduler>(mActiveLinkCount, mLinkQueueCapacity, mLinkInFlightBounds);
+    mControlledScheduler = scheduler.get();
+    mLinkScheduler = std::move(scheduler);
+  } else {
+    mLinkScheduler = LinkScheduler::create(mLinkSchedulerPolicy, mActiveLinkCount, mLinkQueueCapacity);
+  }
+
+  // The superpages already in the link queues keep their slots
+  for (size_t i = 0; i < mActiveLinkCount; ++i) {
+    for (size_t j = 0; j < mLinks[i].queue->sizeGuess(); ++j) {
+      mLinkScheduler->takeSlotOnLink(i);
+    }
+  }
+}
+
+void CruDmaChannel::resetLinkSchedulerControl()
+{
+  if (!mControlledScheduler) {
+    return;
+  }
+  mControlFifoEmptyCounters.clear();
+  for (size_t i = 0; i < mActiveLinkCount; ++i) {
+    mControlFifoEmptyCounters.push_back(getBar()->getSuperpageFifoEmptyCounter(mLinks[i].id));
+  }
+  mControlDroppedPackets = uint32_t(getDroppedPackets());
+  mNextControlTime = getSteadyTime() + CONTROL_INTERVAL;
+}
+
+void CruDmaChannel::returnPendingSuperpage(Superpage superpage)
+{
+  if (superpage.getLink() >= 0) {
+    (*findLink(superpage.getLink())->inFlight)--;
+  }
+  superpage.setReady(false);
+  superpage.setReceived(0);
+  writeReady(superpage);
+  mSuperpagesInFlight--;
+}
+
+void CruDmaChannel::writeReady(const Superpage& superpage)
+{
+  if (!mReadyQueue->write(superpage)) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(getLoggerPrefix() + "Ready queue full, could not return superpage")
+                                      << ErrorInfo::Offset(superpage.getOffset()));
+  }
 }
 
 // Return a boolean that denotes whether the transfer queue is empty
-// The transfer queue is empty when all its slots are available
+// The transfer queue is empty when no superpage is in flight
 bool CruDmaChannel::isTransferQueueEmpty()
 {
-  return mLinkQueuesTotalAvailable == (mLinkQueueCapacity * mLinks.size());
+  return mSuperpagesInFlight == 0;
 }
 
 int CruDmaChannel::getReadyQueueSize()
@@ -388,7 +939,7 @@ int CruDmaChannel::getReadyQueueSize()
 // The ready queue is full when the CRU has filled it up
 bool CruDmaChannel::isReadyQueueFull()
 {
-  return mReadyQueue->isFull();
+  return size_t(mReadyQueue->sizeGuess()) >= mReadyQueueCapacity;
 }
 
 int32_t CruDmaChannel::getDroppedPackets()
@@ -407,7 +958,9 @@ bool CruDmaChannel::areSuperpageFifosHealthy()
 
   static ILAutoMuteToken logToken(LogWarningDevel_(4257), 15, 60);
 
-  for (const auto& link : mLinks) {
+  // The FIFOs of the links being drained run empty by design
+  for (size_t i = 0; i < mActiveLinkCount; ++i) {
+    const auto& link = mLinks[i];
     uint32_t emptyCounter = getBar()->getSuperpageFifoEmptyCounter(link.id);
     if (mEmptySPFifoCounters.count(link.id) && //only check after the counters map has been initialized
         mEmptySPFifoCounters[link.id] != emptyCounter) {
@@ -19,14 +19,19 @@
 #define O2_READOUTCARD_CRU_CRUDMACHANNEL_H_
 
 #include "DmaChannelPdaBase.h"
+#include <atomic>
 #include <memory>
 #include <deque>
+#include <set>
 //#define BOOST_CB_ENABLE_DEBUG 1
 #include <boost/circular_buffer.hpp>
 #include "Cru/CruBar.h"
 #include "Cru/FirmwareFeatures.h"
+#include "Cru/LinkScheduler.h"
+#include "Cru/PendingSuperpages.h"
+#include "Cru/RestartTracker.h"
+#include "Cru/SuperpageCountReader.h"
 #include "ReadoutCard/Parameters.h"
-#include "folly/ProducerConsumerQueue.h"
 
 namespace o2
 {
@@ -43,13 +48,23 @@ class CruDmaChannel final : public DmaChannelPdaBase
   virtual CardType::type getCardType() override;
 
   virtual bool pushSuperpage(Superpage) override;
+  virtual bool pushSuperpage(Superpage superpage, uint32_t linkId) override;
 
   virtual int getTransferQueueAvailable() override;
+  virtual int getTransferQueueAvailable(uint32_t linkId) override;
+  virtual std::vector<uint32_t> getDataTakingLinks() override;
+  virtual void addLink(uint32_t linkId) override;
+  virtual void removeLink(uint32_t linkId) override;
+  virtual void refreshLinks() override;
   virtual int getReadyQueueSize() override;
 
   virtual Superpage getSuperpage() override;
   virtual Superpage popSuperpage() override;
-  virtual void fillSuperpages() override;
+  virtual size_t pushSuperpages(const Superpage* superpages, size_t count) override;
+  virtual size_t popSuperpages(Superpage* superpages, size_t maxCount) override;
+  virtual PushStatus::type tryPushSuperpage(const Superpage& superpage) override;
+  virtual boost::optional<Superpage> tryPeekSuperpage() override;
+  virtual boost::optional<Superpage> tryPopSuperpage() override;
   virtual bool isTransferQueueEmpty() override;
   virtual bool isReadyQueueFull() override;
   virtual int32_t getDroppedPackets() override;
@@ -68,19 +83,18 @@ class CruDmaChannel final : public DmaChannelPdaBase
   virtual void deviceStartDma() override;
   virtual void deviceStopDma() override;
   virtual void deviceResetChannel(ResetLevel::type resetLevel) override;
+  virtual size_t deviceFillSuperpages() override;
 
  private:
   /// Max amount of superpages per link.
   /// This may not exceed the limit determined by the firmware capabilities.
   size_t mLinkQueueCapacity;
 
-  /// Max amount of superpages in the ready queue.
-  /// This is an arbitrary size, can easily be increased if more headroom is needed.
+  /// Max amount of superpages the card's arrivals fill the ready queue with.
+  /// This is an arbitrary size, can easily be increased if more headroom is needed. The queue itself also has room for
+  /// every superpage in flight, so that the ones returned unfilled always fit.
   size_t mReadyQueueCapacity;
 
-  /// Queue for one link
-  using SuperpageQueue = folly::ProducerConsumerQueue<Superpage>;
-
   /// Index into mLinks
   using LinkIndex = uint32_t;
 
@@ -97,6 +111,10 @@ class CruDmaChannel final : public DmaChannelPdaBase
 
     /// The superpage queue
     std::shared_ptr<SuperpageQueue> queue;
+
+    /// The amount of superpages pushed to this link and not yet moved to the ready queue, including the ones waiting
+    /// in the pending queue. Atomic since, with the driver thread enabled, it is changed by the user and the driver.
+    std::shared_ptr<std::atomic<size_t>> inFlight;
   };
 
   void resetCru();
@@ -113,14 +131,68 @@ class CruDmaChannel final : public DmaChannelPdaBase
     return cruBar2.get();
   }
 
-  /// Gets index of next link to push
-  LinkIndex getNextLinkIndex();
-
   /// Push a superpage to a link
   void pushSuperpageToLink(Link& link, const Superpage& superpage);
 
+  /// Gets the link with the given ID
+  /// \throw InvalidLinkId if the channel does not take data from it
+  Link& getLink(LinkId linkId);
+
+  /// Finds the link with the given ID, including the links being drained
+  /// \return The link, or nullptr if the channel has no such link
+  Link* findLink(LinkId linkId);
+
+  /// Whether the channel takes data from a link, as opposed to draining it
+  bool isLinkActive(const Link& link) const
+  {
+    return size_t(&link - mLinks.data()) < mActiveLinkCount;
+  }
+
+  /// Adds and removes links, with the driver thread stopped
+  void changeLinks(const std::set<LinkId>& added, const std::set<LinkId>& removed);
+
+  /// Creates the link scheduler for the links taking data, with the superpages already in their queues
+  void createLinkScheduler();
+
+  /// Reads the counters the controlled link scheduler starts from
+  void resetLinkSchedulerControl();
+
+  /// Move a superpage that was not pushed to a link to the ready queue, not filled
+  void returnPendingSuperpage(Superpage superpage);
+
+  /// Push a superpage to the next link and hand its descriptor to the firmware
+  void pushSuperpageToNextLink(const Superpage& superpage);
+
+  /// Push a superpage to a link chosen by the user and hand its descriptor to the firmware
+  void pushSuperpageToUserLink(Link& link, const Superpage& superpage);
+
+  /// Push a superpage to a link and hand its descriptor to the firmware
+  void pushSuperpageToFirmware(Link& link, const Superpage& superpage);
+
+  /// Take a slot in the link queues for a superpage, and push it to a link directly or, if the driver thread is
+  /// enabled, hand it to the driver thread through the pending queue
+  void enqueueSuperpage(const Superpage& superpage);
+
+  /// Push a superpage to the given link directly or, if the driver thread is enabled, hand it to the driver thread
+  /// through the pending queue
+  void enqueueSuperpageToLink(Link& link, Superpage superpage);
+
+  /// Push the superpages waiting in the pending queue to the links
+  void pushPendingSuperpages();
+
+  /// Move the superpages the firmware reports as filled from the links to the ready queue
+  /// \return The number of superpages moved
+  size_t transferArrivedSuperpages();
+
+  /// Give the slot of a superpage that left a link queue back to the link scheduler
+  void releaseLinkSlot(const Link& link, bool completed);
+
+  /// Feed the superpage FIFO empty and dropped packets counters to the controlled link scheduler
+  void controlLinkScheduler();
+
   /// Mark the front superpage of a link ready and transfer it to the ready queue
-  void transferSuperpageFromLinkToReady(Link& link, bool reclaim = false);
+  /// \param superpageSize Size reported by the firmware, 0 if not reported. Ignored when reclaiming.
+  void transferSuperpageFromLinkToReady(Link& link, uint32_t superpageSize, bool reclaim = false);
 
   /// Enable debug mode by writing to the appropriate CRU register
   void enableDebugMode();
@@ -128,6 +200,9 @@ class CruDmaChannel final : public DmaChannelPdaBase
   /// Reset debug mode to the state it was in prior to the start of execution
   void resetDebugMode();
 
+  /// Writes a superpage to the ready queue, which has room for all the superpages in flight
+  void writeReady(const Superpage& superpage);
+
   /// Reclaims superpages pushed to the CRU but not filled on DMA stop
   void reclaimSuperpages();
 
@@ -140,11 +215,55 @@ class CruDmaChannel final : public DmaChannelPdaBase
   /// Features of the firmware
   FirmwareFeatures mFeatures;
 
-  /// Vector of objects representing links
+  /// Reads the superpage counters of the links
+  std::unique_ptr<SuperpageCountReader> mSuperpageCountReader;
+
+  /// Buffer for the superpage sizes read from a link
+  std::vector<uint32_t> mSuperpageSizes;
+
+  /// Vector of objects representing links. The links taking data come first, followed by the links being drained
+  /// after removeLink(), which are only polled for the superpages the card still holds.
+  /// It is only changed by the user thread, with the driver thread stopped.
   std::vector<Link> mLinks;
 
-  /// To keep track of how many slots are available in the link queues (in mLinks) in total
-  size_t mLinkQueuesTotalAvailable;
+  /// Amount of links taking data, at the start of mLinks
+  size_t mActiveLinkCount = 0;
+
+  /// Links whose superpages were returned while the card still held their descriptors. They can't be added back
+  /// until DMA is restarted, which resets the card.
+  std::set<LinkId> mStaleLinks;
+
+  /// Decides whether startDma() must reset the card
+  std::unique_ptr<RestartTracker> mRestartTracker;
+
+  /// Policy of the link scheduler, and range of the superpages in flight per link for LinkSchedulerPolicy::Controlled
+  LinkSchedulerPolicy::type mLinkSchedulerPolicy;
+  InFlightController::Bounds mLinkInFlightBounds;
+
+  /// Decides which link gets the next superpage
+  std::unique_ptr<LinkScheduler> mLinkScheduler;
+
+  /// mLinkScheduler, if it is a ControlledLinkScheduler
+  ControlledLinkScheduler* mControlledScheduler = nullptr;
+
+  /// Steady time in nanoseconds of the next call to controlLinkScheduler()
+  uint64_t mNextControlTime = 0;
+
+  /// Superpage FIFO empty counters per link index, and dropped packets counter, at the previous controlLinkScheduler()
+  std::vector<uint32_t> mControlFifoEmptyCounters;
+  uint32_t mControlDroppedPackets = 0;
+
+  /// Amount of superpages the user can still push: the link slots the scheduler grants, minus the superpages waiting in
+  /// the pending queue. May become negative if the scheduler lowers its grants.
+  /// Atomic since, with the driver thread enabled, it is decreased by the user and updated by the driver thread.
+  std::atomic<int64_t> mLinkQueuesTotalAvailable{ 0 };
+
+  /// Amount of superpages pushed by the user and not yet moved to the ready queue
+  std::atomic<size_t> mSuperpagesInFlight{ 0 };
+
+  /// Superpages pushed by the user and waiting for the driver thread to push them to a link.
+  /// Only used when the driver thread is enabled.
+  std::unique_ptr<PendingSuperpages> mPendingSuperpages;
 
   /// Queue for superpages that have been transferred and are waiting for popping by the user
   std::unique_ptr<SuperpageQueue> mReadyQueue;
@@ -0,0 +1,114 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file InFlightController.cxx
+/// \brief Implementation of the InFlightController class.
+
+#include "Cru/InFlightController.h"
+#include <algorithm>
+#include <cmath>
+#include "ExceptionInternal.h"
+
+namespace o2
+{
+namespace roc
+{
+
+InFlightController::InFlightController(size_t links, Bounds bounds) : mBounds(bounds), mLinkStates(links)
+{
+  if (bounds.minInFlight == 0 || bounds.minInFlight > bounds.maxInFlight) {
+    BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message(
+                            "Superpages in flight per link must be bounded by a non-zero minimum, at most the maximum"));
+  }
+  reset();
+}
+
+void InFlightController::reset()
+{
+  for (auto& state : mLinkStates) {
+    state = LinkState{};
+    state.target = mBounds.maxInFlight;
+  }
+}
+
+auto InFlightController::update(const std::vector<LinkObservation>& observations, uint64_t droppedPackets)
+  -> std::vector<Decision>
+{
+  if (observations.size() != mLinkStates.size()) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("InFlightController needs an observation per link"));
+  }
+
+  const size_t links = mLinkStates.size();
+  std::vector<bool> fifoEmpty(links);
+  std::vector<bool> dropping(links);
+  for (size_t link = 0; link < links; ++link) {
+    fifoEmpty[link] = observations[link].fifoEmptyEvents > 0;
+  }
+
+  // Drops are counted per endpoint. If no FIFO ran empty, blame the links that used up their whole target, or else
+  // all the links taking data.
+  if (droppedPackets > 0 && std::none_of(fifoEmpty.begin(), fifoEmpty.end(), [](bool empty) { return empty; })) {
+    for (size_t link = 0; link < links; ++link) {
+      dropping[link] = observations[link].completions >= mLinkStates[link].target;
+    }
+    if (std::none_of(dropping.begin(), dropping.end(), [](bool drop) { return drop; })) {
+      for (size_t link = 0; link < links; ++link) {
+        dropping[link] = observations[link].completions > 0;
+      }
+    }
+  }
+
+  std::vector<Decision> decisions;
+  for (size_t link = 0; link < links; ++link) {
+    auto& state = mLinkStates[link];
+    state.rate = RATE_SMOOTHING * observations[link].completions + (1 - RATE_SMOOTHING) * state.rate;
+    const size_t previousTarget = state.target;
+
+    if (fifoEmpty[link] || dropping[link]) {
+      // The link needed more than its target
+      state.quietUpdates = 0;
+      state.turnaround = std::max(state.turnaround, (state.target + 1) / std::max(state.rate, 1.0));
+      state.target = std::min(mBounds.maxInFlight, state.target + std::max<size_t>(1, state.target / 2));
+      if (state.target != previousTarget) {
+        decisions.push_back(Decision{ link, previousTarget, state.target,
+                                      fifoEmpty[link] ? Decision::FifoEmpty : Decision::DroppedPackets });
+      }
+      continue;
+    }
+
+    state.turnaround *= TURNAROUND_DECAY;
+    if (++state.quietUpdates < QUIET_UPDATES) {
+      continue;
+    }
+    state.quietUpdates = 0;
+    auto need = size_t(std::ceil(state.rate * state.turnaround * (1 + MARGIN)));
+    if (state.target > std::max(need, mBounds.minInFlight)) {
+      state.target--;
+      decisions.push_back(Decision{ link, previousTarget, state.target, Decision::Slack });
+    }
+  }
+  return decisions;
+}
+
+const char* InFlightController::toString(Decision::Reason reason)
+{
+  switch (reason) {
+    case Decision::FifoEmpty:
+      return "superpage FIFO empty";
+    case Decision::DroppedPackets:
+      return "dropped packets";
+    case Decision::Slack:
+      return "slack";
+  }
+  return "unknown";
+}
+
+} // namespace roc
+} // namespace o2
@@ -0,0 +1,118 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file InFlightController.h
+/// \brief Definition of the InFlightController class.
+
+#ifndef O2_READOUTCARD_CRU_INFLIGHTCONTROLLER_H_
+#define O2_READOUTCARD_CRU_INFLIGHTCONTROLLER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace o2
+{
+namespace roc
+{
+
+/// Sets the amount of superpages to keep in flight on each CRU link, within bounds, from what is observed at regular
+/// intervals: the superpages each link completed, the increases of its superpage FIFO empty counter, and the increase
+/// of the endpoint's dropped packets counter.
+///
+/// A link that ran out of superpages has its target raised by half at once. From the target it starved at and its
+/// completion rate, the controller learns how long a superpage takes to come back to the link; by Little's law, the
+/// link needs its rate times that turnaround in flight. Once the link was healthy for QUIET_UPDATES updates, its target
+/// is lowered by one towards that amount plus a margin. The turnaround slowly decays, so that the controller
+/// eventually probes lower targets again, at the cost of a rare FIFO empty event.
+///
+/// Deterministic and independent of the card, so it can be tuned with synthetic rates. Not thread-safe.
+class InFlightController
+{
+ public:
+  /// Updates a link must be healthy for, before its target is lowered by one
+  static constexpr size_t QUIET_UPDATES = 4;
+
+  /// Weight of the latest update in the smoothed completion rate
+  static constexpr double RATE_SMOOTHING = 0.25;
+
+  /// Factor applied to the learned turnaround at every healthy update
+  static constexpr double TURNAROUND_DECAY = 0.999;
+
+  /// Fraction of superpages kept in flight above the need estimated from the turnaround
+  static constexpr double MARGIN = 0.25;
+
+  /// Range of the targets
+  struct Bounds {
+    size_t minInFlight;
+    size_t maxInFlight;
+  };
+
+  /// What happened on a link since the previous update
+  struct LinkObservation {
+    uint64_t completions = 0;     ///< Superpages filled
+    uint64_t fifoEmptyEvents = 0; ///< Increase of the superpage FIFO empty counter
+  };
+
+  /// A change of the target of a link
+  struct Decision {
+    enum Reason {
+      FifoEmpty,      ///< Raised, the link's superpage FIFO ran empty
+      DroppedPackets, ///< Raised, the endpoint dropped packets and the link may have been short of superpages
+      Slack,          ///< Lowered, the link held more superpages than it needs
+    };
+
+    size_t link;
+    size_t previousTarget;
+    size_t target;
+    Reason reason;
+  };
+
+  /// \param links Amount of links
+  /// \param bounds Range of the targets. All targets start at the maximum.
+  InFlightController(size_t links, Bounds bounds);
+
+  /// Forgets what was learned, to be called when DMA starts
+  void reset();
+
+  /// Updates the targets from what happened since the previous call
+  /// \param observations What happened on each link
+  /// \param droppedPackets Increase of the endpoint's dropped packets counter
+  /// \return The targets that changed
+  std::vector<Decision> update(const std::vector<LinkObservation>& observations, uint64_t droppedPackets);
+
+  size_t getTarget(size_t link) const
+  {
+    return mLinkStates[link].target;
+  }
+
+  Bounds getBounds() const
+  {
+    return mBounds;
+  }
+
+  static const char* toString(Decision::Reason reason);
+
+ private:
+  struct LinkState {
+    size_t target = 0;
+    double rate = 0;       ///< Smoothed completions per update
+    double turnaround = 0; ///< Estimated updates a superpage takes to come back, 0 until the link first starved
+    size_t quietUpdates = 0;
+  };
+
+  const Bounds mBounds;
+  std::vector<LinkState> mLinkStates;
+};
+
+} // namespace roc
+} // namespace o2
+
+#endif // O2_READOUTCARD_CRU_INFLIGHTCONTROLLER_H_
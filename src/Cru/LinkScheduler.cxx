@@ -0,0 +1,267 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file LinkScheduler.cxx
+/// \brief Implementation of the LinkScheduler classes
+
+#include "Cru/LinkScheduler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace o2
+{
+namespace roc
+{
+
+std::unique_ptr<LinkScheduler> LinkScheduler::create(LinkSchedulerPolicy::type policy, size_t links,
+                                                     size_t linkCapacity)
+{
+  switch (policy) {
+    case LinkSchedulerPolicy::RateWeighted:
+      return std::make_unique<RateWeightedLinkScheduler>(links, linkCapacity);
+    case LinkSchedulerPolicy::Controlled:
+      return std::make_unique<ControlledLinkScheduler>(
+        links, linkCapacity, InFlightController::Bounds{ RateWeightedLinkScheduler::MIN_IN_FLIGHT, linkCapacity });
+    case LinkSchedulerPolicy::FreeSlot:
+    default:
+      return std::make_unique<FreeSlotLinkScheduler>(links, linkCapacity);
+  }
+}
+
+FreeSlotLinkScheduler::FreeSlotLinkScheduler(size_t links, size_t linkCapacity)
+  : LinkScheduler(links, linkCapacity), mFreeSlots(links * linkCapacity), mStaleEntries(links)
+{
+  reset();
+}
+
+void FreeSlotLinkScheduler::reset()
+{
+  mHead = 0;
+  mEntries = 0;
+  for (size_t slot = 0; slot < mLinkCapacity; ++slot) {
+    for (size_t link = 0; link < mLinks; ++link) {
+      mFreeSlots[mEntries++] = link;
+    }
+  }
+  mCount = mEntries;
+  std::fill(mStaleEntries.begin(), mStaleEntries.end(), 0);
+}
+
+int FreeSlotLinkScheduler::takeSlot()
+{
+  if (mCount == 0) {
+    return -1;
+  }
+  while (true) {
+    int link = mFreeSlots[mHead];
+    mHead = (mHead + 1) % mFreeSlots.size();
+    mEntries--;
+    if (mStaleEntries[link] > 0) {
+      mStaleEntries[link]--;
+      continue;
+    }
+    mCount--;
+    return link;
+  }
+}
+
+void FreeSlotLinkScheduler::takeSlotOnLink(size_t link)
+{
+  // One of the link's entries in the ring buffer is now stale, whichever comes first
+  mStaleEntries[link]++;
+  mCount--;
+}
+
+void FreeSlotLinkScheduler::releaseSlot(size_t link, bool /*completed*/)
+{
+  mCount++;
+  if (mStaleEntries[link] > 0) {
+    // The link's stale entry is still in the ring buffer and becomes valid again. Appending one would overflow the ring.
+    mStaleEntries[link]--;
+    return;
+  }
+  mFreeSlots[(mHead + mEntries) % mFreeSlots.size()] = link;
+  mEntries++;
+}
+
+RateWeightedLinkScheduler::RateWeightedLinkScheduler(size_t links, size_t linkCapacity)
+  : LinkScheduler(links, linkCapacity), mLinkStates(links)
+{
+  reset();
+}
+
+void RateWeightedLinkScheduler::reset()
+{
+  // Until rates are known, every link gets the minimum
+  for (auto& state : mLinkStates) {
+    state = LinkState{};
+    state.target = std::min(MIN_IN_FLIGHT, mLinkCapacity);
+  }
+  mWindowCompletions = 0;
+  mAvailable = mLinks * std::min(MIN_IN_FLIGHT, mLinkCapacity);
+}
+
+int RateWeightedLinkScheduler::takeSlot()
+{
+  // The link furthest below its target
+  int best = -1;
+  size_t bestHeadroom = 0;
+  for (size_t link = 0; link < mLinks; ++link) {
+    auto headroom = getHeadroom(mLinkStates[link]);
+    if (headroom > bestHeadroom) {
+      best = link;
+      bestHeadroom = headroom;
+    }
+  }
+
+  if (best >= 0) {
+    mLinkStates[best].inFlight++;
+    mAvailable--;
+  }
+  return best;
+}
+
+void RateWeightedLinkScheduler::takeSlotOnLink(size_t link)
+{
+  auto& state = mLinkStates[link];
+  auto headroomBefore = getHeadroom(state);
+  state.inFlight++;
+  mAvailable -= headroomBefore - getHeadroom(state);
+}
+
+void RateWeightedLinkScheduler::releaseSlot(size_t link, bool completed)
+{
+  auto& state = mLinkStates[link];
+  auto headroomBefore = getHeadroom(state);
+  state.inFlight--;
+  mAvailable += getHeadroom(state) - headroomBefore;
+
+  if (completed) {
+    state.windowCompletions++;
+    mWindowCompletions++;
+    if (mWindowCompletions >= WINDOW_PER_LINK * mLinks) {
+      updateTargets();
+    }
+  }
+}
+
+void RateWeightedLinkScheduler::updateTargets()
+{
+  double rateSum = 0;
+  for (auto& state : mLinkStates) {
+    state.rate = 0.5 * state.rate + 0.5 * state.windowCompletions;
+    rateSum += state.rate;
+  }
+
+  // Share all the link slots according to the rates
+  const double slots = mLinks * mLinkCapacity;
+  const size_t minInFlight = std::min(MIN_IN_FLIGHT, mLinkCapacity);
+  mAvailable = 0;
+  for (auto& state : mLinkStates) {
+    auto target = size_t(std::ceil(slots * state.rate / rateSum));
+    if (state.windowCompletions >= state.target) {
+      // The link completed its whole allowance, so its rate may be limited by its target: let it grow
+      target = std::max(target, 2 * state.target);
+    }
+    state.target = std::max(minInFlight, std::min(target, mLinkCapacity));
+    state.windowCompletions = 0;
+    mAvailable += getHeadroom(state);
+  }
+  mWindowCompletions = 0;
+}
+
+namespace
+{
+InFlightController::Bounds limitBounds(InFlightController::Bounds bounds, size_t linkCapacity)
+{
+  bounds.maxInFlight = std::min(bounds.maxInFlight, linkCapacity);
+  bounds.minInFlight = std::min(bounds.minInFlight, bounds.maxInFlight);
+  return bounds;
+}
+} // namespace
+
+ControlledLinkScheduler::ControlledLinkScheduler(size_t links, size_t linkCapacity, InFlightController::Bounds bounds)
+  : LinkScheduler(links, linkCapacity), mController(links, limitBounds(bounds, linkCapacity)), mLinkStates(links)
+{
+  reset();
+}
+
+void ControlledLinkScheduler::reset()
+{
+  mController.reset();
+  for (auto& state : mLinkStates) {
+    state = LinkState{};
+  }
+  updateAvailable();
+}
+
+int ControlledLinkScheduler::takeSlot()
+{
+  // The link furthest below its target
+  int best = -1;
+  size_t bestHeadroom = 0;
+  for (size_t link = 0; link < mLinks; ++link) {
+    auto headroom = getHeadroom(link);
+    if (headroom > bestHeadroom) {
+      best = link;
+      bestHeadroom = headroom;
+    }
+  }
+
+  if (best >= 0) {
+    mLinkStates[best].inFlight++;
+    mAvailable--;
+  }
+  return best;
+}
+
+void ControlledLinkScheduler::takeSlotOnLink(size_t link)
+{
+  auto headroomBefore = getHeadroom(link);
+  mLinkStates[link].inFlight++;
+  mAvailable -= headroomBefore - getHeadroom(link);
+}
+
+void ControlledLinkScheduler::releaseSlot(size_t link, bool completed)
+{
+  auto headroomBefore = getHeadroom(link);
+  mLinkStates[link].inFlight--;
+  mAvailable += getHeadroom(link) - headroomBefore;
+  if (completed) {
+    mLinkStates[link].completions++;
+  }
+}
+
+auto ControlledLinkScheduler::control(const std::vector<uint64_t>& fifoEmptyEvents, uint64_t droppedPackets)
+  -> std::vector<InFlightController::Decision>
+{
+  std::vector<InFlightController::LinkObservation> observations(mLinks);
+  for (size_t link = 0; link < mLinks; ++link) {
+    observations[link].completions = mLinkStates[link].completions;
+    observations[link].fifoEmptyEvents = link < fifoEmptyEvents.size() ? fifoEmptyEvents[link] : 0;
+    mLinkStates[link].completions = 0;
+  }
+  auto decisions = mController.update(observations, droppedPackets);
+  if (!decisions.empty()) {
+    updateAvailable();
+  }
+  return decisions;
+}
+
+void ControlledLinkScheduler::updateAvailable()
+{
+  mAvailable = 0;
+  for (size_t link = 0; link < mLinks; ++link) {
+    mAvailable += getHeadroom(link);
+  }
+}
+
+} // namespace roc
+} // namespace o2
@@ -0,0 +1,213 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file LinkScheduler.h
+/// \brief Definition of the LinkScheduler classes, deciding which CRU link gets the next superpage
+
+#ifndef O2_READOUTCARD_CRU_LINKSCHEDULER_H_
+#define O2_READOUTCARD_CRU_LINKSCHEDULER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Cru/InFlightController.h"
+#include "ReadoutCard/ParameterTypes/LinkSchedulerPolicy.h"
+
+namespace o2
+{
+namespace roc
+{
+
+/// Decides which link gets the next superpage pushed to the CRU, by handing out slots in the link queues.
+/// Not thread-safe: only used by the thread doing the driver work.
+class LinkScheduler
+{
+ public:
+  /// \param links Amount of links
+  /// \param linkCapacity Amount of superpages each link queue can hold
+  LinkScheduler(size_t links, size_t linkCapacity) : mLinks(links), mLinkCapacity(linkCapacity)
+  {
+  }
+
+  virtual ~LinkScheduler()
+  {
+  }
+
+  /// Creates the scheduler for the given policy
+  static std::unique_ptr<LinkScheduler> create(LinkSchedulerPolicy::type policy, size_t links, size_t linkCapacity);
+
+  /// Forgets all superpages in flight, to be called when DMA starts
+  virtual void reset() = 0;
+
+  /// Takes a slot for the next superpage
+  /// \return The index of the link the superpage goes to, or -1 if the scheduler grants no slot
+  virtual int takeSlot() = 0;
+
+  /// Takes a slot on the given link, for a superpage the user pushed to it. May exceed what the scheduler grants the
+  /// link; the caller makes sure the link queue has room.
+  /// \param link Index of the link
+  virtual void takeSlotOnLink(size_t link) = 0;
+
+  /// Gives back the slot of a superpage that left a link queue
+  /// \param link Index of the link
+  /// \param completed True if the superpage was filled, false if it was reclaimed
+  virtual void releaseSlot(size_t link, bool completed) = 0;
+
+  /// Gets the amount of slots takeSlot() would currently grant
+  virtual size_t getAvailable() const = 0;
+
+ protected:
+  const size_t mLinks;
+  const size_t mLinkCapacity;
+};
+
+/// Hands out the free slots of all link queues in the order they were freed, in constant time.
+/// Initially, slots are interleaved over the links, so superpages are spread evenly.
+class FreeSlotLinkScheduler final : public LinkScheduler
+{
+ public:
+  FreeSlotLinkScheduler(size_t links, size_t linkCapacity);
+
+  virtual void reset() override;
+  virtual int takeSlot() override;
+  virtual void takeSlotOnLink(size_t link) override;
+  virtual void releaseSlot(size_t link, bool completed) override;
+
+  virtual size_t getAvailable() const override
+  {
+    return mCount;
+  }
+
+ private:
+  /// Ring buffer of the links of the free slots
+  std::vector<uint32_t> mFreeSlots;
+  size_t mHead = 0;
+  size_t mEntries = 0;
+
+  /// Amount of free slots, which is mEntries minus the stale entries
+  size_t mCount = 0;
+
+  /// Per link, the amount of its entries in the ring buffer that are stale, because takeSlotOnLink() took the slot.
+  /// They are skipped lazily by takeSlot(), or made valid again by releaseSlot() on the link.
+  std::vector<size_t> mStaleEntries;
+};
+
+/// Keeps an amount of superpages in flight per link proportional to the link's completion rate, measured over windows
+/// of completions. Fast links are kept topped up, while idle links only hold a minimum amount of superpages, instead of
+/// a full link queue each. Slots go to the link furthest below its target, in time linear in the amount of links.
+class RateWeightedLinkScheduler final : public LinkScheduler
+{
+ public:
+  /// Superpages kept in flight on every link, so that a link that becomes active is noticed
+  static constexpr size_t MIN_IN_FLIGHT = 2;
+
+  /// Completions per link, on average, after which the targets are updated
+  static constexpr size_t WINDOW_PER_LINK = 4;
+
+  RateWeightedLinkScheduler(size_t links, size_t linkCapacity);
+
+  virtual void reset() override;
+  virtual int takeSlot() override;
+  virtual void takeSlotOnLink(size_t link) override;
+  virtual void releaseSlot(size_t link, bool completed) override;
+
+  virtual size_t getAvailable() const override
+  {
+    return mAvailable;
+  }
+
+  /// Gets the amount of superpages the scheduler aims to keep in flight on a link
+  size_t getTarget(size_t link) const
+  {
+    return mLinkStates[link].target;
+  }
+
+ private:
+  struct LinkState {
+    size_t inFlight = 0;
+    size_t target = 0;
+    size_t windowCompletions = 0;
+    double rate = 0; ///< Smoothed completions per window
+  };
+
+  size_t getHeadroom(const LinkState& state) const
+  {
+    return state.target > state.inFlight ? state.target - state.inFlight : 0;
+  }
+
+  void updateTargets();
+
+  std::vector<LinkState> mLinkStates;
+  size_t mWindowCompletions = 0;
+  size_t mAvailable = 0;
+};
+
+/// Keeps the amount of superpages in flight per link that an InFlightController sets, from the completions counted here
+/// and the FIFO empty and dropped packets counters the channel reads from the card. Slots go to the link furthest below
+/// its target, in time linear in the amount of links.
+class ControlledLinkScheduler final : public LinkScheduler
+{
+ public:
+  /// \param bounds Range of the targets. The maximum is lowered to the link capacity.
+  ControlledLinkScheduler(size_t links, size_t linkCapacity, InFlightController::Bounds bounds);
+
+  virtual void reset() override;
+  virtual int takeSlot() override;
+  virtual void takeSlotOnLink(size_t link) override;
+  virtual void releaseSlot(size_t link, bool completed) override;
+
+  virtual size_t getAvailable() const override
+  {
+    return mAvailable;
+  }
+
+  /// Updates the targets from what happened since the previous call
+  /// \param fifoEmptyEvents Increase of the superpage FIFO empty counter of each link
+  /// \param droppedPackets Increase of the endpoint's dropped packets counter
+  /// \return The targets that changed
+  std::vector<InFlightController::Decision> control(const std::vector<uint64_t>& fifoEmptyEvents,
+                                                    uint64_t droppedPackets);
+
+  /// Gets the amount of superpages the controller aims to keep in flight on a link
+  size_t getTarget(size_t link) const
+  {
+    return mController.getTarget(link);
+  }
+
+  /// Gets the range of the targets, after limiting it to the link capacity
+  InFlightController::Bounds getBounds() const
+  {
+    return mController.getBounds();
+  }
+
+ private:
+  struct LinkState {
+    size_t inFlight = 0;
+    uint64_t completions = 0; ///< Since the previous call to control()
+  };
+
+  size_t getHeadroom(size_t link) const
+  {
+    auto target = mController.getTarget(link);
+    return target > mLinkStates[link].inFlight ? target - mLinkStates[link].inFlight : 0;
+  }
+
+  void updateAvailable();
+
+  InFlightController mController;
+  std::vector<LinkState> mLinkStates;
+  size_t mAvailable = 0;
+};
+
+} // namespace roc
+} // namespace o2
+
+#endif // O2_READOUTCARD_CRU_LINKSCHEDULER_H_
@@ -0,0 +1,123 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file PendingSuperpages.h
+/// \brief Definition of the PendingSuperpages class
+
+#ifndef O2_READOUTCARD_CRU_PENDINGSUPERPAGES_H_
+#define O2_READOUTCARD_CRU_PENDINGSUPERPAGES_H_
+
+#include <array>
+#include <cstddef>
+#include <deque>
+#include "Cru/Constants.h"
+#include "ReadoutCard/Superpage.h"
+#include "SuperpageQueue.h"
+
+namespace o2
+{
+namespace roc
+{
+
+/// Superpages pushed by the user and waiting for the driver thread to push them to the card. The target of a
+/// superpage is its link, or the link scheduler if the link is not set.
+///
+/// The user thread writes the superpages, and the driver thread pushes them. A superpage whose target has no room is
+/// set aside until it does, along with the later superpages of the same target, so that a full link does not hold
+/// back the superpages of the other targets. The superpages of each target keep their order.
+class PendingSuperpages
+{
+ public:
+  /// \param capacity Most superpages waiting to be pushed
+  explicit PendingSuperpages(size_t capacity) : mQueue(capacity + 1) // folly queue needs + 1
+  {
+  }
+
+  /// Adds a superpage. Called by the user thread.
+  /// \return False if there was no room
+  bool write(const Superpage& superpage)
+  {
+    return mQueue.write(superpage);
+  }
+
+  /// Pushes the superpages whose target has room. The ones set aside are tried first, those of the links before those
+  /// of the scheduler, so that the links get back the room the scheduler may have taken from them. Called by the
+  /// driver thread.
+  /// \param tryPush Pushes a superpage to its target, and returns false if the target had no room
+  /// \return The amount of superpages pushed
+  template <typename TryPush>
+  size_t push(TryPush tryPush)
+  {
+    size_t pushed = 0;
+    if (mSetAsideCount > 0) {
+      for (auto& setAside : mSetAside) {
+        while (!setAside.empty() && tryPush(setAside.front())) {
+          setAside.pop_front();
+          mSetAsideCount--;
+          pushed++;
+        }
+      }
+    }
+
+    while (auto superpage = mQueue.frontPtr()) {
+      auto& setAside = getSetAside(*superpage);
+      if (!setAside.empty() || !tryPush(*superpage)) {
+        setAside.push_back(*superpage);
+        mSetAsideCount++;
+      } else {
+        pushed++;
+      }
+      mQueue.popFront();
+    }
+    return pushed;
+  }
+
+  /// Removes all the superpages, in order for each target. Called with the driver thread stopped.
+  /// \param take Called for each superpage removed
+  template <typename Take>
+  void takeAll(Take take)
+  {
+    // The superpages set aside are older than the ones of the same target still in the queue
+    for (auto& setAside : mSetAside) {
+      for (const auto& superpage : setAside) {
+        take(superpage);
+      }
+      setAside.clear();
+    }
+    mSetAsideCount = 0;
+    while (auto superpage = tryPopFront(mQueue)) {
+      take(*superpage);
+    }
+  }
+
+  /// Amount of superpages set aside because their target had no room
+  size_t getSetAsideCount() const
+  {
+    return mSetAsideCount;
+  }
+
+ private:
+  std::deque<Superpage>& getSetAside(const Superpage& superpage)
+  {
+    return superpage.getLink() >= 0 ? mSetAside[superpage.getLink()] : mSetAside[Cru::MAX_LINKS];
+  }
+
+  /// Superpages written by the user thread
+  SuperpageQueue mQueue;
+
+  /// Superpages set aside, by link, then for the scheduler. Only used by the driver thread.
+  std::array<std::deque<Superpage>, Cru::MAX_LINKS + 1> mSetAside;
+  size_t mSetAsideCount = 0;
+};
+
+} // namespace roc
+} // namespace o2
+
+#endif // O2_READOUTCARD_CRU_PENDINGSUPERPAGES_H_
@@ -0,0 +1,39 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file RestartTracker.cxx
+/// \brief Implementation of the RestartTracker class
+
+#include "Cru/RestartTracker.h"
+
+namespace o2
+{
+namespace roc
+{
+
+RestartTracker::RestartTracker(SuperpageCountReader& reader, bool fastRestartEnabled)
+  : mReader(reader), mFastRestartEnabled(fastRestartEnabled)
+{
+}
+
+bool RestartTracker::start()
+{
+  mFastRestart = mFastRestartEnabled && !mCardHoldsDescriptors;
+  mCardHoldsDescriptors = false;
+  return !mFastRestart;
+}
+
+size_t RestartTracker::readStartCounts(const SuperpageCountReader::LinkMask& links)
+{
+  return mFastRestart ? mReader.read(links) : 0;
+}
+
+} // namespace roc
+} // namespace o2
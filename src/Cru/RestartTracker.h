@@ -0,0 +1,76 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file RestartTracker.h
+/// \brief Definition of the RestartTracker class
+
+#ifndef O2_READOUTCARD_CRU_RESTARTTRACKER_H_
+#define O2_READOUTCARD_CRU_RESTARTTRACKER_H_
+
+#include <cstdint>
+#include "Cru/SuperpageCountReader.h"
+
+namespace o2
+{
+namespace roc
+{
+
+/// Decides whether a DMA start of the CRU must reset the card, and which superpage counters the links start from.
+/// The card may only be restarted without a reset when fast restart is enabled and it holds no superpage descriptors,
+/// since a reset is the only way to clear them. It then carries on counting superpages from where it stopped.
+class RestartTracker
+{
+ public:
+  /// \param reader Reader of the superpage counters of the card
+  /// \param fastRestartEnabled Skip the reset when the card holds no superpage descriptors
+  RestartTracker(SuperpageCountReader& reader, bool fastRestartEnabled);
+
+  /// Records that the card still holds superpage descriptors: superpages were reclaimed from a link queue when DMA
+  /// stopped, or returned from a removed link
+  void descriptorsLeft()
+  {
+    mCardHoldsDescriptors = true;
+  }
+
+  /// Records a reset of the card, which clears its descriptors
+  void cardReset()
+  {
+    mCardHoldsDescriptors = false;
+  }
+
+  /// Decides, at DMA start, whether the card must be reset. The card holds no descriptors afterwards.
+  /// \return True if the card must be reset
+  bool start();
+
+  /// Reads the superpage counters the links start from: the card's after a fast restart, zero after a reset
+  /// \return The amount of registers read
+  size_t readStartCounts(const SuperpageCountReader::LinkMask& links);
+
+  /// Gets the counter a link starts from, as of the last readStartCounts() that included it
+  uint32_t getStartCount(uint32_t link) const
+  {
+    return mFastRestart ? mReader.getSuperpageCount(link) : 0;
+  }
+
+ private:
+  SuperpageCountReader& mReader;
+  const bool mFastRestartEnabled;
+
+  /// Whether the card may still hold superpage descriptors. True until the first DMA start.
+  bool mCardHoldsDescriptors = true;
+
+  /// Whether the last start skipped the reset
+  bool mFastRestart = false;
+};
+
+} // namespace roc
+} // namespace o2
+
+#endif // O2_READOUTCARD_CRU_RESTARTTRACKER_H_
@@ -0,0 +1,61 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file SuperpageCountReader.cxx
+/// \brief Implementation of the SuperpageCountReader class
+
+#include "Cru/SuperpageCountReader.h"
+
+namespace o2
+{
+namespace roc
+{
+
+// The block read relies on the counters of consecutive links being in consecutive registers
+static_assert(Cru::Registers::SUPERPAGES_READY_INTERVAL == sizeof(uint32_t),
+              "LINK_SUPERPAGE_COUNT registers are not contiguous");
+
+SuperpageCountReader::SuperpageCountReader(RegisterReadWriteInterface& bar, bool batched)
+  : mBar(bar), mBatched(batched)
+{
+}
+
+size_t SuperpageCountReader::read(const LinkMask& links)
+{
+  if (links.none()) {
+    return 0;
+  }
+
+  if (!mBatched) {
+    size_t reads = 0;
+    for (uint32_t link = 0; link < links.size(); ++link) {
+      if (links.test(link)) {
+        mCounts[link] = mBar.readRegister(Cru::Registers::LINK_SUPERPAGE_COUNT.get(link).index);
+        reads++;
+      }
+    }
+    return reads;
+  }
+
+  uint32_t first = 0;
+  while (!links.test(first)) {
+    first++;
+  }
+  uint32_t last = links.size() - 1;
+  while (!links.test(last)) {
+    last--;
+  }
+
+  mBar.readRegisterBlock(Cru::Registers::LINK_SUPERPAGE_COUNT.get(first).index, &mCounts[first], last - first + 1);
+  return last - first + 1;
+}
+
+} // namespace roc
+} // namespace o2
@@ -0,0 +1,64 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file SuperpageCountReader.h
+/// \brief Definition of the SuperpageCountReader class
+
+#ifndef O2_READOUTCARD_CRU_SUPERPAGECOUNTREADER_H_
+#define O2_READOUTCARD_CRU_SUPERPAGECOUNTREADER_H_
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include "Cru/Constants.h"
+#include "ReadoutCard/RegisterReadWriteInterface.h"
+
+namespace o2
+{
+namespace roc
+{
+
+/// Reads the per-link LINK_SUPERPAGE_COUNT registers of the CRU.
+/// In batched mode, the registers of the requested links are fetched with a single block read spanning the lowest to
+/// the highest of them, instead of one read per link.
+class SuperpageCountReader
+{
+ public:
+  using LinkMask = std::bitset<Cru::MAX_LINKS>;
+
+  /// \param bar BAR 0 of the CRU
+  /// \param batched Read the counters as one block
+  SuperpageCountReader(RegisterReadWriteInterface& bar, bool batched);
+
+  /// Reads the counters of the links set in the mask. The counters of the other links keep their previous values.
+  /// \return The amount of registers read, including those between the requested links in a block read
+  size_t read(const LinkMask& links);
+
+  /// Gets the counter of a link, as of the last read() that included it
+  uint32_t getSuperpageCount(uint32_t link) const
+  {
+    return mCounts[link];
+  }
+
+  bool isBatched() const
+  {
+    return mBatched;
+  }
+
+ private:
+  RegisterReadWriteInterface& mBar;
+  const bool mBatched;
+  std::array<uint32_t, Cru::MAX_LINKS> mCounts = {};
+};
+
+} // namespace roc
+} // namespace o2
+
+#endif // O2_READOUTCARD_CRU_SUPERPAGECOUNTREADER_H_
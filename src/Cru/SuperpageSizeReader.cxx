@@ -0,0 +1,76 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file SuperpageSizeReader.cxx
+/// \brief Implementation of the SuperpageSizeReader class
+
+#include "Cru/SuperpageSizeReader.h"
+#include "Utilities/Util.h"
+
+namespace o2
+{
+namespace roc
+{
+
+SuperpageSizeReader::SuperpageSizeReader(RegisterReadWriteInterface& bar, uint32_t maxRetries)
+  : mBar(bar), mMaxRetries(maxRetries)
+{
+}
+
+size_t SuperpageSizeReader::read(uint32_t link, uint32_t* sizes, size_t count, Statistics& statistics)
+{
+  const int index = Cru::Registers::LINK_SUPERPAGE_SIZE.get(link).index;
+
+  size_t done = 0;
+  while (done < count) {
+    if (!mPopped[link]) {
+      mBar.writeRegister(index, 0xbadcafe); // write a dummy value to update the FIFO
+      mPopped[link] = true;
+    }
+
+    uint32_t superpageSizeFifo = mBar.readRegister(index);
+    statistics.reads++;
+    uint32_t superpageSize = Utilities::getBits(superpageSizeFifo, 0, 23); // [0-23] -> superpage size (in bytes)
+
+    if (superpageSize != 0) { // No reason to check for index -> superpageSize == 0 -> CRU FW < v3.4.0
+      uint32_t retries = 0;
+      uint32_t superpageSizeIndex = Utilities::getBits(superpageSizeFifo, 24, 31); // [24-31] -> superpage index (0-255)
+      while (superpageSizeIndex != mIndexCounters[link]) { // In case the PCIe bus wasn't fast enough
+        if (retries == mMaxRetries) {
+          // Leave the entry popped, so the next call only re-reads it
+          statistics.budgetExhausted++;
+          return done;
+        }
+        superpageSizeFifo = mBar.readRegister(index);
+        superpageSize = Utilities::getBits(superpageSizeFifo, 0, 23);
+        superpageSizeIndex = Utilities::getBits(superpageSizeFifo, 24, 31);
+        statistics.reads++;
+        statistics.indexLags++;
+        retries++;
+      }
+      mIndexCounters[link] = (superpageSizeIndex + 1) % 256;
+    }
+
+    mPopped[link] = false;
+    sizes[done] = superpageSize;
+    done++;
+  }
+
+  return done;
+}
+
+void SuperpageSizeReader::reset()
+{
+  mIndexCounters.fill(0);
+  mPopped.fill(false);
+}
+
+} // namespace roc
+} // namespace o2
@@ -0,0 +1,75 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file SuperpageSizeReader.h
+/// \brief Definition of the SuperpageSizeReader class
+
+#ifndef O2_READOUTCARD_CRU_SUPERPAGESIZEREADER_H_
+#define O2_READOUTCARD_CRU_SUPERPAGESIZEREADER_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "Cru/Constants.h"
+#include "ReadoutCard/RegisterReadWriteInterface.h"
+
+namespace o2
+{
+namespace roc
+{
+
+/// Reads the sizes of the completed superpages from the per-link LINK_SUPERPAGE_SIZE FIFOs of the CRU.
+/// A write to the register pops the next entry, which holds the size and an 8-bit index. The index is checked against
+/// a per-link counter, and the register re-read while it lags, up to a retry budget.
+class SuperpageSizeReader
+{
+ public:
+  /// Default amount of re-reads allowed for one superpage while the index lags
+  static constexpr uint32_t DEFAULT_MAX_RETRIES = 1000;
+
+  /// Counters of the register accesses done by read()
+  struct Statistics {
+    uint64_t reads = 0;           ///< Register reads
+    uint64_t indexLags = 0;       ///< Re-reads because the index lagged
+    uint64_t budgetExhausted = 0; ///< Times the retry budget ran out
+  };
+
+  /// \param bar BAR 0 of the CRU
+  /// \param maxRetries Amount of re-reads allowed for one superpage while the index lags
+  SuperpageSizeReader(RegisterReadWriteInterface& bar, uint32_t maxRetries = DEFAULT_MAX_RETRIES);
+
+  /// Reads the sizes of the next completed superpages of a link, in order. A size of 0 means the firmware does not
+  /// report sizes (CRU firmware < v3.4.0).
+  /// If the retry budget runs out, the sizes read so far are returned, and the next call resumes with the same entry.
+  /// \param link Link number
+  /// \param sizes Array receiving the sizes, in bytes
+  /// \param count The amount of completed superpages to read the size of
+  /// \param statistics Counters to add the register accesses to
+  /// \return The amount of sizes read
+  size_t read(uint32_t link, uint32_t* sizes, size_t count, Statistics& statistics);
+
+  /// Resets the per-link index counters, to be done when the card's counters are reset
+  void reset();
+
+ private:
+  RegisterReadWriteInterface& mBar;
+  const uint32_t mMaxRetries;
+
+  /// Per-link index expected in the next FIFO entry
+  std::array<uint32_t, Cru::MAX_LINKS> mIndexCounters = {};
+
+  /// Per-link flag telling if the next entry was already popped, but its index not matched yet
+  std::array<bool, Cru::MAX_LINKS> mPopped = {};
+};
+
+} // namespace roc
+} // namespace o2
+
+#endif // O2_READOUTCARD_CRU_SUPERPAGESIZEREADER_H_
@@ -30,52 +30,95 @@ namespace DataFormat
 {
 namespace
 {
-uint32_t getWord(const char* data, int i)
+inline uint32_t getWord(const char* data, int i)
 {
   uint32_t word = 0;
   memcpy(&word, &data[sizeof(word) * i], sizeof(word));
   return word;
 }
+
+inline void setWord(char* data, int i, uint32_t word)
+{
+  memcpy(&data[sizeof(word) * i], &word, sizeof(word));
+}
+
+inline void setBits(char* data, int i, int index, int width, uint32_t value)
+{
+  auto word = getWord(data, i);
+  Utilities::setBits(word, index, width, value);
+  setWord(data, i, word);
+}
 } // Anonymous namespace
 
-uint32_t getLinkId(const char* data)
+inline uint32_t getLinkId(const char* data)
 {
   return Utilities::getBits(getWord(data, 3), 0, 7); //bits #[96-103] from RDH word 0
 }
 
-uint32_t getMemsize(const char* data)
+inline uint32_t getMemsize(const char* data)
 {
   return Utilities::getBits(getWord(data, 2), 16, 31); //bits #[80-95] from RDH word 0
 }
 
-uint32_t getPacketCounter(const char* data)
+inline uint32_t getPacketCounter(const char* data)
 {
   return Utilities::getBits(getWord(data, 3), 8, 15); //bits #[104-111] from RDH word 0
 }
 
-uint32_t getOffset(const char* data)
+inline uint32_t getOffset(const char* data)
 {
   return Utilities::getBits(getWord(data, 2), 0, 15); //bits #[64-79] from RDH word 0
 }
 
-uint32_t getOrbit(const char* data)
+inline uint32_t getOrbit(const char* data)
 {
-  return Utilities::getBits(getWord(data, 5), 0, 31); //bits #[64-95] from RDH word 1
+  return getWord(data, 5); //bits #[64-95] from RDH word 1
 }
 
-uint32_t getTriggerType(const char* data)
+inline uint32_t getTriggerType(const char* data)
 {
-  return Utilities::getBits(getWord(data, 8), 0, 31); //bits #[0-31] from RDH word 3
+  return getWord(data, 8); //bits #[0-31] from RDH word 3
 }
 
-uint32_t getPagesCounter(const char* data)
+inline uint32_t getPagesCounter(const char* data)
 {
   return Utilities::getBits(getWord(data, 9), 0, 15); //bits #[40-55] from RDH word 3
 }
 
-uint32_t getBunchCrossing(const char* data)
+inline uint32_t getBunchCrossing(const char* data)
+{
+  return getWord(data, 4);
+}
+
+/// Setters for the RDH fields above, for generating data in software. Other fields are left untouched.
+inline void setLinkId(char* data, uint32_t linkId)
+{
+  setBits(data, 3, 0, 8, linkId);
+}
+
+inline void setMemsize(char* data, uint32_t memsize)
+{
+  setBits(data, 2, 16, 16, memsize);
+}
+
+inline void setPacketCounter(char* data, uint32_t packetCounter)
+{
+  setBits(data, 3, 8, 8, packetCounter);
+}
+
+inline void setOffset(char* data, uint32_t offset)
+{
+  setBits(data, 2, 0, 16, offset);
+}
+
+inline void setOrbit(char* data, uint32_t orbit)
+{
+  setWord(data, 5, orbit);
+}
+
+inline void setTriggerType(char* data, uint32_t triggerType)
 {
-  return Utilities::getBits(getWord(data, 4), 0, 31);
+  setWord(data, 8, triggerType);
 }
 
 /// Get header size in bytes
@@ -51,6 +51,12 @@ class DmaBufferProviderInterface
 
   /// Gets the bus address that corresponds to the userspace address + given offset
   virtual uintptr_t getBusOffsetAddress(size_t offset) const = 0;
+
+  /// Whether other users in the process still hold the registration of the buffer
+  virtual bool isRegistrationShared() const
+  {
+    return false;
+  }
 };
 
 } // namespace roc
@@ -19,6 +19,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <vector>
 #include "DmaBufferProvider/DmaBufferProviderInterface.h"
 #include "Pda/PdaDevice.h"
@@ -29,13 +30,14 @@ namespace o2
 namespace roc
 {
 
-/// Implementation of the DmaBufferProviderInterface for in-memory DMA buffers registered with PDA
+/// Implementation of the DmaBufferProviderInterface for in-memory DMA buffers registered with PDA. Channels of a
+/// device providing the same buffer share its registration.
 class PdaDmaBufferProvider : public DmaBufferProviderInterface
 {
  public:
   PdaDmaBufferProvider(PciDevice* pciDevice, void* userBufferAddress, size_t userBufferSize,
                        int dmaBufferId, SerialId serialId, bool requireHugepage)
-    : mAddress(userBufferAddress), mSize(userBufferSize), mPdaBuffer(pciDevice, userBufferAddress, userBufferSize, dmaBufferId, serialId, requireHugepage)
+    : mAddress(userBufferAddress), mSize(userBufferSize), mPdaBuffer(Pda::PdaDmaBuffer::getShared(pciDevice, userBufferAddress, userBufferSize, dmaBufferId, serialId, requireHugepage))
   {
   }
 
@@ -56,31 +58,36 @@ class PdaDmaBufferProvider : public DmaBufferProviderInterface
   /// Amount of entries in the scatter-gather list
   virtual size_t getScatterGatherListSize() const
   {
-    return mPdaBuffer.getScatterGatherList().size();
+    return mPdaBuffer->getScatterGatherList().size();
   }
 
   /// Get size of an entry of the scatter-gather list
   virtual size_t getScatterGatherEntrySize(int index) const
   {
-    return mPdaBuffer.getScatterGatherList().at(index).size;
+    return mPdaBuffer->getScatterGatherList().at(index).size;
   }
 
   /// Get userspace address of an entry of the scatter-gather list
   virtual uintptr_t getScatterGatherEntryAddress(int index) const
   {
-    return mPdaBuffer.getScatterGatherList().at(index).addressUser;
+    return mPdaBuffer->getScatterGatherList().at(index).addressUser;
   }
 
   /// Function for getting the bus address that corresponds to the user address + given offset
   virtual uintptr_t getBusOffsetAddress(size_t offset) const
   {
-    return mPdaBuffer.getBusOffsetAddress(offset);
+    return mPdaBuffer->getBusOffsetAddress(offset);
+  }
+
+  virtual bool isRegistrationShared() const
+  {
+    return mPdaBuffer.use_count() > 1;
   }
 
  private:
   void* mAddress;
   size_t mSize;
-  Pda::PdaDmaBuffer mPdaBuffer;
+  std::shared_ptr<Pda::PdaDmaBuffer> mPdaBuffer;
 };
 
 } // namespace roc
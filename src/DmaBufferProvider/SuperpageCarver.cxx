@@ -0,0 +1,71 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file SuperpageCarver.cxx
+/// \brief Implementation of the SuperpageCarver class.
+
+#include "DmaBufferProvider/SuperpageCarver.h"
+#include <algorithm>
+
+namespace o2
+{
+namespace roc
+{
+
+auto SuperpageCarver::getContiguousRegions(const DmaBufferProviderInterface& buffer) -> std::vector<Region>
+{
+  // The entries as ranges of the buffer, clipped to it
+  const uintptr_t bufferAddress = buffer.getAddress();
+  const size_t bufferSize = buffer.getSize();
+  std::vector<Region> entries;
+  for (size_t i = 0; i < buffer.getScatterGatherListSize(); ++i) {
+    uintptr_t address = buffer.getScatterGatherEntryAddress(i);
+    size_t size = buffer.getScatterGatherEntrySize(i);
+    uintptr_t start = std::max(address, bufferAddress);
+    uintptr_t end = std::min(address + size, bufferAddress + bufferSize);
+    if (start < end) {
+      entries.push_back(Region{ start - bufferAddress, end - start });
+    }
+  }
+  std::sort(entries.begin(), entries.end(), [](const Region& a, const Region& b) { return a.offset < b.offset; });
+
+  std::vector<Region> regions;
+  for (const auto& entry : entries) {
+    if (!regions.empty()) {
+      auto& last = regions.back();
+      const size_t lastEnd = last.offset + last.size;
+      if (lastEnd == entry.offset &&
+          buffer.getBusOffsetAddress(last.offset) + last.size == buffer.getBusOffsetAddress(entry.offset)) {
+        last.size += entry.size;
+        continue;
+      }
+    }
+    regions.push_back(entry);
+  }
+  return regions;
+}
+
+std::vector<size_t> SuperpageCarver::carve(const std::vector<Region>& regions, size_t superpageSize)
+{
+  // Packing each region from its start is optimal, since superpages can't straddle regions
+  std::vector<size_t> offsets;
+  if (superpageSize == 0) {
+    return offsets;
+  }
+  for (const auto& region : regions) {
+    for (size_t i = 0; i < region.size / superpageSize; ++i) {
+      offsets.push_back(region.offset + i * superpageSize);
+    }
+  }
+  return offsets;
+}
+
+} // namespace roc
+} // namespace o2
@@ -0,0 +1,52 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file SuperpageCarver.h
+/// \brief Definition of the SuperpageCarver class.
+
+#ifndef O2_READOUTCARD_SRC_DMABUFFERPROVIDER_SUPERPAGECARVER_H_
+#define O2_READOUTCARD_SRC_DMABUFFERPROVIDER_SUPERPAGECARVER_H_
+
+#include <cstddef>
+#include <vector>
+#include "DmaBufferProvider/DmaBufferProviderInterface.h"
+
+namespace o2
+{
+namespace roc
+{
+
+/// Finds where superpages can be placed in a DMA buffer so that each one is contiguous in the card's bus address
+/// space. Without the IOMMU, the scatter-gather list has an entry per hugepage, and a superpage straddling two entries
+/// that are not adjacent on the bus would be written partly to unrelated memory.
+class SuperpageCarver
+{
+ public:
+  /// A range of the buffer that is contiguous in bus address space
+  struct Region {
+    size_t offset;
+    size_t size;
+  };
+
+  /// Merges the scatter-gather entries of the buffer that are adjacent both in userspace and in bus address space
+  /// \return The contiguous ranges of the buffer, ordered by offset
+  static std::vector<Region> getContiguousRegions(const DmaBufferProviderInterface& buffer);
+
+  /// Places as many superpages as possible in the regions, none of them straddling two regions
+  /// \param regions Contiguous ranges of the buffer, ordered by offset
+  /// \param superpageSize Size of the superpages
+  /// \return The offsets of the superpages, in increasing order
+  static std::vector<size_t> carve(const std::vector<Region>& regions, size_t superpageSize);
+};
+
+} // namespace roc
+} // namespace o2
+
+#endif // O2_READOUTCARD_SRC_DMABUFFERPROVIDER_SUPERPAGECARVER_H_
@@ -17,9 +17,14 @@
 
 #include <boost/filesystem.hpp>
 #include "DmaChannelBase.h"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <sys/eventfd.h>
+#include <unistd.h>
 //#include "ChannelPaths.h"
 #include "Common/System.h"
+#include "DmaBufferProvider/SuperpageCarver.h"
 #include "Pda/Util.h"
 #include "ReadoutCard/FirmwareChecker.h"
 #include "Utilities/SmartPointer.h"
@@ -52,7 +57,10 @@ void DmaChannelBase::checkParameters(Parameters& /*parameters*/) //TODO: Possibl
 
 DmaChannelBase::DmaChannelBase(CardDescriptor cardDescriptor, Parameters& parameters,
                                const AllowedChannels& allowedChannels)
-  : mCardDescriptor(cardDescriptor), mChannelNumber(parameters.getChannelNumberRequired())
+  : mCardDescriptor(cardDescriptor),
+    mChannelNumber(parameters.getChannelNumberRequired()),
+    mReadyWaitPolicy(parameters.getReadyWaitPolicy().get_value_or(WaitPolicy{})),
+    mSuperpageTimestampEnabled(parameters.getSuperpageTimestampEnabled().get_value_or(false))
 {
   mLoggerPrefix = "[" + mCardDescriptor.serialId.toString() + " | ch" + std::to_string(mChannelNumber) + "] ";
   Logger::setFacility("ReadoutCard/DMA");
@@ -63,40 +71,188 @@ DmaChannelBase::DmaChannelBase(CardDescriptor cardDescriptor, Parameters& parame
   // Check the channel number is allowed
   checkChannelNumber(allowedChannels);
 
-  // Check that the firmware is compatible with the software
-  auto parameters2 = parameters;
-  parameters2.setChannelNumber(2);
-  if (parameters.getFirmwareCheckEnabled().get_value_or(true)) {
-    FirmwareChecker().checkFirmwareCompatibility(parameters2);
-  }
+  if (isEmulated()) {
+    // There is no card to check, lock or free buffers of
+    log("Using the software emulator", LogInfoDevel_(4223));
+  } else {
+    // Check that the firmware is compatible with the software
+    auto parameters2 = parameters;
+    parameters2.setChannelNumber(2);
+    if (parameters.getFirmwareCheckEnabled().get_value_or(true)) {
+      FirmwareChecker().checkFirmwareCompatibility(parameters2);
+    }
 
-  // Do some basic Parameters validity checks
-  //checkParameters(parameters);
+    // Do some basic Parameters validity checks
+    //checkParameters(parameters);
 
-  //try to acquire lock
-  log("Acquiring DMA channel lock", LogInfoDevel_(4201));
-  try {
-    if (mCardDescriptor.cardType == CardType::Crorc) {
-      Utilities::resetSmartPtr(mInterprocessLock, "Alice_O2_RoC_DMA_" + cardDescriptor.pciAddress.toString() + "_chan" +
-                                                    std::to_string(mChannelNumber) + "_lock");
-    } else {
-      Utilities::resetSmartPtr(mInterprocessLock, "Alice_O2_RoC_DMA_" + cardDescriptor.pciAddress.toString() + "_lock");
+    //try to acquire lock
+    log("Acquiring DMA channel lock", LogInfoDevel_(4201));
+    try {
+      if (mCardDescriptor.cardType == CardType::Crorc) {
+        Utilities::resetSmartPtr(mInterprocessLock, "Alice_O2_RoC_DMA_" + cardDescriptor.pciAddress.toString() + "_chan" +
+                                                      std::to_string(mChannelNumber) + "_lock");
+      } else {
+        Utilities::resetSmartPtr(mInterprocessLock, "Alice_O2_RoC_DMA_" + cardDescriptor.pciAddress.toString() + "_lock");
+      }
+    } catch (const LockException& exception) {
+      log("Failed to acquire DMA channel lock", LogErrorDevel_(4202));
+      throw;
     }
-  } catch (const LockException& exception) {
-    log("Failed to acquire DMA channel lock", LogErrorDevel_(4202));
-    throw;
+
+    log("Acquired DMA channel lock", LogInfoDevel_(4203));
+    Pda::freePdaDmaBuffers(mCardDescriptor, getChannelNumber());
   }
 
-  log("Acquired DMA channel lock", LogInfoDevel_(4203));
-  Pda::freePdaDmaBuffers(mCardDescriptor, getChannelNumber());
+  if (parameters.getReadyEventFdEnabled().get_value_or(false)) {
+    mReadyEventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (mReadyEventFd < 0) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(getLoggerPrefix() + "Failed to create ready eventfd: " + strerror(errno)));
+    }
+  }
 }
 
 DmaChannelBase::~DmaChannelBase()
 {
-  Pda::freePdaDmaBuffers(mCardDescriptor, getChannelNumber());
+  if (mReadyEventFd >= 0) {
+    close(mReadyEventFd);
+  }
+  if (isEmulated()) {
+    return;
+  }
+  if (mKeepPdaBuffersOnClose) {
+    log("Not freeing the PDA buffers, the buffer registration is still used by other channels", LogInfoDevel_(4264));
+  } else {
+    Pda::freePdaDmaBuffers(mCardDescriptor, getChannelNumber());
+  }
   log("Releasing DMA channel lock", LogInfoDevel_(4204));
 }
 
+bool DmaChannelBase::waitForReady(std::chrono::microseconds timeout)
+{
+  if (getReadyQueueSize() > 0) {
+    return true;
+  }
+
+  // Counters are only written from this thread
+  using Utilities::Backoff;
+  bool ready = Utilities::pollWithBackoff(
+    mReadyWaitPolicy, timeout,
+    [&] {
+      fillSuperpages();
+      return getReadyQueueSize() > 0;
+    },
+    [&](const Backoff::Step* step) {
+      Utilities::addRelaxed(mPollCounters.emptyPolls);
+      if (!step) {
+        Utilities::addRelaxed(mPollCounters.timeouts);
+      } else if (*step == Backoff::Step::Sleep) {
+        Utilities::addRelaxed(mPollCounters.sleeps);
+      } else if (*step == Backoff::Step::Yield) {
+        Utilities::addRelaxed(mPollCounters.yields);
+      }
+    });
+  if (ready) {
+    Utilities::addRelaxed(mPollCounters.productivePolls);
+  }
+  return ready;
+}
+
+int DmaChannelBase::getReadyEventFd()
+{
+  return mReadyEventFd;
+}
+
+PollStatistics DmaChannelBase::getPollStatistics()
+{
+  PollStatistics statistics;
+  statistics.productivePolls = mPollCounters.productivePolls.load(std::memory_order_relaxed);
+  statistics.emptyPolls = mPollCounters.emptyPolls.load(std::memory_order_relaxed);
+  statistics.yields = mPollCounters.yields.load(std::memory_order_relaxed);
+  statistics.sleeps = mPollCounters.sleeps.load(std::memory_order_relaxed);
+  statistics.timeouts = mPollCounters.timeouts.load(std::memory_order_relaxed);
+  statistics.superpagesReady = mPollCounters.superpagesReady.load(std::memory_order_relaxed);
+  statistics.registerReads = mPollCounters.registerReads.load(std::memory_order_relaxed);
+  statistics.indexLags = mPollCounters.indexLags.load(std::memory_order_relaxed);
+  return statistics;
+}
+
+void DmaChannelBase::notifyReady(uint64_t superpages)
+{
+  Utilities::addRelaxed(mPollCounters.superpagesReady, superpages);
+
+  if (mReadyEventFd >= 0 && superpages > 0) {
+    // Can only fail if the counter would overflow, in which case it is readable anyway
+    auto written = write(mReadyEventFd, &superpages, sizeof(superpages));
+    (void)written;
+  }
+}
+
+void DmaChannelBase::countRegisterReads(uint64_t reads, uint64_t indexLags)
+{
+  Utilities::addRelaxed(mPollCounters.registerReads, reads);
+  Utilities::addRelaxed(mPollCounters.indexLags, indexLags);
+}
+
+DmaChannelStatistics DmaChannelBase::getStatistics()
+{
+  DmaChannelStatistics statistics;
+  {
+    std::lock_guard<std::mutex> lock(mLinkCountersMutex);
+    for (const auto& counters : mLinkCounters) {
+      statistics.links.push_back(counters->get());
+      statistics.superpagesInFirmware += statistics.links.back().superpagesInFirmware;
+    }
+  }
+  statistics.bufferSize = getDmaBufferSize();
+  statistics.bytesPopped = mUserCounters.bytesPopped.load(std::memory_order_relaxed);
+  statistics.bytesPushed = mUserCounters.bytesPushed.load(std::memory_order_relaxed);
+  statistics.superpagesReady = std::max(getReadyQueueSize(), 0);
+  return statistics;
+}
+
+std::vector<size_t> DmaChannelBase::getSuperpageOffsets(size_t superpageSize)
+{
+  return SuperpageCarver::carve({ SuperpageCarver::Region{ 0, getDmaBufferSize() } }, superpageSize);
+}
+
+void DmaChannelBase::initializeLinkCounters(const std::vector<uint32_t>& linkIds, size_t firmwareCapacity)
+{
+  for (auto id : linkIds) {
+    mLinkCounters.push_back(std::make_unique<LinkCounters>(id, firmwareCapacity));
+  }
+}
+
+void DmaChannelBase::updateLinkCounters(const std::vector<uint32_t>& linkIds, size_t firmwareCapacity)
+{
+  std::lock_guard<std::mutex> lock(mLinkCountersMutex);
+  std::vector<std::unique_ptr<LinkCounters>> counters;
+  for (auto id : linkIds) {
+    auto found = std::find_if(mLinkCounters.begin(), mLinkCounters.end(),
+                              [&](const auto& existing) { return existing && existing->getLinkId() == id; });
+    if (found != mLinkCounters.end()) {
+      counters.push_back(std::move(*found));
+    } else {
+      counters.push_back(std::make_unique<LinkCounters>(id, firmwareCapacity));
+    }
+  }
+  mLinkCounters = std::move(counters);
+}
+
+void DmaChannelBase::addLink(uint32_t)
+{
+  BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(getLoggerPrefix() + "Adding a link is only supported by the CRU"));
+}
+
+void DmaChannelBase::removeLink(uint32_t)
+{
+  BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(getLoggerPrefix() + "Removing a link is only supported by the CRU"));
+}
+
+void DmaChannelBase::refreshLinks()
+{
+  BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(getLoggerPrefix() + "Refreshing the links is only supported by the CRU"));
+}
+
 void DmaChannelBase::log(const std::string& logMessage, ILMessageOption ilgMsgOption)
 {
   Logger::get() << mLoggerPrefix << logMessage << ilgMsgOption << endm;
@@ -17,6 +17,8 @@
 #ifndef O2_READOUTCARD_SRC_DMACHANNELBASE_H_
 #define O2_READOUTCARD_SRC_DMACHANNELBASE_H_
 
+#include <atomic>
+#include <chrono>
 #include <set>
 #include <vector>
 #include <memory>
@@ -24,6 +26,7 @@
 #include <boost/optional.hpp>
 #include "ChannelPaths.h"
 #include "ExceptionInternal.h"
+#include "LinkCounters.h"
 #include "Pda/PdaLock.h"
 #include "ReadoutCard/CardDescriptor.h"
 #include "ReadoutCard/DmaChannelInterface.h"
@@ -31,6 +34,7 @@
 #include "ReadoutCard/Logger.h"
 #include "ReadoutCard/InterprocessLock.h"
 #include "ReadoutCard/Parameters.h"
+#include "Utilities/Polling.h"
 #include "Utilities/Util.h"
 
 namespace o2
@@ -73,6 +77,21 @@ class DmaChannelBase : public DmaChannelInterface
     return {};
   }
 
+  /// Default implementation for function only supported by the CRU
+  virtual void addLink(uint32_t linkId) override;
+
+  /// Default implementation for function only supported by the CRU
+  virtual void removeLink(uint32_t linkId) override;
+
+  /// Default implementation for function only supported by the CRU
+  virtual void refreshLinks() override;
+
+  virtual bool waitForReady(std::chrono::microseconds timeout) override;
+  virtual int getReadyEventFd() override;
+  virtual PollStatistics getPollStatistics() override;
+  virtual DmaChannelStatistics getStatistics() override;
+  virtual std::vector<size_t> getSuperpageOffsets(size_t superpageSize) override;
+
  protected:
   /// Namespace for enum describing the initialization state of the shared data
   struct InitializationState {
@@ -103,6 +122,12 @@ class DmaChannelBase : public DmaChannelInterface
     return mCardDescriptor;
   }
 
+  /// Whether the channel is the software emulator, selected with the dummy serial ID
+  bool isEmulated() const
+  {
+    return mCardDescriptor.serialId.getSerial() == SERIAL_DUMMY;
+  }
+
   ChannelPaths getPaths()
   {
     return { getCardDescriptor().pciAddress, getChannelNumber() };
@@ -111,6 +136,82 @@ class DmaChannelBase : public DmaChannelInterface
   /// Convenience function for InfoLogger
   void log(const std::string& logMessage, ILMessageOption = LogInfoDevel);
 
+  /// Signals the ready eventfd, if enabled, that superpages were moved to the ready queue
+  void notifyReady(uint64_t superpages);
+
+  /// Adds to the BAR read accesses reported by getPollStatistics(). To be called only by the thread doing the driver
+  /// work.
+  void countRegisterReads(uint64_t reads, uint64_t indexLags = 0);
+
+  /// Creates the counters behind the per-link statistics of getStatistics(). To be called by the constructor.
+  /// \param linkIds IDs of the links, in the order of getDataTakingLinks()
+  /// \param firmwareCapacity Most superpages that can be pushed to the card on a link
+  void initializeLinkCounters(const std::vector<uint32_t>& linkIds, size_t firmwareCapacity);
+
+  /// Replaces the link counters when the links of the channel change. The counters of the links that remain are kept.
+  /// Must not be called while the driver work is running.
+  /// \param linkIds IDs of the links, in their new order
+  /// \param firmwareCapacity Most superpages that can be pushed to the card on a link
+  void updateLinkCounters(const std::vector<uint32_t>& linkIds, size_t firmwareCapacity);
+
+  /// Gets the counters of a link, to be updated only by the thread doing the driver work
+  /// \param index Index of the link given to initializeLinkCounters()
+  LinkCounters& getLinkCounters(size_t index)
+  {
+    return *mLinkCounters[index];
+  }
+
+  /// Counts the bytes of a superpage pushed by the user, for getStatistics(). To be called only by the user thread.
+  void countUserPush(const Superpage& superpage)
+  {
+    Utilities::addRelaxed(mUserCounters.bytesPushed, superpage.getSize());
+  }
+
+  /// Counts the bytes of superpages popped by the user, for getStatistics(). To be called only by the user thread.
+  void countUserPops(const Superpage* superpages, size_t count)
+  {
+    uint64_t bytes = 0;
+    for (size_t i = 0; i < count; ++i) {
+      bytes += superpages[i].getSize();
+    }
+    Utilities::addRelaxed(mUserCounters.bytesPopped, bytes);
+  }
+
+  /// Gets the size of the DMA buffer, reported by getStatistics(). The default getSuperpageOffsets() takes all of it
+  /// as contiguous.
+  virtual size_t getDmaBufferSize() const
+  {
+    return 0;
+  }
+
+  /// Current time in nanoseconds of the steady clock
+  static uint64_t getSteadyTime()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  const WaitPolicy& getReadyWaitPolicy() const
+  {
+    return mReadyWaitPolicy;
+  }
+
+  /// Keeps the PDA buffers of the channel from being freed when it is closed, because other channels of the process
+  /// still use the registration of its buffer. It is then deregistered by the last of them.
+  void keepPdaBuffersOnClose()
+  {
+    mKeepPdaBuffersOnClose = true;
+  }
+
+  /// Records the current time in a superpage found filled, if the SuperpageTimestampEnabled parameter is enabled
+  void stampArrivalTime(Superpage& superpage) const
+  {
+    if (mSuperpageTimestampEnabled) {
+      auto now = std::chrono::steady_clock::now().time_since_epoch();
+      // Wraps after over a year of uptime, which only matters to users comparing times across the wrap
+      superpage.setArrivalTime(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count() & Superpage::MAX_ARRIVAL_TIME);
+    }
+  }
+
  private:
   /// Check if the channel number is valid
   void checkChannelNumber(const AllowedChannels& allowedChannels);
@@ -127,6 +228,43 @@ class DmaChannelBase : public DmaChannelInterface
   /// Lock that guards against both inter- and intra-process ownership
   std::unique_ptr<Interprocess::Lock> mInterprocessLock;
 
+  /// Backoff policy of waitForReady()
+  const WaitPolicy mReadyWaitPolicy;
+
+  /// Record the arrival time of filled superpages
+  const bool mSuperpageTimestampEnabled;
+
+  /// eventfd signaled when superpages are moved to the ready queue, or -1 if not enabled
+  int mReadyEventFd = -1;
+
+  /// Do not free the PDA buffers of the channel when it is closed, see keepPdaBuffersOnClose()
+  bool mKeepPdaBuffersOnClose = false;
+
+  /// Counters behind getPollStatistics(). Each has a single writer: the thread calling waitForReady(), or the one
+  /// doing the driver work.
+  struct {
+    std::atomic<uint64_t> productivePolls{ 0 };
+    std::atomic<uint64_t> emptyPolls{ 0 };
+    std::atomic<uint64_t> yields{ 0 };
+    std::atomic<uint64_t> sleeps{ 0 };
+    std::atomic<uint64_t> timeouts{ 0 };
+    std::atomic<uint64_t> superpagesReady{ 0 };
+    std::atomic<uint64_t> registerReads{ 0 };
+    std::atomic<uint64_t> indexLags{ 0 };
+  } mPollCounters;
+
+  /// Counters of the superpages pushed and popped by the user, behind getStatistics(). Single writer: the user thread.
+  struct {
+    std::atomic<uint64_t> bytesPushed{ 0 };
+    std::atomic<uint64_t> bytesPopped{ 0 };
+  } mUserCounters;
+
+  /// Counters of the links, behind getStatistics()
+  std::vector<std::unique_ptr<LinkCounters>> mLinkCounters;
+
+  /// Guards mLinkCounters against updateLinkCounters() while getStatistics() reads it from another thread
+  std::mutex mLinkCountersMutex;
+
   protected:
   std::string mLoggerPrefix;
 
@@ -16,6 +16,7 @@
 
 #include "DmaChannelPdaBase.h"
 #include <boost/filesystem/path.hpp>
+#include <boost/format.hpp>
 #include "Common/Iommu.h"
 #include "Utilities/MemoryMaps.h"
 #include "Utilities/Numa.h"
@@ -24,6 +25,7 @@
 #include "DmaBufferProvider/PdaDmaBufferProvider.h"
 #include "DmaBufferProvider/FilePdaDmaBufferProvider.h"
 #include "DmaBufferProvider/NullDmaBufferProvider.h"
+#include "DmaBufferProvider/SuperpageCarver.h"
 #include "ReadoutCard/ParameterTypes/SerialId.h"
 #include "Visitor.h"
 
@@ -43,7 +45,9 @@ CardDescriptor createCardDescriptor(const Parameters& parameters)
 
 DmaChannelPdaBase::DmaChannelPdaBase(const Parameters& parameters,
                                      const AllowedChannels& allowedChannels)
-  : DmaChannelBase(createCardDescriptor(parameters), const_cast<Parameters&>(parameters), allowedChannels), mDmaState(DmaState::STOPPED)
+  : DmaChannelBase(createCardDescriptor(parameters), const_cast<Parameters&>(parameters), allowedChannels),
+    mDmaState(DmaState::STOPPED),
+    mDriverThreadEnabled(parameters.getDriverThreadEnabled().get_value_or(false))
 {
   // Initialize PDA & DMA objects
   Utilities::resetSmartPtr(mRocPciDevice, getCardDescriptor().pciAddress);
@@ -120,10 +124,24 @@ DmaChannelPdaBase::DmaChannelPdaBase(const Parameters& parameters,
       log("Failed to check if buffer is hugepage-backed", LogDebugTrace_(4212));
     }
   }
+
+  // Choose the CPU of the driver thread: by default the last one of the card's NUMA node
+  if (mDriverThreadEnabled) {
+    if (auto cpu = parameters.getDriverThreadCpu()) {
+      mDriverThreadCpu = *cpu;
+    } else {
+      auto cpus = Utilities::getNumaNodeCpus(getNumaNode());
+      mDriverThreadCpu = cpus.empty() ? -1 : cpus.back();
+    }
+  }
 }
 
 DmaChannelPdaBase::~DmaChannelPdaBase()
 {
+  // Freeing the buffers by ID would tear down a registration other channels still do DMA into
+  if (mBufferProvider && mBufferProvider->isRegistrationShared()) {
+    keepPdaBuffersOnClose();
+  }
 }
 
 // Checks DMA state and forwards call to subclass if necessary
@@ -136,6 +154,9 @@ void DmaChannelPdaBase::startDma()
   } else {
     log("Starting DMA", LogInfoDevel_(4215));
     deviceStartDma();
+    if (mDriverThreadEnabled) {
+      startDriverThread();
+    }
   }
   mDmaState = DmaState::STARTED;
 }
@@ -151,10 +172,62 @@ void DmaChannelPdaBase::stopDma()
   } else {
     log("Stopping DMA", LogInfoDevel_(4218));
     mDmaState = DmaState::STOPPED;
+    std::exception_ptr driverException;
+    if (mDriverThread) {
+      driverException = mDriverThread->stop();
+      mDriverThread.reset();
+    }
     deviceStopDma();
+    if (driverException) {
+      std::rethrow_exception(driverException);
+    }
   }
 }
 
+void DmaChannelPdaBase::fillSuperpages()
+{
+  // With the driver thread enabled, this is done by the thread
+  if (!mDriverThreadEnabled) {
+    deviceFillSuperpages();
+  }
+}
+
+void DmaChannelPdaBase::startDriverThread()
+{
+  mDriverThread = std::make_unique<DriverThread>([this] { return deviceFillSuperpages() > 0; },
+                                                 getReadyWaitPolicy(), mDriverThreadCpu, getLoggerPrefix());
+}
+
+void DmaChannelPdaBase::stopDriverThread()
+{
+  if (mDriverThread) {
+    mDriverThread->stop();
+    mDriverThread.reset();
+  }
+}
+
+void DmaChannelPdaBase::runWithDriverThreadStopped(const std::function<void()>& function)
+{
+  if (!mDriverThread) {
+    function();
+    return;
+  }
+
+  auto driverException = mDriverThread->stop();
+  mDriverThread.reset();
+  if (driverException) {
+    std::rethrow_exception(driverException);
+  }
+
+  try {
+    function();
+  } catch (...) {
+    startDriverThread();
+    throw;
+  }
+  startDriverThread();
+}
+
 void DmaChannelPdaBase::resetChannel(ResetLevel::type resetLevel)
 {
   if (mDmaState == DmaState::UNKNOWN) {
@@ -175,24 +248,29 @@ uintptr_t DmaChannelPdaBase::getBusOffsetAddress(size_t offset)
 
 void DmaChannelPdaBase::checkSuperpage(const Superpage& superpage)
 {
-  if (superpage.getSize() == 0) {
-    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not enqueue superpage, size == 0"));
-  }
-
-  if (!Utilities::isMultiple(superpage.getSize(), size_t(32 * 1024))) {
-    BOOST_THROW_EXCEPTION(Exception()
-                          << ErrorInfo::Message("Could not enqueue superpage, size not a multiple of 32 KiB"));
+  if (auto error = getSuperpageError(superpage, getBufferProvider().getSize())) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(std::string("Could not enqueue superpage, ") + error));
   }
+}
 
-  if ((superpage.getOffset() + superpage.getSize()) > getBufferProvider().getSize()) {
-    BOOST_THROW_EXCEPTION(Exception()
-                          << ErrorInfo::Message("Superpage out of range"));
-  }
+bool DmaChannelPdaBase::isSuperpageValid(const Superpage& superpage) const
+{
+  return getSuperpageError(superpage, getBufferProvider().getSize()) == nullptr;
+}
 
-  if ((superpage.getOffset() % 4) != 0) {
-    BOOST_THROW_EXCEPTION(Exception()
-                          << ErrorInfo::Message("Superpage offset not 32-bit aligned"));
+std::vector<size_t> DmaChannelPdaBase::getSuperpageOffsets(size_t superpageSize)
+{
+  auto offsets = SuperpageCarver::carve(SuperpageCarver::getContiguousRegions(getBufferProvider()), superpageSize);
+  const size_t bufferSize = getBufferProvider().getSize();
+  if (superpageSize > 0 && offsets.size() < bufferSize / superpageSize) {
+    const size_t unused = bufferSize - offsets.size() * superpageSize;
+    log((boost::format("Buffer not contiguous in bus address space: %1% superpages of %2% bytes fit, %3% bytes (%4$.1f%%) of "
+                "the buffer are left unused") %
+         offsets.size() % superpageSize % unused % (100.0 * unused / bufferSize))
+          .str(),
+        LogWarningDevel_(4224));
   }
+  return offsets;
 }
 
 PciAddress DmaChannelPdaBase::getPciAddress()
@@ -20,6 +20,7 @@
 #include <boost/scoped_ptr.hpp>
 #include "DmaBufferProvider/DmaBufferProviderInterface.h"
 #include "DmaChannelBase.h"
+#include "DriverThread.h"
 #include "Pda/PdaBar.h"
 #include "Pda/PdaDmaBuffer.h"
 #include "ReadoutCard/DmaChannelInterface.h"
@@ -27,6 +28,7 @@
 #include "ReadoutCard/MemoryMappedFile.h"
 #include "ReadoutCard/Parameters.h"
 #include "RocPciDevice.h"
+#include "SuperpageQueue.h"
 
 namespace o2
 {
@@ -49,9 +51,11 @@ class DmaChannelPdaBase : public DmaChannelBase
 
   virtual void startDma() final override;
   virtual void stopDma() final override;
+  virtual void fillSuperpages() final override;
   void resetChannel(ResetLevel::type resetLevel) final override;
   virtual PciAddress getPciAddress() final override;
   virtual int getNumaNode() final override;
+  virtual std::vector<size_t> getSuperpageOffsets(size_t superpageSize) final override;
 
  protected:
   /// Maximum amount of PDA DMA buffers for channel FIFOs (1 per channel, so this also represents the max amount of
@@ -92,6 +96,9 @@ class DmaChannelPdaBase : public DmaChannelBase
   /// Perform some basic checks on a superpage
   void checkSuperpage(const Superpage& superpage);
 
+  /// Non-throwing variant of checkSuperpage()
+  bool isSuperpageValid(const Superpage& superpage) const;
+
   /// Template method called by startDma() to do device-specific (CRORC, RCU...) actions
   virtual void deviceStartDma() = 0;
 
@@ -101,6 +108,27 @@ class DmaChannelPdaBase : public DmaChannelBase
   /// Template method called by resetChannel() to do device-specific (CRORC, RCU...) actions
   virtual void deviceResetChannel(ResetLevel::type resetLevel) = 0;
 
+  /// Template method called by fillSuperpages(), or by the driver thread if it is enabled, to do the device-specific
+  /// driver work
+  /// \return The number of superpages moved to the ready queue
+  virtual size_t deviceFillSuperpages() = 0;
+
+  /// Whether the driver thread is enabled. If so, deviceFillSuperpages() runs in the driver thread while DMA is
+  /// started, and must only interact with the user thread through lock-free queues.
+  bool isDriverThreadEnabled() const
+  {
+    return mDriverThreadEnabled;
+  }
+
+  /// Stops the driver thread, if it is running. To be called by subclass destructors, so that the thread does not
+  /// call deviceFillSuperpages() on a partially destroyed object.
+  void stopDriverThread();
+
+  /// Runs a function with the driver thread stopped, if it is running, and restarts the thread after. To change, from
+  /// the user thread, the state that deviceFillSuperpages() works on while DMA is started.
+  /// Rethrows the exception that ended the driver thread early, if any, in which case the thread is not restarted.
+  void runWithDriverThreadStopped(const std::function<void()>& function);
+
   /// Function for getting the bus address that corresponds to the user address + given offset
   uintptr_t getBusOffsetAddress(size_t offset);
 
@@ -109,6 +137,11 @@ class DmaChannelPdaBase : public DmaChannelBase
     return *(mBufferProvider.get());
   }
 
+  virtual size_t getDmaBufferSize() const override
+  {
+    return mBufferProvider->getSize();
+  }
+
   const RocPciDevice& getRocPciDevice() const
   {
     return *(mRocPciDevice.get());
@@ -124,6 +157,17 @@ class DmaChannelPdaBase : public DmaChannelBase
 
   /// PDA device objects
   boost::scoped_ptr<RocPciDevice> mRocPciDevice;
+
+  /// Run an internal driver thread while DMA is started
+  const bool mDriverThreadEnabled;
+
+  /// CPU to pin the driver thread to, or -1
+  int mDriverThreadCpu = -1;
+
+  /// The driver thread, while DMA is started
+  std::unique_ptr<DriverThread> mDriverThread;
+
+  void startDriverThread();
 };
 
 } // namespace roc
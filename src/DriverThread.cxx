@@ -0,0 +1,87 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file DriverThread.cxx
+/// \brief Implementation of the DriverThread class.
+
+#include "DriverThread.h"
+#include <cstring>
+#include <pthread.h>
+#include <boost/exception/diagnostic_information.hpp>
+#include "ReadoutCard/Logger.h"
+#include "Utilities/Polling.h"
+
+namespace o2
+{
+namespace roc
+{
+
+DriverThread::DriverThread(PollFunction poll, WaitPolicy waitPolicy, int cpu, std::string loggerPrefix)
+  : mPoll(std::move(poll)), mWaitPolicy(waitPolicy), mCpu(cpu), mLoggerPrefix(std::move(loggerPrefix))
+{
+  mThread = std::thread([this] { run(); });
+  pthread_setname_np(mThread.native_handle(), "roc-driver");
+}
+
+DriverThread::~DriverThread()
+{
+  stop();
+}
+
+std::exception_ptr DriverThread::stop()
+{
+  mStop = true;
+  if (mThread.joinable()) {
+    mThread.join();
+  }
+  return mException;
+}
+
+void DriverThread::pin()
+{
+  if (mCpu >= 0) {
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(mCpu, &cpuSet);
+    int error = pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+    if (error != 0) {
+      Logger::get() << mLoggerPrefix << "Failed to pin driver thread to CPU " << mCpu << ": " << strerror(error)
+                    << LogWarningDevel_(4221) << endm;
+    } else {
+      Logger::get() << mLoggerPrefix << "Driver thread pinned to CPU " << mCpu << LogInfoDevel_(4220) << endm;
+    }
+  } else {
+    Logger::get() << mLoggerPrefix << "Driver thread started, not pinned to a CPU" << LogInfoDevel_(4220) << endm;
+  }
+}
+
+void DriverThread::run()
+{
+  // Pinned before the first poll, so that its work and allocations happen on the chosen CPU's NUMA node
+  pin();
+
+  try {
+    Utilities::Backoff backoff(mWaitPolicy);
+    while (!mStop.load(std::memory_order_relaxed)) {
+      if (mPoll()) {
+        backoff.reset();
+        continue;
+      }
+      backoff.wait();
+    }
+  } catch (const std::exception& exception) {
+    mException = std::current_exception();
+    Logger::get() << mLoggerPrefix << "Driver thread stopped by exception: " << boost::diagnostic_information(exception)
+                  << LogErrorDevel_(4222) << endm;
+  }
+}
+
+} // namespace roc
+} // namespace o2
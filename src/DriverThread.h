@@ -0,0 +1,70 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file DriverThread.h
+/// \brief Definition of the DriverThread class.
+
+#ifndef O2_READOUTCARD_SRC_DRIVERTHREAD_H_
+#define O2_READOUTCARD_SRC_DRIVERTHREAD_H_
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <string>
+#include <thread>
+#include "ReadoutCard/ParameterTypes/WaitPolicy.h"
+
+namespace o2
+{
+namespace roc
+{
+
+/// Thread that repeatedly calls a DMA channel's driver function, backing off with a WaitPolicy while it finds no
+/// work. It may be pinned to a CPU.
+class DriverThread
+{
+ public:
+  /// Function doing one iteration of driver work
+  /// \return True if any superpage was handled
+  using PollFunction = std::function<bool()>;
+
+  /// Starts the thread
+  /// \param poll Function doing one iteration of driver work
+  /// \param waitPolicy Backoff policy used while polls are unproductive
+  /// \param cpu CPU to pin the thread to, or -1 to leave it unpinned
+  /// \param loggerPrefix Prefix for log messages
+  DriverThread(PollFunction poll, WaitPolicy waitPolicy, int cpu, std::string loggerPrefix);
+
+  /// Stops the thread if it was not stopped yet
+  ~DriverThread();
+
+  /// Stops the thread and waits for it to finish
+  /// \return The exception that ended the thread early, or a null pointer if there was none
+  std::exception_ptr stop();
+
+ private:
+  /// Pins the calling thread to mCpu, if any
+  void pin();
+
+  void run();
+
+  PollFunction mPoll;
+  const WaitPolicy mWaitPolicy;
+  const int mCpu;
+  const std::string mLoggerPrefix;
+  std::atomic<bool> mStop{ false };
+  std::exception_ptr mException;
+  std::thread mThread;
+};
+
+} // namespace roc
+} // namespace o2
+
+#endif // O2_READOUTCARD_SRC_DRIVERTHREAD_H_
@@ -0,0 +1,151 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file EmulatorDmaChannel.cxx
+/// \brief Implementation of the EmulatorDmaChannel class.
+
+#include "Emulator/EmulatorDmaChannel.h"
+#include <algorithm>
+#include <cstring>
+#include "Cru/Constants.h"
+#include "DataFormat.h"
+#include "ExceptionInternal.h"
+
+namespace o2
+{
+namespace roc
+{
+
+namespace
+{
+/// RDH trigger type bit marking the start of the run
+constexpr uint32_t TRIGGER_SOX = 1 << 9;
+} // namespace
+
+EmulatorDmaChannel::EmulatorDmaChannel(const Parameters& parameters)
+  : EmulatorDmaChannelBase(parameters),
+    mDataSource(parameters.getDataSource().get_value_or(DataSource::Internal)),
+    mDmaPageSize(parameters.getDmaPageSize().get_value_or(Cru::DMA_PAGE_SIZE)),
+    mDataRate(parameters.getEmulatorDataRate().get_value_or(0))
+{
+  if (mDataSource == DataSource::Diu || mDataSource == DataSource::Siu) {
+    BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message(getLoggerPrefix() + "Emulator does not support specified data source")
+                                               << ErrorInfo::DataSource(mDataSource));
+  }
+
+  // Pages must hold at least an RDH, and their size must fit in its 16-bit offset field
+  if (mDmaPageSize < DataFormat::getHeaderSize() || (mDmaPageSize % 32) != 0 ||
+      (mDataSource != DataSource::Internal && mDmaPageSize > 0xffff)) {
+    BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message(getLoggerPrefix() + "Emulator does not support specified DMA page size")
+                                               << ErrorInfo::DmaPageSize(mDmaPageSize));
+  }
+
+  auto linkMask = parameters.getLinkMask().get_value_or(std::set<uint32_t>{ 0 });
+  for (auto id : linkMask) {
+    if (id >= Cru::MAX_LINKS) {
+      BOOST_THROW_EXCEPTION(InvalidLinkId() << ErrorInfo::Message(getLoggerPrefix() + "Link ID out of range")
+                                            << ErrorInfo::LinkId(id));
+    }
+    LinkState link;
+    link.id = id;
+    mLinkStates.push_back(link);
+  }
+  initializeLinks(linkMask);
+}
+
+EmulatorDmaChannel::~EmulatorDmaChannel()
+{
+  stopGenerator();
+}
+
+void EmulatorDmaChannel::resetGenerator()
+{
+  for (auto& link : mLinkStates) {
+    link.packetCounter = 0;
+    link.dataCounter = 0;
+    link.startOfRun = true;
+  }
+  mInternalCounter = 0;
+  mNextFillTime = std::chrono::steady_clock::now();
+}
+
+bool EmulatorDmaChannel::fillSuperpage(size_t linkIndex, Superpage& superpage)
+{
+  auto now = std::chrono::steady_clock::now();
+  if (mDataRate > 0 && now < mNextFillTime) {
+    return false;
+  }
+
+  const size_t pages = superpage.getSize() / mDmaPageSize;
+  auto superpageAddress = getSuperpageAddress(superpage);
+  for (size_t i = 0; i < pages; ++i) {
+    char* page = superpageAddress + i * mDmaPageSize;
+    if (mDataSource == DataSource::Internal) {
+      fillPageInternal(page);
+    } else {
+      fillPageRdh(mLinkStates[linkIndex], page);
+    }
+  }
+
+  if (pages > 0 && takeInjectedError()) {
+    // Corrupt the first word of the payload
+    superpageAddress[mDataSource == DataSource::Internal ? 0 : DataFormat::getHeaderSize()] ^= 0x1;
+  }
+  superpage.setReceived(pages * mDmaPageSize);
+
+  if (mDataRate > 0) {
+    // Do not catch up on time spent idle, that would exceed the rate
+    auto fillTime = std::chrono::nanoseconds(superpage.getSize() * 1000000000ull / mDataRate);
+    mNextFillTime = std::max(mNextFillTime, now - fillTime) + fillTime;
+  }
+  return true;
+}
+
+void EmulatorDmaChannel::fillPageInternal(char* page)
+{
+  // CRU internal generator pattern: the counter, incremented every 256-bit word, repeated over the whole word
+  auto words = reinterpret_cast<uint32_t*>(page);
+  for (size_t i = 0; i < mDmaPageSize / sizeof(uint32_t); i += 8) {
+    mInternalCounter++;
+    std::fill_n(&words[i], 8, mInternalCounter);
+  }
+}
+
+void EmulatorDmaChannel::fillPageRdh(LinkState& link, char* page)
+{
+  std::memset(page, 0, DataFormat::getHeaderSize());
+  DataFormat::setOffset(page, mDmaPageSize);
+  DataFormat::setMemsize(page, mDmaPageSize);
+  DataFormat::setLinkId(page, link.id);
+  DataFormat::setPacketCounter(page, link.packetCounter);
+  link.packetCounter = (link.packetCounter + 1) % 256;
+  if (link.startOfRun) {
+    DataFormat::setTriggerType(page, TRIGGER_SOX);
+    link.startOfRun = false;
+  }
+
+  // DDG pattern: every 128 bits hold the counter twice, its lower 16 bits, and a zero word
+  auto words = reinterpret_cast<uint32_t*>(page + DataFormat::getHeaderSize());
+  for (size_t i = 0; i < (mDmaPageSize - DataFormat::getHeaderSize()) / sizeof(uint32_t); i += 4) {
+    words[i + 0] = link.dataCounter;
+    words[i + 1] = link.dataCounter;
+    words[i + 2] = link.dataCounter & 0xffff;
+    words[i + 3] = 0;
+    link.dataCounter++;
+  }
+}
+
+boost::optional<std::string> EmulatorDmaChannel::getFirmwareInfo()
+{
+  return std::string("emulator");
+}
+
+} // namespace roc
+} // namespace o2
@@ -0,0 +1,70 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file EmulatorDmaChannel.h
+/// \brief Definition of the EmulatorDmaChannel class.
+
+#ifndef O2_READOUTCARD_SRC_EMULATOR_EMULATORDMACHANNEL_H_
+#define O2_READOUTCARD_SRC_EMULATOR_EMULATORDMACHANNEL_H_
+
+#include <chrono>
+#include <vector>
+#include "Emulator/EmulatorDmaChannelBase.h"
+
+namespace o2
+{
+namespace roc
+{
+
+/// Software emulation of a CRU DMA channel, for benchmarking and testing without a card. It is selected with the dummy
+/// serial ID (-1).
+///
+/// A generator thread fills the superpages pushed by the user with DMA pages, for each link of the LinkMask parameter,
+/// at the rate given by the EmulatorDataRate parameter. With the Internal data source, the pages hold the CRU internal
+/// generator pattern; with the other data sources, they start with an RDH followed by the DDG pattern.
+class EmulatorDmaChannel final : public EmulatorDmaChannelBase
+{
+ public:
+  EmulatorDmaChannel(const Parameters& parameters);
+  virtual ~EmulatorDmaChannel() override;
+
+  virtual boost::optional<std::string> getFirmwareInfo() override;
+
+ protected:
+  virtual void resetGenerator() override;
+  virtual bool fillSuperpage(size_t linkIndex, Superpage& superpage) override;
+
+ private:
+  /// Generator state of a link
+  struct LinkState {
+    uint32_t id = 0;
+    uint32_t packetCounter = 0;
+    uint32_t dataCounter = 0;
+    bool startOfRun = true;
+  };
+
+  void fillPageInternal(char* page);
+  void fillPageRdh(LinkState& link, char* page);
+
+  const DataSource::type mDataSource;
+  const size_t mDmaPageSize;
+  /// Bytes per second generated over all links, 0 for no limit
+  const size_t mDataRate;
+
+  /// Generator state, only accessed by the generator thread
+  std::vector<LinkState> mLinkStates;
+  uint32_t mInternalCounter = 0;
+  std::chrono::steady_clock::time_point mNextFillTime;
+};
+
+} // namespace roc
+} // namespace o2
+
+#endif // O2_READOUTCARD_SRC_EMULATOR_EMULATORDMACHANNEL_H_
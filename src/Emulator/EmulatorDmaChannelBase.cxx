@@ -0,0 +1,432 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file EmulatorDmaChannelBase.cxx
+/// \brief Implementation of the EmulatorDmaChannelBase class.
+
+#include "Emulator/EmulatorDmaChannelBase.h"
+#include <algorithm>
+#include <boost/format.hpp>
+#include "ExceptionInternal.h"
+#include "Visitor.h"
+
+using boost::format;
+
+namespace o2
+{
+namespace roc
+{
+
+EmulatorDmaChannelBase::EmulatorDmaChannelBase(const Parameters& parameters)
+  : DmaChannelBase(makeCardDescriptor(), const_cast<Parameters&>(parameters), { 0 }),
+    mGeneratorCpu(parameters.getDriverThreadCpu().get_value_or(-1))
+{
+  if (auto bufferParameters = parameters.getBufferParameters()) {
+    Visitor::apply<void>(
+      *bufferParameters,
+      [&](buffer_parameters::Memory parameters) {
+        mBufferAddress = reinterpret_cast<uintptr_t>(parameters.address);
+        mBufferSize = parameters.size;
+      },
+      [&](buffer_parameters::File parameters) {
+        mMappedFile = std::make_unique<MemoryMappedFile>(parameters.path, parameters.size);
+        mBufferAddress = reinterpret_cast<uintptr_t>(mMappedFile->getAddress());
+        mBufferSize = parameters.size;
+      },
+      [&](buffer_parameters::Null) {});
+  } else {
+    BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("DmaChannel requires buffer_parameters"));
+  }
+}
+
+void EmulatorDmaChannelBase::initializeLinks(const std::set<uint32_t>& linkIds)
+{
+  if (linkIds.empty()) {
+    BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message(getLoggerPrefix() + "No links are enabled"));
+  }
+
+  std::stringstream stream;
+  stream << "Emulating link(s): ";
+  mLinks = std::vector<Link>(linkIds.size());
+  size_t index = 0;
+  for (auto id : linkIds) {
+    stream << id << " ";
+    mLinks[index].id = id;
+    mLinks[index].queue = std::make_unique<SuperpageQueue>(LINK_QUEUE_CAPACITY + 1); // folly queue needs + 1
+    index++;
+  }
+  log(stream.str(), LogInfoDevel_(4350));
+
+  mCapacity = LINK_QUEUE_CAPACITY * mLinks.size();
+  mTransferQueue = std::make_unique<SuperpageQueue>(mCapacity + 1); // folly queue needs + 1
+  // Room for a full transfer queue on top of the superpages the user did not pop yet, see getAvailable()
+  mReadyQueue = std::make_unique<SuperpageQueue>(2 * mCapacity + 1);
+}
+
+EmulatorDmaChannelBase::~EmulatorDmaChannelBase()
+{
+  stopGenerator();
+}
+
+void EmulatorDmaChannelBase::stopGenerator()
+{
+  mGenerator.reset();
+}
+
+CardDescriptor EmulatorDmaChannelBase::makeCardDescriptor()
+{
+  return { CardType::Cru, SerialId{ SERIAL_DUMMY, ENDPOINT_DUMMY }, PciId{ "-1", "-1" }, PciAddress{ 0, 0, 0 }, -1, -1 };
+}
+
+void EmulatorDmaChannelBase::startDma()
+{
+  if (mDmaStarted) {
+    log("DMA already started. Ignoring startDma() call", LogWarningDevel_(4351));
+    return;
+  }
+
+  log("Starting DMA", LogInfoDevel_(4352));
+  for (auto& link : mLinks) {
+    link.sequence = 0;
+  }
+  mNextLink = 0;
+  resetGenerator();
+
+  mGenerator = std::make_unique<DriverThread>([this] { return generate(); }, getReadyWaitPolicy(), mGeneratorCpu,
+                                              getLoggerPrefix());
+  mDmaStarted = true;
+}
+
+void EmulatorDmaChannelBase::stopDma()
+{
+  if (!mDmaStarted) {
+    log("DMA already stopped. Ignoring stopDma() call", LogWarningDevel_(4353));
+    return;
+  }
+
+  log("Stopping DMA", LogInfoDevel_(4354));
+  mDmaStarted = false;
+  auto generatorException = mGenerator->stop();
+  mGenerator.reset();
+  returnUnfilledSuperpages();
+  if (generatorException) {
+    std::rethrow_exception(generatorException);
+  }
+}
+
+void EmulatorDmaChannelBase::resetChannel(ResetLevel::type)
+{
+  if (mDmaStarted) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Reset channel failed: DMA was not stopped"));
+  }
+  // There is no card state to reset
+}
+
+void EmulatorDmaChannelBase::returnUnfilledSuperpages()
+{
+  auto returnSuperpage = [&](Superpage superpage, Link* link) {
+    superpage.setReady(false);
+    superpage.setReceived(0);
+    mReadyQueue->write(superpage);
+    if (link) {
+      link->inFlight--;
+    }
+    mInFlight--;
+  };
+
+  size_t returned = 0;
+  for (auto& link : mLinks) {
+    while (auto superpage = tryPopFront(*link.queue)) {
+      returnSuperpage(*superpage, &link);
+      returned++;
+    }
+  }
+  while (auto superpage = tryPopFront(*mTransferQueue)) {
+    returnSuperpage(*superpage, superpage->getLink() >= 0 ? &getLink(superpage->getLink()) : nullptr);
+    returned++;
+  }
+
+  if (returned > 0) {
+    log((format("Returned %1% superpages that were not filled") % returned).str(), LogDebugDevel_(4355));
+    notifyReady(returned);
+  }
+}
+
+auto EmulatorDmaChannelBase::getLink(uint32_t linkId) -> Link&
+{
+  for (auto& link : mLinks) {
+    if (link.id == linkId) {
+      return link;
+    }
+  }
+  BOOST_THROW_EXCEPTION(InvalidLinkId() << ErrorInfo::Message(getLoggerPrefix() + "Link is not taking data")
+                                        << ErrorInfo::LinkId(linkId));
+}
+
+size_t EmulatorDmaChannelBase::getAvailable()
+{
+  // Superpages in flight must also fit in the ready queue next to the ones the user did not pop, so that the
+  // generator never finds it full, and they can all be returned when DMA stops
+  size_t inFlight = mInFlight;
+  size_t ready = mReadyQueue->sizeGuess();
+  if (inFlight >= mCapacity || inFlight + ready >= 2 * mCapacity) {
+    return 0;
+  }
+  return std::min(mCapacity - inFlight, 2 * mCapacity - inFlight - ready);
+}
+
+void EmulatorDmaChannelBase::enqueueSuperpage(Superpage superpage)
+{
+  // The transfer queue has as many slots as there can be superpages in flight, so this can't fail
+  countUserPush(superpage);
+  mInFlight++;
+  mTransferQueue->write(superpage);
+}
+
+bool EmulatorDmaChannelBase::pushSuperpage(Superpage superpage)
+{
+  if (!mDmaStarted) {
+    return false;
+  }
+
+  if (auto error = getSuperpageError(superpage, mBufferSize)) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(std::string("Could not enqueue superpage, ") + error));
+  }
+
+  if (getAvailable() == 0) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(getLoggerPrefix() + "Could not push superpage, transfer queue was full"));
+  }
+
+  superpage.setLink(-1);
+  enqueueSuperpage(superpage);
+  return true;
+}
+
+bool EmulatorDmaChannelBase::pushSuperpage(Superpage superpage, uint32_t linkId)
+{
+  if (!mDmaStarted) {
+    return false;
+  }
+
+  if (auto error = getSuperpageError(superpage, mBufferSize)) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(std::string("Could not enqueue superpage, ") + error));
+  }
+
+  auto& link = getLink(linkId);
+  if (link.inFlight >= LINK_QUEUE_CAPACITY || getAvailable() == 0) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(getLoggerPrefix() + "Could not push superpage, link queue was full")
+                                      << ErrorInfo::LinkId(linkId));
+  }
+
+  link.inFlight++;
+  superpage.setLink(linkId);
+  enqueueSuperpage(superpage);
+  return true;
+}
+
+size_t EmulatorDmaChannelBase::pushSuperpages(const Superpage* superpages, size_t count)
+{
+  if (!mDmaStarted) {
+    return 0;
+  }
+
+  size_t pushed = 0;
+  for (size_t available = getAvailable(); pushed < count && pushed < available; ++pushed) {
+    pushSuperpage(superpages[pushed]);
+  }
+  return pushed;
+}
+
+PushStatus::type EmulatorDmaChannelBase::tryPushSuperpage(const Superpage& superpage)
+{
+  if (!mDmaStarted) {
+    return PushStatus::DmaNotStarted;
+  }
+
+  if (getSuperpageError(superpage, mBufferSize) != nullptr) {
+    return PushStatus::InvalidSuperpage;
+  }
+
+  if (getAvailable() == 0) {
+    return PushStatus::QueueFull;
+  }
+
+  Superpage scheduled = superpage;
+  scheduled.setLink(-1);
+  enqueueSuperpage(scheduled);
+  return PushStatus::Ok;
+}
+
+auto EmulatorDmaChannelBase::getSuperpage() -> Superpage
+{
+  if (mReadyQueue->isEmpty()) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(getLoggerPrefix() + "Could not get superpage, ready queue was empty"));
+  }
+  return *mReadyQueue->frontPtr();
+}
+
+auto EmulatorDmaChannelBase::popSuperpage() -> Superpage
+{
+  if (mReadyQueue->isEmpty()) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(getLoggerPrefix() + "Could not pop superpage, ready queue was empty"));
+  }
+  auto superpage = *mReadyQueue->frontPtr();
+  mReadyQueue->popFront();
+  countUserPops(&superpage, 1);
+  return superpage;
+}
+
+size_t EmulatorDmaChannelBase::popSuperpages(Superpage* superpages, size_t maxCount)
+{
+  size_t popped = popFront(*mReadyQueue, superpages, maxCount);
+  countUserPops(superpages, popped);
+  return popped;
+}
+
+boost::optional<Superpage> EmulatorDmaChannelBase::tryPeekSuperpage()
+{
+  return tryPeekFront(*mReadyQueue);
+}
+
+boost::optional<Superpage> EmulatorDmaChannelBase::tryPopSuperpage()
+{
+  auto superpage = tryPopFront(*mReadyQueue);
+  if (superpage) {
+    countUserPops(&*superpage, 1);
+  }
+  return superpage;
+}
+
+void EmulatorDmaChannelBase::fillSuperpages()
+{
+  // The generator thread does the work
+}
+
+void EmulatorDmaChannelBase::assignTransferredSuperpages()
+{
+  while (auto superpage = tryPopFront(*mTransferQueue)) {
+    if (superpage->getLink() >= 0) {
+      // Its slot was already taken when it was pushed
+      getLink(superpage->getLink()).queue->write(*superpage);
+      continue;
+    }
+
+    // Give it to the link with the fewest superpages in flight. There is always one with a free slot, since there are
+    // no more superpages in flight than the links can hold.
+    auto link = std::min_element(mLinks.begin(), mLinks.end(), [](const Link& a, const Link& b) {
+      return a.inFlight < b.inFlight;
+    });
+    link->inFlight++;
+    superpage->setLink(link->id);
+    link->queue->write(*superpage);
+  }
+}
+
+bool EmulatorDmaChannelBase::generate()
+{
+  assignTransferredSuperpages();
+
+  // Fill a superpage of the next link that has one, round-robin
+  for (size_t i = 0; i < mLinks.size(); ++i) {
+    size_t index = (mNextLink + i) % mLinks.size();
+    auto& link = mLinks[index];
+    auto superpage = link.queue->frontPtr();
+    if (superpage == nullptr || !fillSuperpage(index, *superpage)) {
+      continue;
+    }
+
+    stampArrivalTime(*superpage);
+    superpage->setSequence(link.sequence++);
+    superpage->setReady(true);
+    mReadyQueue->write(*superpage);
+    link.queue->popFront();
+    link.inFlight--;
+    mInFlight--;
+    notifyReady(1);
+    mNextLink = (index + 1) % mLinks.size();
+    return true;
+  }
+  return false;
+}
+
+int EmulatorDmaChannelBase::getTransferQueueAvailable()
+{
+  return getAvailable();
+}
+
+int EmulatorDmaChannelBase::getTransferQueueAvailable(uint32_t linkId)
+{
+  size_t inFlight = getLink(linkId).inFlight;
+  size_t available = inFlight < LINK_QUEUE_CAPACITY ? LINK_QUEUE_CAPACITY - inFlight : 0;
+  return std::min(available, getAvailable());
+}
+
+std::vector<uint32_t> EmulatorDmaChannelBase::getDataTakingLinks()
+{
+  std::vector<uint32_t> links;
+  for (const auto& link : mLinks) {
+    links.push_back(link.id);
+  }
+  return links;
+}
+
+int EmulatorDmaChannelBase::getReadyQueueSize()
+{
+  return mReadyQueue->sizeGuess();
+}
+
+bool EmulatorDmaChannelBase::isTransferQueueEmpty()
+{
+  return mInFlight == 0;
+}
+
+bool EmulatorDmaChannelBase::isReadyQueueFull()
+{
+  return mReadyQueue->isFull();
+}
+
+int32_t EmulatorDmaChannelBase::getDroppedPackets()
+{
+  return 0;
+}
+
+bool EmulatorDmaChannelBase::areSuperpageFifosHealthy()
+{
+  return true;
+}
+
+CardType::type EmulatorDmaChannelBase::getCardType()
+{
+  return CardType::Cru;
+}
+
+PciAddress EmulatorDmaChannelBase::getPciAddress()
+{
+  return getCardDescriptor().pciAddress;
+}
+
+int EmulatorDmaChannelBase::getNumaNode()
+{
+  return getCardDescriptor().numaNode;
+}
+
+bool EmulatorDmaChannelBase::injectError()
+{
+  mInjectError = true;
+  return true;
+}
+
+boost::optional<int32_t> EmulatorDmaChannelBase::getSerial()
+{
+  return SERIAL_DUMMY;
+}
+
+} // namespace roc
+} // namespace o2
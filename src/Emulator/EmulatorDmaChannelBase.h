@@ -0,0 +1,168 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file EmulatorDmaChannelBase.h
+/// \brief Definition of the EmulatorDmaChannelBase class.
+
+#ifndef O2_READOUTCARD_SRC_EMULATOR_EMULATORDMACHANNELBASE_H_
+#define O2_READOUTCARD_SRC_EMULATOR_EMULATORDMACHANNELBASE_H_
+
+#include <atomic>
+#include <memory>
+#include <set>
+#include <vector>
+#include "DmaChannelBase.h"
+#include "DriverThread.h"
+#include "ReadoutCard/MemoryMappedFile.h"
+#include "ReadoutCard/Parameters.h"
+#include "SuperpageQueue.h"
+
+namespace o2
+{
+namespace roc
+{
+
+/// Partially implements the DmaChannelInterface for DMA channels emulated in software, selected with the dummy serial
+/// ID (-1). It takes care of the superpage queues of the emulated CRU links, and of the thread that fills the pushed
+/// superpages; subclasses provide the contents of the superpages.
+class EmulatorDmaChannelBase : public DmaChannelBase
+{
+ public:
+  virtual ~EmulatorDmaChannelBase() override;
+
+  virtual void startDma() override;
+  virtual void stopDma() override;
+  virtual void resetChannel(ResetLevel::type resetLevel) override;
+
+  virtual bool pushSuperpage(Superpage superpage) override;
+  virtual bool pushSuperpage(Superpage superpage, uint32_t linkId) override;
+  virtual Superpage getSuperpage() override;
+  virtual Superpage popSuperpage() override;
+  virtual size_t pushSuperpages(const Superpage* superpages, size_t count) override;
+  virtual size_t popSuperpages(Superpage* superpages, size_t maxCount) override;
+  virtual PushStatus::type tryPushSuperpage(const Superpage& superpage) override;
+  virtual boost::optional<Superpage> tryPeekSuperpage() override;
+  virtual boost::optional<Superpage> tryPopSuperpage() override;
+  virtual void fillSuperpages() override;
+
+  virtual int getTransferQueueAvailable() override;
+  virtual int getTransferQueueAvailable(uint32_t linkId) override;
+  virtual std::vector<uint32_t> getDataTakingLinks() override;
+  virtual int getReadyQueueSize() override;
+  virtual bool isTransferQueueEmpty() override;
+  virtual bool isReadyQueueFull() override;
+  virtual int32_t getDroppedPackets() override;
+  virtual bool areSuperpageFifosHealthy() override;
+
+  virtual CardType::type getCardType() override;
+  virtual PciAddress getPciAddress() override;
+  virtual int getNumaNode() override;
+  virtual bool injectError() override;
+  virtual boost::optional<int32_t> getSerial() override;
+
+  /// Superpages each link can hold, like the CRU's default superpage descriptor FIFO
+  static constexpr size_t LINK_QUEUE_CAPACITY = 128;
+
+ protected:
+  EmulatorDmaChannelBase(const Parameters& parameters);
+
+  /// Creates the queues of the emulated links. Must be called once by the subclass constructor.
+  void initializeLinks(const std::set<uint32_t>& linkIds);
+
+  /// Called by startDma() before the generator thread starts, to reset the generator state
+  virtual void resetGenerator() = 0;
+
+  /// Called by the generator thread to fill a superpage of a link. Must set the received size of the superpage; the
+  /// link, sequence number, arrival time and ready flag are set by the caller.
+  /// \param linkIndex Index of the link in getDataTakingLinks()
+  /// \return False if the superpage can't be filled yet, in which case it is offered again later
+  virtual bool fillSuperpage(size_t linkIndex, Superpage& superpage) = 0;
+
+  /// Stops the generator thread. Must be called by the subclass destructor, so that the thread does not call into a
+  /// destroyed subclass.
+  void stopGenerator();
+
+  /// Gets the address of a superpage in the user's buffer
+  char* getSuperpageAddress(const Superpage& superpage) const
+  {
+    return reinterpret_cast<char*>(mBufferAddress + superpage.getOffset());
+  }
+
+  /// \return True once after injectError() was called
+  bool takeInjectedError()
+  {
+    return mInjectError.exchange(false);
+  }
+
+  size_t getLinkCount() const
+  {
+    return mLinks.size();
+  }
+
+  virtual size_t getDmaBufferSize() const override
+  {
+    return mBufferSize;
+  }
+
+ private:
+  /// Per-link state
+  struct Link {
+    uint32_t id = 0;
+    /// Superpages pushed to the link and not filled yet. Written by both threads.
+    std::atomic<size_t> inFlight{ 0 };
+    /// Superpages assigned to the link, only accessed by the generator thread while DMA is started
+    std::unique_ptr<SuperpageQueue> queue;
+    /// Sequence number of the next superpage, only accessed by the generator thread
+    uint32_t sequence = 0;
+  };
+
+  static CardDescriptor makeCardDescriptor();
+
+  Link& getLink(uint32_t linkId);
+  void enqueueSuperpage(Superpage superpage);
+  size_t getAvailable();
+
+  /// One iteration of the generator thread
+  /// \return True if a superpage was filled
+  bool generate();
+  void assignTransferredSuperpages();
+
+  /// Moves the superpages that were not filled to the ready queue, marked as not ready
+  void returnUnfilledSuperpages();
+
+  const int mGeneratorCpu;
+
+  /// The user's buffer
+  std::unique_ptr<MemoryMappedFile> mMappedFile;
+  uintptr_t mBufferAddress = 0;
+  size_t mBufferSize = 0;
+
+  std::vector<Link> mLinks;
+  size_t mCapacity = 0;
+
+  /// Superpages pushed by the user, picked up by the generator thread
+  std::unique_ptr<SuperpageQueue> mTransferQueue;
+  /// Filled superpages, or unfilled ones returned when DMA stops
+  std::unique_ptr<SuperpageQueue> mReadyQueue;
+  /// Superpages pushed and not moved to the ready queue yet
+  std::atomic<size_t> mInFlight{ 0 };
+
+  bool mDmaStarted = false;
+  std::unique_ptr<DriverThread> mGenerator;
+  std::atomic<bool> mInjectError{ false };
+
+  /// Link to offer the next superpage to, only accessed by the generator thread
+  size_t mNextLink = 0;
+};
+
+} // namespace roc
+} // namespace o2
+
+#endif // O2_READOUTCARD_SRC_EMULATOR_EMULATORDMACHANNELBASE_H_
@@ -0,0 +1,250 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file ReplayDmaChannel.cxx
+/// \brief Implementation of the ReplayDmaChannel class.
+
+#include "Emulator/ReplayDmaChannel.h"
+#include <algorithm>
+#include <cstring>
+#include <set>
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include "Cru/Constants.h"
+#include "DataFormat.h"
+#include "ExceptionInternal.h"
+
+using boost::format;
+
+namespace o2
+{
+namespace roc
+{
+
+namespace bfs = boost::filesystem;
+namespace bip = boost::interprocess;
+
+namespace
+{
+/// Markers that `o2-roc-bench-dma --print-sp-change` writes between pages: four times the same 32-bit word
+constexpr uint32_t MARKER_NEW_SUPERPAGE = 0x0badf00d;
+constexpr uint32_t MARKER_EMPTY_PAGE = 0xdeadbeef;
+constexpr size_t MARKER_SIZE = 16;
+
+bool isMarker(const char* data)
+{
+  uint32_t words[4];
+  std::memcpy(words, data, sizeof(words));
+  return (words[0] == MARKER_NEW_SUPERPAGE || words[0] == MARKER_EMPTY_PAGE) &&
+         words[1] == words[0] && words[2] == words[0] && words[3] == words[0];
+}
+} // namespace
+
+/// A recorded file, mapped read-only
+struct ReplayDmaChannel::MappedFile {
+  std::string path;
+  bip::file_mapping mapping;
+  bip::mapped_region region;
+
+  const char* getData() const
+  {
+    return reinterpret_cast<const char*>(region.get_address());
+  }
+};
+
+ReplayDmaChannel::ReplayDmaChannel(const Parameters& parameters)
+  : EmulatorDmaChannelBase(parameters),
+    mSpeed(parameters.getReplaySpeed().get_value_or(0.0)),
+    mLoopEnabled(parameters.getReplayLoopEnabled().get_value_or(false))
+{
+  if (mSpeed < 0.0) {
+    BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message(getLoggerPrefix() + "Replay speed must not be negative"));
+  }
+
+  std::map<uint32_t, Stream> streams;
+  for (const auto& path : parameters.getReplayFilesRequired()) {
+    auto file = std::make_unique<MappedFile>();
+    file->path = path;
+    try {
+      if (bfs::file_size(path) == 0) {
+        log((format("Replay file %1% is empty, skipping it") % path).str(), LogWarningDevel_(4356));
+        continue;
+      }
+      file->mapping = bip::file_mapping(path.c_str(), bip::read_only);
+      file->region = bip::mapped_region(file->mapping, bip::read_only);
+    } catch (const std::exception& e) {
+      BOOST_THROW_EXCEPTION(MemoryMapException() << ErrorInfo::Message(getLoggerPrefix() + "Failed to map replay file: " + e.what())
+                                                 << ErrorInfo::FileName(path));
+    }
+    indexFile(*file, streams);
+    mFiles.push_back(std::move(file));
+  }
+
+  std::set<uint32_t> linkIds;
+  size_t pages = 0;
+  for (auto& entry : streams) {
+    linkIds.insert(entry.first);
+    pages += entry.second.pages.size();
+    mStreams.push_back(std::move(entry.second));
+  }
+  if (pages == 0) {
+    BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message(getLoggerPrefix() + "Replay files contain no pages"));
+  }
+  log((format("Replaying %1% pages, %2% us of data at real-time speed") % pages % (mDuration / 1000)).str(),
+      LogInfoDevel_(4357));
+  initializeLinks(linkIds);
+}
+
+ReplayDmaChannel::~ReplayDmaChannel()
+{
+  stopGenerator();
+}
+
+void ReplayDmaChannel::indexFile(const MappedFile& file, std::map<uint32_t, Stream>& streams)
+{
+  const char* data = file.getData();
+  const size_t size = file.region.get_size();
+  uint64_t time = mDuration;
+  size_t indexed = 0;
+  uint32_t previousOrbit = 0;
+  bool havePreviousOrbit = false;
+  uint32_t previousLink = 0;
+
+  size_t position = 0;
+  while (position < size) {
+    if (size - position >= MARKER_SIZE && isMarker(data + position)) {
+      position += MARKER_SIZE;
+      continue;
+    }
+
+    const char* page = data + position;
+    const size_t pageSize = (size - position >= DataFormat::getHeaderSize()) ? DataFormat::getOffset(page) : 0;
+    if (pageSize == 0 || pageSize > size - position) {
+      log((format("Replay file %1% has a truncated or corrupt page at byte %2%, ignoring the rest of the file") %
+           file.path % position)
+            .str(),
+          LogWarningDevel_(4358));
+      break;
+    }
+
+    // Pages keep the time of the previous page when the orbit jumps backward or too far ahead
+    uint32_t orbit = DataFormat::getOrbit(page);
+    if (havePreviousOrbit && uint32_t(orbit - previousOrbit) <= MAX_ORBIT_GAP) {
+      time += uint64_t(orbit - previousOrbit) * ORBIT_NANOSECONDS;
+    }
+    previousOrbit = orbit;
+    havePreviousOrbit = true;
+
+    // A corrupted link ID would still arrive on the link of the data around it
+    uint32_t linkId = DataFormat::getLinkId(page);
+    if (linkId >= uint32_t(Cru::MAX_LINKS)) {
+      linkId = previousLink;
+    }
+    previousLink = linkId;
+
+    auto& stream = streams[linkId];
+    stream.linkId = linkId;
+    stream.pages.push_back(Page{ page, uint32_t(pageSize), time });
+    position += pageSize;
+    indexed++;
+  }
+
+  if (indexed > 0) {
+    // The next file, or the next loop, starts an orbit after the last page
+    mDuration = time + ORBIT_NANOSECONDS;
+  }
+}
+
+void ReplayDmaChannel::resetGenerator()
+{
+  for (auto& stream : mStreams) {
+    stream.next = 0;
+    stream.loops = 0;
+    stream.finished = false;
+  }
+  mStartTime = std::chrono::steady_clock::now();
+}
+
+bool ReplayDmaChannel::fillSuperpage(size_t linkIndex, Superpage& superpage)
+{
+  auto& stream = mStreams[linkIndex];
+  if (stream.finished) {
+    return false;
+  }
+
+  // Find the pages that fit in the superpage. A page larger than the superpage is truncated, like the card would.
+  size_t next = stream.next;
+  uint64_t loops = stream.loops;
+  size_t pages = 0;
+  size_t bytes = 0;
+  uint64_t lastTime = 0;
+  while (true) {
+    if (next == stream.pages.size()) {
+      if (!mLoopEnabled) {
+        break;
+      }
+      next = 0;
+      loops++;
+    }
+    const auto& page = stream.pages[next];
+    if (pages > 0 && bytes + page.size > superpage.getSize()) {
+      break;
+    }
+    bytes += std::min<size_t>(page.size, superpage.getSize());
+    lastTime = page.time + loops * mDuration;
+    pages++;
+    next++;
+  }
+
+  if (pages == 0) {
+    stream.finished = true;
+    log((format("Replay of link %1% finished") % stream.linkId).str(), LogInfoDevel_(4359));
+    return false;
+  }
+
+  // The superpage is complete when its last page would have arrived
+  if (mSpeed > 0.0) {
+    auto due = mStartTime + std::chrono::nanoseconds(uint64_t(lastTime / mSpeed));
+    if (std::chrono::steady_clock::now() < due) {
+      return false;
+    }
+  }
+
+  auto superpageAddress = getSuperpageAddress(superpage);
+  size_t written = 0;
+  for (size_t i = 0; i < pages; ++i) {
+    if (stream.next == stream.pages.size()) {
+      stream.next = 0;
+      stream.loops++;
+    }
+    const auto& page = stream.pages[stream.next];
+    size_t pageBytes = std::min<size_t>(page.size, superpage.getSize());
+    std::memcpy(superpageAddress + written, page.data, pageBytes);
+    written += pageBytes;
+    stream.next++;
+  }
+
+  if (written > DataFormat::getHeaderSize() && takeInjectedError()) {
+    // Corrupt the first word of the payload
+    superpageAddress[DataFormat::getHeaderSize()] ^= 0x1;
+  }
+  superpage.setReceived(written);
+  return true;
+}
+
+boost::optional<std::string> ReplayDmaChannel::getFirmwareInfo()
+{
+  return std::string("replay");
+}
+
+} // namespace roc
+} // namespace o2
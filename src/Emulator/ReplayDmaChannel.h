@@ -0,0 +1,94 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file ReplayDmaChannel.h
+/// \brief Definition of the ReplayDmaChannel class.
+
+#ifndef O2_READOUTCARD_SRC_EMULATOR_REPLAYDMACHANNEL_H_
+#define O2_READOUTCARD_SRC_EMULATOR_REPLAYDMACHANNEL_H_
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Emulator/EmulatorDmaChannelBase.h"
+
+namespace o2
+{
+namespace roc
+{
+
+/// Software emulation of a CRU DMA channel that replays recorded data, selected with the dummy serial ID (-1) and the
+/// ReplayFiles parameter.
+///
+/// The files, as written by `o2-roc-bench-dma --to-file-bin`, are memory mapped and split into pages by the offset
+/// field of their RDHs. The pages are copied verbatim, so bad RDHs are reproduced, into the superpages of the link given
+/// by their RDH, packed like the CRU does with dynamic page sizes. The replay is paced by the orbits of the RDHs,
+/// scaled by the ReplaySpeed parameter, and may loop over the files with the ReplayLoopEnabled parameter.
+class ReplayDmaChannel final : public EmulatorDmaChannelBase
+{
+ public:
+  ReplayDmaChannel(const Parameters& parameters);
+  virtual ~ReplayDmaChannel() override;
+
+  virtual boost::optional<std::string> getFirmwareInfo() override;
+
+  /// Duration of an LHC orbit in nanoseconds
+  static constexpr uint64_t ORBIT_NANOSECONDS = 88924;
+
+  /// Largest orbit increment between consecutive pages that is taken as time passing, about a second. Larger or
+  /// backward jumps come from corrupted or unrelated data, and are replayed without waiting.
+  static constexpr uint32_t MAX_ORBIT_GAP = 11246;
+
+ protected:
+  virtual void resetGenerator() override;
+  virtual bool fillSuperpage(size_t linkIndex, Superpage& superpage) override;
+
+ private:
+  struct MappedFile;
+
+  /// A recorded page
+  struct Page {
+    const char* data;
+    uint32_t size;
+    /// Time of the page since the start of the replay at real-time speed, in nanoseconds
+    uint64_t time;
+  };
+
+  /// The pages of a link, and the position of the replay in them
+  struct Stream {
+    std::vector<Page> pages;
+    uint32_t linkId = 0;
+    size_t next = 0;
+    uint64_t loops = 0;
+    bool finished = false;
+  };
+
+  /// Splits a file into pages, appending them to the streams of their links
+  void indexFile(const MappedFile& file, std::map<uint32_t, Stream>& streams);
+
+  const double mSpeed;
+  const bool mLoopEnabled;
+
+  std::vector<std::unique_ptr<MappedFile>> mFiles;
+  /// Streams of the links, in the order of getDataTakingLinks()
+  std::vector<Stream> mStreams;
+  /// Duration of one pass over the files at real-time speed, in nanoseconds
+  uint64_t mDuration = 0;
+
+  /// Generator state, only accessed by the generator thread
+  std::chrono::steady_clock::time_point mStartTime;
+};
+
+} // namespace roc
+} // namespace o2
+
+#endif // O2_READOUTCARD_SRC_EMULATOR_REPLAYDMACHANNEL_H_
@@ -25,6 +25,8 @@
 #include "Crorc/CrorcBar.h"
 #include "Cru/CruDmaChannel.h"
 #include "Cru/CruBar.h"
+#include "Emulator/EmulatorDmaChannel.h"
+#include "Emulator/ReplayDmaChannel.h"
 #include "RocPciDevice.h"
 
 namespace o2
@@ -39,10 +41,24 @@ inline std::unique_ptr<RocPciDevice> findCard(const Parameters::CardIdType& id)
   return std::make_unique<RocPciDevice>(id);
 }
 
+/// The dummy serial ID selects the software emulator instead of a card
+inline bool isDummyCard(const Parameters::CardIdType& id)
+{
+  auto serialId = boost::get<SerialId>(&id);
+  return serialId && serialId->getSerial() == SERIAL_DUMMY;
+}
+
 template <typename Interface>
 std::unique_ptr<Interface> dmaChannelFactoryHelper(const Parameters& params)
 {
   auto id = params.getCardIdRequired();
+  if (isDummyCard(id)) {
+    if (params.getReplayFiles()) {
+      return std::make_unique<ReplayDmaChannel>(params);
+    }
+    return std::make_unique<EmulatorDmaChannel>(params);
+  }
+
   auto rocPciDevice = findCard(id);
   auto cardDescriptor = rocPciDevice->getCardDescriptor();
 
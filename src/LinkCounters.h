@@ -0,0 +1,122 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file LinkCounters.h
+/// \brief Definition of the LinkCounters class, behind the per-link statistics of a DMA channel
+
+#ifndef O2_READOUTCARD_SRC_LINKCOUNTERS_H_
+#define O2_READOUTCARD_SRC_LINKCOUNTERS_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "ReadoutCard/DmaChannelInterface.h"
+#include "Utilities/Polling.h"
+
+namespace o2
+{
+namespace roc
+{
+
+/// Counters of the superpages of a link. They are only written by the thread doing the driver work, so updates are a
+/// load and store with no read-modify-write, and they can be read from any thread with get(). The filled and
+/// reclaimed counts are stored with release ordering, so that a reader seeing them also sees the pushes before them.
+class LinkCounters
+{
+ public:
+  /// \param linkId ID of the link
+  /// \param firmwareCapacity Most superpages that can be pushed to the card on the link
+  LinkCounters(uint32_t linkId, size_t firmwareCapacity)
+    : mLinkId(linkId), mPushTimes(firmwareCapacity)
+  {
+  }
+
+  /// Counts a superpage pushed to the card
+  /// \param now Current time in nanoseconds of the steady clock
+  void pushed(uint64_t now)
+  {
+    uint64_t pushed = mPushed.load(std::memory_order_relaxed);
+    mPushTimes[pushed % mPushTimes.size()] = now;
+    mPushed.store(pushed + 1, std::memory_order_relaxed);
+  }
+
+  /// Counts the oldest superpage pushed to the card as filled
+  /// \param bytes Bytes received in the superpage
+  /// \param now Current time in nanoseconds of the steady clock
+  void filled(uint64_t bytes, uint64_t now)
+  {
+    uint64_t pushTime = mPushTimes[popIndex() % mPushTimes.size()];
+    Utilities::addRelaxed(mFillTimes[getBucket(now > pushTime ? now - pushTime : 0)]);
+    Utilities::addRelaxed(mBytes, bytes);
+    mFilled.store(mFilled.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  /// Counts the oldest superpage pushed to the card as returned unfilled
+  void reclaimed()
+  {
+    mReclaimed.store(mReclaimed.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  uint32_t getLinkId() const
+  {
+    return mLinkId;
+  }
+
+  /// \return A snapshot of the counters
+  LinkStatistics get() const
+  {
+    LinkStatistics statistics;
+    statistics.linkId = mLinkId;
+    statistics.firmwareCapacity = mPushTimes.size();
+    // Superpages leave the card after being pushed. Acquiring the filled and reclaimed counts before reading the push
+    // count makes it at least their sum.
+    statistics.superpagesFilled = mFilled.load(std::memory_order_acquire);
+    statistics.superpagesReclaimed = mReclaimed.load(std::memory_order_acquire);
+    statistics.bytesReceived = mBytes.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < mFillTimes.size(); ++i) {
+      statistics.fillTimes[i] = mFillTimes[i].load(std::memory_order_relaxed);
+    }
+    statistics.superpagesPushed = mPushed.load(std::memory_order_relaxed);
+    statistics.superpagesInFirmware =
+      statistics.superpagesPushed - statistics.superpagesFilled - statistics.superpagesReclaimed;
+    return statistics;
+  }
+
+  /// \return The fill time histogram bucket of a fill time
+  static size_t getBucket(uint64_t nanoseconds)
+  {
+    uint64_t microseconds = nanoseconds / 1000;
+    size_t bucket = (microseconds == 0) ? 0 : 64 - __builtin_clzll(microseconds);
+    return std::min(bucket, LinkStatistics::FILL_TIME_BUCKETS - 1);
+  }
+
+ private:
+  /// Index of the oldest superpage in the card, in push order
+  uint64_t popIndex() const
+  {
+    return mFilled.load(std::memory_order_relaxed) + mReclaimed.load(std::memory_order_relaxed);
+  }
+
+  const uint32_t mLinkId;
+  std::atomic<uint64_t> mPushed{ 0 };
+  std::atomic<uint64_t> mFilled{ 0 };
+  std::atomic<uint64_t> mReclaimed{ 0 };
+  std::atomic<uint64_t> mBytes{ 0 };
+  std::array<std::atomic<uint64_t>, LinkStatistics::FILL_TIME_BUCKETS> mFillTimes{};
+  /// Push times of the superpages in the card, indexed by their push count
+  std::vector<uint64_t> mPushTimes;
+};
+
+} // namespace roc
+} // namespace o2
+
+#endif // O2_READOUTCARD_SRC_LINKCOUNTERS_H_
@@ -0,0 +1,43 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file LinkSchedulerPolicy.cxx
+/// \brief Implementation of the LinkSchedulerPolicy enum and supporting functions.
+
+#include "ReadoutCard/ParameterTypes/LinkSchedulerPolicy.h"
+#include "Utilities/Enum.h"
+
+namespace o2
+{
+namespace roc
+{
+namespace
+{
+
+static const auto converter = Utilities::makeEnumConverter<LinkSchedulerPolicy::type>("LinkSchedulerPolicy", {
+                                                                                                               { LinkSchedulerPolicy::FreeSlot, "free-slot" },
+                                                                                                               { LinkSchedulerPolicy::RateWeighted, "rate-weighted" },
+                                                                                                               { LinkSchedulerPolicy::Controlled, "controlled" },
+                                                                                                             });
+
+} // Anonymous namespace
+
+std::string LinkSchedulerPolicy::toString(const LinkSchedulerPolicy::type& policy)
+{
+  return converter.toString(policy);
+}
+
+LinkSchedulerPolicy::type LinkSchedulerPolicy::fromString(const std::string& string)
+{
+  return converter.fromString(string);
+}
+
+} // namespace roc
+} // namespace o2
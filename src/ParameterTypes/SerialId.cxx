@@ -28,6 +28,13 @@ namespace
 
 bool parseSerialIdString(const std::string string, int& serial, int& endpoint)
 {
+  if (std::regex_search(string, std::regex("^[ \t]*-1[ \t]*$"))) {
+    // The dummy serial, which selects the software emulator
+    serial = SERIAL_DUMMY;
+    endpoint = ENDPOINT_DUMMY;
+    return true;
+  }
+
   std::regex expression("^[ \t]*([0-9]{3}|[0-9]{4}|[0-9]{5}):?[0-1]?[ \t]*$");
   if (std::regex_search(string, expression)) {
     serial = stoi(string.substr(0, string.find(':'))); // Will return the SerialId struct
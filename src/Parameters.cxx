@@ -38,7 +38,8 @@ using Variant = boost::variant<size_t, uint32_t, int32_t, bool, Parameters::Buff
                                Parameters::DatapathModeType, Parameters::DownstreamDataType, Parameters::GbtCounterTypeType,
                                Parameters::GbtModeType, Parameters::GbtMuxType, Parameters::GbtMuxMapType,
                                Parameters::GbtPatternModeType, Parameters::GbtStatsModeType, Parameters::OnuAddressType,
-                               Parameters::FeeIdMapType>;
+                               Parameters::FeeIdMapType, Parameters::LinkSchedulerPolicyType, Parameters::ReadyWaitPolicyType,
+                               Parameters::ReplayFilesType, double, Parameters::CrorcPushVerificationType>;
 
 using KeyType = const char*;
 
@@ -155,6 +156,23 @@ _PARAMETER_FUNCTIONS(SystemId, "system_id")
 _PARAMETER_FUNCTIONS(FeeId, "fee_id")
 _PARAMETER_FUNCTIONS(FeeIdMap, "fee_id_map")
 _PARAMETER_FUNCTIONS(DropBadRdhEnabled, "drop_bad_rdh_enabled")
+_PARAMETER_FUNCTIONS(ReadyWaitPolicy, "ready_wait_policy")
+_PARAMETER_FUNCTIONS(ReadyEventFdEnabled, "ready_event_fd_enabled")
+_PARAMETER_FUNCTIONS(DriverThreadEnabled, "driver_thread_enabled")
+_PARAMETER_FUNCTIONS(DriverThreadCpu, "driver_thread_cpu")
+_PARAMETER_FUNCTIONS(LinkStatusBatchReadEnabled, "link_status_batch_read_enabled")
+_PARAMETER_FUNCTIONS(LinkSchedulerPolicy, "link_scheduler_policy")
+_PARAMETER_FUNCTIONS(LinkInFlightMin, "link_in_flight_min")
+_PARAMETER_FUNCTIONS(LinkInFlightMax, "link_in_flight_max")
+_PARAMETER_FUNCTIONS(FastRestartEnabled, "fast_restart_enabled")
+_PARAMETER_FUNCTIONS(SuperpageTimestampEnabled, "superpage_timestamp_enabled")
+_PARAMETER_FUNCTIONS(EmulatorDataRate, "emulator_data_rate")
+_PARAMETER_FUNCTIONS(ReplayFiles, "replay_files")
+_PARAMETER_FUNCTIONS(ReplaySpeed, "replay_speed")
+_PARAMETER_FUNCTIONS(ReplayLoopEnabled, "replay_loop_enabled")
+_PARAMETER_FUNCTIONS(CrorcPipelineDepth, "crorc_pipeline_depth")
+_PARAMETER_FUNCTIONS(CrorcPushVerification, "crorc_push_verification")
+_PARAMETER_FUNCTIONS(CrorcPushVerificationInterval, "crorc_push_verification_interval")
 #undef _PARAMETER_FUNCTIONS
 
 Parameters::Parameters() : mPimpl(std::make_unique<ParametersPimpl>())
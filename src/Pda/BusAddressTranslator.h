@@ -0,0 +1,123 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file BusAddressTranslator.h
+/// \brief Definition of the BusAddressTranslator class.
+
+#ifndef O2_READOUTCARD_SRC_PDA_BUSADDRESSTRANSLATOR_H_
+#define O2_READOUTCARD_SRC_PDA_BUSADDRESSTRANSLATOR_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <boost/optional.hpp>
+
+namespace o2
+{
+namespace roc
+{
+namespace Pda
+{
+
+/// Translates offsets in a DMA buffer to bus addresses, using a lookup built once from the scatter-gather list.
+///
+/// When the entries are contiguous in userspace and all but the last have the same size, as with a buffer of
+/// hugepages, the entry of an offset is found by a division. Otherwise, it is found by a binary search over the
+/// offsets of the entries.
+class BusAddressTranslator
+{
+ public:
+  /// An entry of the scatter-gather list
+  struct Entry {
+    size_t size;
+    uintptr_t addressUser;
+    uintptr_t addressBus;
+  };
+
+  BusAddressTranslator() = default;
+
+  /// \param entries The scatter-gather list. Offsets are relative to the userspace address of its first entry.
+  explicit BusAddressTranslator(const std::vector<Entry>& entries)
+  {
+    if (entries.empty()) {
+      return;
+    }
+
+    const uintptr_t base = entries.front().addressUser;
+    for (const auto& entry : entries) {
+      // Entries before the first one can't be reached by an offset
+      if (entry.addressUser >= base && entry.size > 0) {
+        mEntries.push_back(Range{ entry.addressUser - base, entry.size, entry.addressBus });
+      }
+    }
+    std::sort(mEntries.begin(), mEntries.end(), [](const Range& a, const Range& b) { return a.offset < b.offset; });
+
+    mUniformSize = mEntries.front().size;
+    for (size_t i = 0; i < mEntries.size(); ++i) {
+      bool contiguous = mEntries[i].offset == i * mUniformSize;
+      bool sameSize = (i + 1 == mEntries.size()) ? mEntries[i].size <= mUniformSize : mEntries[i].size == mUniformSize;
+      if (!contiguous || !sameSize) {
+        mUniformSize = 0;
+        break;
+      }
+    }
+  }
+
+  /// Translates an offset in the buffer to a bus address
+  /// \return The bus address, or none if the offset is not in any entry
+  boost::optional<uintptr_t> translate(size_t offset) const
+  {
+    const Range* range = nullptr;
+    if (mUniformSize != 0) {
+      size_t index = offset / mUniformSize;
+      if (index < mEntries.size()) {
+        range = &mEntries[index];
+      }
+    } else {
+      auto next = std::upper_bound(mEntries.begin(), mEntries.end(), offset,
+                                   [](size_t value, const Range& range) { return value < range.offset; });
+      if (next != mEntries.begin()) {
+        range = &*(next - 1);
+      }
+    }
+
+    if (range == nullptr || offset - range->offset >= range->size) {
+      return boost::none;
+    }
+    return range->addressBus + (offset - range->offset);
+  }
+
+  /// Returns true if the entries are found by a division rather than a binary search
+  bool isUniform() const
+  {
+    return mUniformSize != 0;
+  }
+
+ private:
+  /// An entry, as a range of offsets of the buffer
+  struct Range {
+    size_t offset;
+    size_t size;
+    uintptr_t addressBus;
+  };
+
+  /// Entries ordered by offset
+  std::vector<Range> mEntries;
+
+  /// Size of the entries if they are uniform, else 0
+  size_t mUniformSize = 0;
+};
+
+} // namespace Pda
+} // namespace roc
+} // namespace o2
+
+#endif // O2_READOUTCARD_SRC_PDA_BUSADDRESSTRANSLATOR_H_
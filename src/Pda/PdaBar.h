@@ -58,6 +58,20 @@ class PdaBar : public BarInterface
     writeRegister(index, regValue);
   }
 
+  virtual void readRegisterBlock(int index, uint32_t* values, size_t count) override
+  {
+    if (count == 0) {
+      return;
+    }
+    uintptr_t byteOffset = index * sizeof(uint32_t);
+    assertRange<uint32_t>(byteOffset + (count - 1) * sizeof(uint32_t));
+    // One aligned 32-bit load per register, which memcpy does not guarantee
+    auto registers = reinterpret_cast<volatile uint32_t*>(getOffsetAddress(byteOffset));
+    for (size_t i = 0; i < count; ++i) {
+      values[i] = registers[i];
+    }
+  }
+
   virtual int getIndex() const override
   {
     return mBarNumber;
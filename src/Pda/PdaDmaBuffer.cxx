@@ -15,7 +15,11 @@
 /// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
 /// \author Kostas Alexopoulos (kostas.alexopoulos@cern.ch)
 
+#include <map>
+#include <mutex>
 #include <numeric>
+#include <thread>
+#include <tuple>
 #include "PdaDmaBuffer.h"
 #include <pda.h>
 #include "ExceptionInternal.h"
@@ -29,9 +33,16 @@ namespace roc
 {
 namespace Pda
 {
+namespace
+{
+/// Buffers registered through PdaDmaBuffer::getShared(), by PCI device, address and size
+using SharedBufferKey = std::tuple<PciDevice*, void*, size_t>;
+std::mutex sharedBuffersMutex;
+std::map<SharedBufferKey, std::weak_ptr<PdaDmaBuffer>> sharedBuffers;
+} // namespace
 
 PdaDmaBuffer::PdaDmaBuffer(PciDevice* pciDevice, void* userBufferAddress, size_t userBufferSize,
-                           int dmaBufferId, SerialId serialId, bool requireHugepage) : mPciDevice(pciDevice)
+                           int dmaBufferId, SerialId serialId, bool requireHugepage) : mDmaBufferId(dmaBufferId), mPciDevice(pciDevice)
 {
   // Safeguard against PDA kernel module deadlocks, since it does not like parallel buffer registration
   try {
@@ -85,8 +96,11 @@ PdaDmaBuffer::PdaDmaBuffer(PciDevice* pciDevice, void* userBufferAddress, size_t
 
     auto node = sgList;
     std::vector<size_t> nodeSizes;
+    std::vector<BusAddressTranslator::Entry> nodeEntries;
     while (node != nullptr) {
       nodeSizes.emplace_back(node->length);
+      nodeEntries.push_back(BusAddressTranslator::Entry{ node->length, reinterpret_cast<uintptr_t>(node->u_pointer),
+                                                         reinterpret_cast<uintptr_t>(node->d_pointer) });
       size_t hugePageMinSize = 1024 * 1024 * 2; // 2 MiB, the smallest hugepage size
       if (requireHugepage && node->length < hugePageMinSize) {
         BOOST_THROW_EXCEPTION(
@@ -98,6 +112,16 @@ PdaDmaBuffer::PdaDmaBuffer(PciDevice* pciDevice, void* userBufferAddress, size_t
       e.addressUser = reinterpret_cast<uintptr_t>(node->u_pointer);
       e.addressBus = reinterpret_cast<uintptr_t>(node->d_pointer);
       e.addressKernel = reinterpret_cast<uintptr_t>(node->k_pointer);
+
+      // Merge nodes that are adjacent both in userspace and on the bus, such as hugepages allocated back to back
+      if (!mScatterGatherVector.empty()) {
+        auto& last = mScatterGatherVector.back();
+        if (last.addressUser + last.size == e.addressUser && last.addressBus + last.size == e.addressBus) {
+          last.size += e.size;
+          node = node->next;
+          continue;
+        }
+      }
       mScatterGatherVector.push_back(e);
       node = node->next;
     }
@@ -107,6 +131,19 @@ PdaDmaBuffer::PdaDmaBuffer(PciDevice* pciDevice, void* userBufferAddress, size_t
                               "Failed to initialize scatter-gather list, was empty"));
     }
 
+    std::vector<BusAddressTranslator::Entry> entries;
+    for (const auto& entry : mScatterGatherVector) {
+      entries.push_back(BusAddressTranslator::Entry{ entry.size, entry.addressUser, entry.addressBus });
+    }
+    mBusAddressTranslator = BusAddressTranslator(entries);
+    if (!mBusAddressTranslator.isUniform()) {
+      // Merging may leave entries of different sizes, while the nodes of a hugepage buffer can be found by a division
+      BusAddressTranslator nodeTranslator(nodeEntries);
+      if (nodeTranslator.isUniform()) {
+        mBusAddressTranslator = std::move(nodeTranslator);
+      }
+    }
+
     // Print some stats regarding the Scatter-Gather list
     std::sort(nodeSizes.begin(), nodeSizes.end());
     int n = nodeSizes.size();
@@ -116,10 +153,10 @@ PdaDmaBuffer::PdaDmaBuffer(PciDevice* pciDevice, void* userBufferAddress, size_t
     if (n % 2 == 0) {
       median = (median + nodeSizes[n / 2 - 1]) / 2;
     }
-    long totalSize = std::accumulate(nodeSizes.begin(), nodeSizes.end(), 0);
+    size_t totalSize = std::accumulate(nodeSizes.begin(), nodeSizes.end(), size_t(0));
 
     Logger::get() << "[" << serialId << " |"
-                  << " PDA buffer SGL stats] #nodes: " << n << " | total: " << totalSize << " | min: " << minSize << " | max: " << maxSize << " | median: " << median << LogInfoDevel_(4204) << endm;
+                  << " PDA buffer SGL stats] #nodes: " << n << " | #merged nodes: " << mScatterGatherVector.size() << " | total: " << totalSize << " | min: " << minSize << " | max: " << maxSize << " | median: " << median << LogInfoDevel_(4204) << endm;
   } catch (const PdaException&) {
     PciDevice_deleteDMABuffer(mPciDevice, mDmaBuffer);
     throw;
@@ -146,26 +183,44 @@ PdaDmaBuffer::~PdaDmaBuffer()
   }
 }
 
-uintptr_t PdaDmaBuffer::getBusOffsetAddress(size_t offset) const
+std::shared_ptr<PdaDmaBuffer> PdaDmaBuffer::getShared(PciDevice* pciDevice, void* userBufferAddress,
+                                                     size_t userBufferSize, int dmaBufferId, SerialId serialId,
+                                                     bool requireHugepage)
 {
-  const auto& list = mScatterGatherVector;
-
-  auto userBase = list.at(0).addressUser;
-  auto userWithOffset = userBase + offset;
-
-  // First we find the SGL entry that contains our address
-  for (size_t i = 0; i < list.size(); ++i) {
-    auto entryUserStartAddress = list[i].addressUser;
-    auto entryUserEndAddress = entryUserStartAddress + list[i].size;
-
-    if ((userWithOffset >= entryUserStartAddress) && (userWithOffset < entryUserEndAddress)) {
-      // This is the entry we need
-      // We now need to calculate the difference from the start of this entry to the given offset. We make use of the
-      // fact that the userspace addresses will be contiguous
-      auto entryOffset = userWithOffset - entryUserStartAddress;
-      auto offsetBusAddress = list[i].addressBus + entryOffset;
-      return offsetBusAddress;
+  const SharedBufferKey key{ pciDevice, userBufferAddress, userBufferSize };
+  while (true) {
+    std::unique_lock<std::mutex> lock(sharedBuffersMutex);
+    auto iterator = sharedBuffers.find(key);
+    if (iterator != sharedBuffers.end()) {
+      if (auto buffer = iterator->second.lock()) {
+        Logger::get() << "[" << serialId << " |"
+                      << " PDA buffer] Sharing the registration of a buffer already registered by another channel with ID "
+                      << buffer->getDmaBufferId() << ", ID " << dmaBufferId << " is not used" << LogInfoDevel_(4226) << endm;
+        return buffer;
+      }
+      // The last user is deregistering it, wait for it to be done before registering again
+      lock.unlock();
+      std::this_thread::yield();
+      continue;
     }
+
+    // The deleter deregisters the buffer and forgets it under the lock, so that it is never registered twice
+    std::shared_ptr<PdaDmaBuffer> buffer(
+      new PdaDmaBuffer(pciDevice, userBufferAddress, userBufferSize, dmaBufferId, serialId, requireHugepage),
+      [key](PdaDmaBuffer* registered) {
+        std::lock_guard<std::mutex> registryLock(sharedBuffersMutex);
+        delete registered;
+        sharedBuffers.erase(key);
+      });
+    sharedBuffers[key] = buffer;
+    return buffer;
+  }
+}
+
+uintptr_t PdaDmaBuffer::getBusOffsetAddress(size_t offset) const
+{
+  if (auto address = mBusAddressTranslator.translate(offset)) {
+    return *address;
   }
 
   BOOST_THROW_EXCEPTION(Exception()
@@ -17,8 +17,10 @@
 #ifndef O2_READOUTCARD_SRC_PDA_PDADMABUFFER_H_
 #define O2_READOUTCARD_SRC_PDA_PDADMABUFFER_H_
 
+#include <memory>
 #include <vector>
 #include <pda.h>
+#include "Pda/BusAddressTranslator.h"
 #include "Pda/PdaDevice.h"
 #include "ReadoutCard/ParameterTypes/SerialId.h"
 
@@ -45,6 +47,16 @@ class PdaDmaBuffer
 
   ~PdaDmaBuffer();
 
+  /// Gives the registration of a buffer with a PCI device, shared by all its users in the process. The buffer is
+  /// registered by the first user, with its ID, and deregistered when the last one releases it, so that channels of a
+  /// device using the same buffer have a single registration and scatter-gather list. The IDs of the other users are
+  /// not registered, so their owners must not free the buffer by ID while the registration is shared.
+  /// Parameters are as for the constructor.
+  static std::shared_ptr<PdaDmaBuffer> getShared(PciDevice* pciDevice, void* userBufferAddress, size_t userBufferSize,
+                                                 int dmaBufferId, SerialId serialId, bool requireHugepage = true);
+
+  /// An entry of the scatter-gather list. Nodes of the PDA list that are adjacent both in userspace and in bus
+  /// address space are merged into one entry, whose kernel address is the one of the first node.
   struct ScatterGatherEntry {
     size_t size;
     uintptr_t addressUser;
@@ -61,10 +73,19 @@ class PdaDmaBuffer
   /// Function for getting the bus address that corresponds to the user address + given offset
   uintptr_t getBusOffsetAddress(size_t offset) const;
 
+  /// ID the buffer was registered with. For a shared registration, the one of the first user.
+  int getDmaBufferId() const
+  {
+    return mDmaBufferId;
+  }
+
  private:
   DMABuffer* mDmaBuffer;
+  int mDmaBufferId;
   PciDevice* mPciDevice;
   ScatterGatherVector mScatterGatherVector;
+  /// Lookup of the scatter-gather entries, built at registration
+  BusAddressTranslator mBusAddressTranslator;
 };
 
 } // namespace Pda
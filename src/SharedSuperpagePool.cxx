@@ -0,0 +1,163 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file SharedSuperpagePool.cxx
+/// \brief Implementation of the SharedSuperpagePool class.
+
+#include "ReadoutCard/SharedSuperpagePool.h"
+#include <algorithm>
+#include "ExceptionInternal.h"
+
+namespace o2
+{
+namespace roc
+{
+
+SharedSuperpagePool::SharedSuperpagePool(const std::vector<DmaChannelInterface*>& channels,
+                                         const buffer_parameters::Memory& buffer, size_t superpageSize)
+  : SuperpagePoolBase("SharedSuperpagePool", buffer), mChannels(channels)
+{
+  if (mChannels.empty() || std::count(mChannels.begin(), mChannels.end(), nullptr) > 0) {
+    BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("SharedSuperpagePool needs non-null channels"));
+  }
+  addSlots(mChannels, superpageSize, 0, buffer.size, boost::none, mFreeSlots);
+
+  // Equal shares, rounded up so that every channel gets a superpage
+  mStatistics.resize(mChannels.size());
+  for (auto& statistics : mStatistics) {
+    statistics.quota = (getSuperpageCount() + mChannels.size() - 1) / mChannels.size();
+  }
+}
+
+DmaChannelInterface& SharedSuperpagePool::getChannel(size_t channel) const
+{
+  if (channel >= mChannels.size()) {
+    BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("SharedSuperpagePool channel index out of range")
+                                               << ErrorInfo::Index(channel));
+  }
+  return *mChannels[channel];
+}
+
+void SharedSuperpagePool::setQuota(size_t channel, size_t superpages)
+{
+  getChannel(channel);
+  std::lock_guard<std::mutex> lock(mMutex);
+  mStatistics[channel].quota = superpages;
+}
+
+size_t SharedSuperpagePool::getQuota(size_t channel) const
+{
+  getChannel(channel);
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mStatistics[channel].quota;
+}
+
+size_t SharedSuperpagePool::refill(size_t channel)
+{
+  auto& dmaChannel = getChannel(channel);
+  const int available = dmaChannel.getTransferQueueAvailable();
+  if (available <= 0) {
+    return 0;
+  }
+
+  // Take the superpages under the lock, but push them without it, so other channels are not held back
+  std::vector<size_t> slots;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto& statistics = mStatistics[channel];
+    const size_t room = statistics.quota > statistics.held ? statistics.quota - statistics.held : 0;
+    const size_t count = std::min({ size_t(available), room, mFreeSlots.size() });
+    if (count < size_t(available)) {
+      statistics.starvedRefills++;
+    }
+    slots.assign(mFreeSlots.rbegin(), mFreeSlots.rbegin() + count);
+    mFreeSlots.resize(mFreeSlots.size() - count);
+    statistics.held += count;
+    statistics.peakHeld = std::max(statistics.peakHeld, statistics.held);
+  }
+
+  size_t pushed = 0;
+  PushStatus::type status = PushStatus::Ok;
+  for (; pushed < slots.size(); ++pushed) {
+    status = dmaChannel.tryPushSuperpage(getSlotSuperpage(slots[pushed]));
+    if (status != PushStatus::Ok) {
+      break;
+    }
+  }
+
+  {
+    // Give back the superpages that could not be pushed, in their order on the stack
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto& statistics = mStatistics[channel];
+    mFreeSlots.insert(mFreeSlots.end(), slots.rbegin(), slots.rend() - pushed);
+    statistics.held -= slots.size() - pushed;
+    statistics.superpagesPushed += pushed;
+  }
+
+  if (status == PushStatus::InvalidSuperpage) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("SharedSuperpagePool superpage rejected by the channel, "
+                                                            "the pool's buffer does not match the channel's")
+                                      << ErrorInfo::Index(channel)
+                                      << ErrorInfo::Offset(getSlotSuperpage(slots[pushed]).getOffset()));
+  }
+  return pushed;
+}
+
+auto SharedSuperpagePool::tryAcquire(size_t channel) -> Handle
+{
+  getChannel(channel);
+  return tryAcquireFrom(channel);
+}
+
+auto SharedSuperpagePool::acquire(size_t channel, std::chrono::microseconds timeout) -> Handle
+{
+  getChannel(channel);
+  return acquireFrom(channel, timeout);
+}
+
+DmaChannelInterface& SharedSuperpagePool::getPoolChannel(size_t channel) const
+{
+  return *mChannels[channel];
+}
+
+size_t SharedSuperpagePool::refillChannel(size_t channel)
+{
+  return refill(channel);
+}
+
+void SharedSuperpagePool::acquired(size_t channel)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  mStatistics[channel].superpagesAcquired++;
+}
+
+void SharedSuperpagePool::release(size_t channel, size_t slot)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  mFreeSlots.push_back(slot);
+  mStatistics[channel].held--;
+  mStatistics[channel].superpagesReleased++;
+}
+
+size_t SharedSuperpagePool::getFreeCount() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mFreeSlots.size();
+}
+
+auto SharedSuperpagePool::getStatistics(size_t channel) const -> ChannelStatistics
+{
+  getChannel(channel);
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mStatistics[channel];
+}
+
+} // namespace roc
+} // namespace o2
@@ -0,0 +1,35 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file Superpage.cxx
+/// \brief Implementation of the Superpage struct.
+
+#include "ReadoutCard/Superpage.h"
+#include <string>
+#include "ExceptionInternal.h"
+
+namespace o2
+{
+namespace roc
+{
+
+constexpr uint64_t Superpage::MAX_OFFSET;
+constexpr uint64_t Superpage::MAX_SIZE;
+constexpr uint64_t Superpage::MAX_ARRIVAL_TIME;
+
+void Superpage::throwOutOfRange(uint64_t value, uint64_t max, const char* field)
+{
+  BOOST_THROW_EXCEPTION(OutOfRangeException() << ErrorInfo::Message("Superpage " + std::string(field) + " " +
+                                                                    std::to_string(value) + " does not fit its field")
+                                              << ErrorInfo::Range(max));
+}
+
+} // namespace roc
+} // namespace o2
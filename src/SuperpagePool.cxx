@@ -0,0 +1,144 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file SuperpagePool.cxx
+/// \brief Implementation of the SuperpagePool class.
+
+#include "ReadoutCard/SuperpagePool.h"
+#include "ExceptionInternal.h"
+
+namespace o2
+{
+namespace roc
+{
+
+SuperpagePool::SuperpagePool(DmaChannelInterface& channel, const buffer_parameters::Memory& buffer, size_t superpageSize)
+  : SuperpagePoolBase("SuperpagePool", buffer), mChannel(channel), mBufferSize(buffer.size)
+{
+  addGroup(boost::none, 0, mBufferSize, superpageSize);
+}
+
+SuperpagePool::SuperpagePool(DmaChannelInterface& channel, const buffer_parameters::Memory& buffer,
+                             const std::map<uint32_t, size_t>& linkSuperpageSizes)
+  : SuperpagePoolBase("SuperpagePool", buffer), mChannel(channel), mBufferSize(buffer.size)
+{
+  if (linkSuperpageSizes.empty()) {
+    BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("SuperpagePool needs at least one link"));
+  }
+
+  // Shares are rounded down to the size granularity, so the superpages of every link start aligned
+  const size_t share = (mBufferSize / linkSuperpageSizes.size()) / SIZE_GRANULARITY * SIZE_GRANULARITY;
+  size_t offset = 0;
+  for (const auto& entry : linkSuperpageSizes) {
+    addGroup(entry.first, offset, share, entry.second);
+    offset += share;
+  }
+}
+
+void SuperpagePool::addGroup(boost::optional<uint32_t> linkId, size_t offset, size_t size, size_t superpageSize)
+{
+  Group group;
+  group.linkId = linkId;
+  addSlots({ &mChannel }, superpageSize, offset, size, linkId, group.freeSlots);
+  mSlotGroups.resize(getSuperpageCount(), mGroups.size());
+  mGroups.push_back(std::move(group));
+}
+
+size_t SuperpagePool::refill()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  size_t pushed = 0;
+  bool starved = false;
+
+  for (auto& group : mGroups) {
+    if (group.linkId) {
+      for (int available = mChannel.getTransferQueueAvailable(*group.linkId); available > 0; --available) {
+        if (group.freeSlots.empty()) {
+          starved = true;
+          break;
+        }
+        if (!mChannel.pushSuperpage(getSlotSuperpage(group.freeSlots.back()), *group.linkId)) {
+          // DMA is not started
+          break;
+        }
+        group.freeSlots.pop_back();
+        pushed++;
+      }
+      continue;
+    }
+
+    while (true) {
+      if (group.freeSlots.empty()) {
+        starved = mChannel.getTransferQueueAvailable() > 0;
+        break;
+      }
+      auto superpage = getSlotSuperpage(group.freeSlots.back());
+      auto status = mChannel.tryPushSuperpage(superpage);
+      if (status == PushStatus::InvalidSuperpage) {
+        BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("SuperpagePool superpage rejected by the channel, "
+                                                                "the pool's buffer does not match the channel's")
+                                          << ErrorInfo::Offset(superpage.getOffset()));
+      }
+      if (status != PushStatus::Ok) {
+        break;
+      }
+      group.freeSlots.pop_back();
+      pushed++;
+    }
+  }
+
+  mStatistics.superpagesPushed += pushed;
+  if (starved) {
+    mStatistics.starvedRefills++;
+  }
+  return pushed;
+}
+
+DmaChannelInterface& SuperpagePool::getPoolChannel(size_t) const
+{
+  return mChannel;
+}
+
+size_t SuperpagePool::refillChannel(size_t)
+{
+  return refill();
+}
+
+void SuperpagePool::acquired(size_t)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  mStatistics.superpagesAcquired++;
+}
+
+void SuperpagePool::release(size_t, size_t slot)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  mGroups[mSlotGroups[slot]].freeSlots.push_back(slot);
+  mStatistics.superpagesReleased++;
+}
+
+size_t SuperpagePool::getFreeCount() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  size_t count = 0;
+  for (const auto& group : mGroups) {
+    count += group.freeSlots.size();
+  }
+  return count;
+}
+
+auto SuperpagePool::getStatistics() const -> Statistics
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mStatistics;
+}
+
+} // namespace roc
+} // namespace o2
@@ -0,0 +1,152 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file SuperpagePoolBase.cxx
+/// \brief Implementation of the SuperpagePoolBase class.
+
+#include "ReadoutCard/SuperpagePoolBase.h"
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include "ExceptionInternal.h"
+
+namespace o2
+{
+namespace roc
+{
+
+constexpr size_t SuperpagePoolBase::SIZE_GRANULARITY;
+
+SuperpagePoolBase::Handle::Handle(SuperpagePoolBase* pool, size_t channel, size_t slot, const Superpage& superpage)
+  : mPool(pool), mChannel(channel), mSlot(slot), mSuperpage(superpage)
+{
+}
+
+SuperpagePoolBase::Handle::Handle(Handle&& other) noexcept
+  : mPool(other.mPool), mChannel(other.mChannel), mSlot(other.mSlot), mSuperpage(other.mSuperpage)
+{
+  other.mPool = nullptr;
+}
+
+auto SuperpagePoolBase::Handle::operator=(Handle&& other) noexcept -> Handle&
+{
+  if (this != &other) {
+    release();
+    mPool = other.mPool;
+    mChannel = other.mChannel;
+    mSlot = other.mSlot;
+    mSuperpage = other.mSuperpage;
+    other.mPool = nullptr;
+  }
+  return *this;
+}
+
+SuperpagePoolBase::Handle::~Handle()
+{
+  release();
+}
+
+char* SuperpagePoolBase::Handle::getData() const
+{
+  return mPool ? mPool->mBufferAddress + mSuperpage.getOffset() : nullptr;
+}
+
+void SuperpagePoolBase::Handle::release()
+{
+  if (mPool) {
+    mPool->release(mChannel, mSlot);
+    mPool = nullptr;
+  }
+}
+
+SuperpagePoolBase::SuperpagePoolBase(std::string name, const buffer_parameters::Memory& buffer)
+  : mName(std::move(name)), mBufferAddress(reinterpret_cast<char*>(buffer.address))
+{
+}
+
+void SuperpagePoolBase::addSlots(const std::vector<DmaChannelInterface*>& channels, size_t superpageSize, size_t offset,
+                                 size_t size, boost::optional<uint32_t> linkId, std::vector<size_t>& freeSlots)
+{
+  if (superpageSize == 0 || (superpageSize % SIZE_GRANULARITY) != 0 ||
+      superpageSize > std::numeric_limits<uint32_t>::max()) {
+    auto exception = ParameterException() << ErrorInfo::Message(mName + " superpage size must be a non-zero multiple of 32 KiB");
+    if (linkId) {
+      exception << ErrorInfo::LinkId(*linkId);
+    }
+    BOOST_THROW_EXCEPTION(exception);
+  }
+
+  // Only the superpages within the range that are contiguous in the bus address space of every channel
+  std::vector<size_t> offsets;
+  for (auto superpageOffset : channels.front()->getSuperpageOffsets(superpageSize)) {
+    if (superpageOffset >= offset && superpageOffset + superpageSize <= offset + size) {
+      offsets.push_back(superpageOffset);
+    }
+  }
+  for (size_t i = 1; i < channels.size(); ++i) {
+    auto channelOffsets = channels[i]->getSuperpageOffsets(superpageSize);
+    std::vector<size_t> common;
+    std::set_intersection(offsets.begin(), offsets.end(), channelOffsets.begin(), channelOffsets.end(),
+                          std::back_inserter(common));
+    offsets = std::move(common);
+  }
+
+  if (offsets.empty()) {
+    auto exception = ParameterException() << ErrorInfo::Message(mName + " buffer has no room for a bus-contiguous superpage")
+                                          << ErrorInfo::DmaBufferSize(size);
+    if (linkId) {
+      exception << ErrorInfo::LinkId(*linkId);
+    }
+    BOOST_THROW_EXCEPTION(exception);
+  }
+
+  // The free slots are a stack, so the superpages are first pushed in order of their offset
+  for (size_t i = 0; i < offsets.size(); ++i) {
+    freeSlots.push_back(mSlots.size() + offsets.size() - 1 - i);
+  }
+  for (auto superpageOffset : offsets) {
+    mSlots.push_back(Slot{ superpageOffset, superpageSize });
+  }
+}
+
+auto SuperpagePoolBase::tryAcquireFrom(size_t channel) -> Handle
+{
+  refillChannel(channel);
+  auto superpage = getPoolChannel(channel).tryPopSuperpage();
+  if (!superpage) {
+    return {};
+  }
+  size_t slot = findSlot(*superpage);
+  acquired(channel);
+  return Handle(this, channel, slot, *superpage);
+}
+
+auto SuperpagePoolBase::acquireFrom(size_t channel, std::chrono::microseconds timeout) -> Handle
+{
+  auto handle = tryAcquireFrom(channel);
+  if (!handle && getPoolChannel(channel).waitForReady(timeout)) {
+    handle = tryAcquireFrom(channel);
+  }
+  return handle;
+}
+
+size_t SuperpagePoolBase::findSlot(const Superpage& superpage) const
+{
+  auto next = std::upper_bound(mSlots.begin(), mSlots.end(), superpage.getOffset(),
+                               [](size_t offset, const Slot& slot) { return offset < slot.offset; });
+  if (next == mSlots.begin() || std::prev(next)->offset != superpage.getOffset()) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(mName + " popped a superpage it did not push")
+                                      << ErrorInfo::Offset(superpage.getOffset()));
+  }
+  return size_t(std::distance(mSlots.begin(), next)) - 1;
+}
+
+} // namespace roc
+} // namespace o2
@@ -0,0 +1,95 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file SuperpageQueue.h
+/// \brief Definition of the superpage queue and the non-throwing operations on it shared by the DMA channels
+
+#ifndef O2_READOUTCARD_SRC_SUPERPAGEQUEUE_H_
+#define O2_READOUTCARD_SRC_SUPERPAGEQUEUE_H_
+
+#include <cstddef>
+#include <boost/optional.hpp>
+#include "ReadoutCard/Superpage.h"
+#include "folly/ProducerConsumerQueue.h"
+
+namespace o2
+{
+namespace roc
+{
+
+/// Lock-free single-producer single-consumer queue of superpages
+using SuperpageQueue = folly::ProducerConsumerQueue<Superpage>;
+
+/// Gets a copy of the superpage at the front of the queue, if there is one
+inline boost::optional<Superpage> tryPeekFront(SuperpageQueue& queue)
+{
+  if (auto superpage = queue.frontPtr()) {
+    return *superpage;
+  }
+  return boost::none;
+}
+
+/// Pops the superpage at the front of the queue, if there is one
+inline boost::optional<Superpage> tryPopFront(SuperpageQueue& queue)
+{
+  if (auto superpage = queue.frontPtr()) {
+    Superpage popped = *superpage;
+    queue.popFront();
+    return popped;
+  }
+  return boost::none;
+}
+
+/// Pops up to maxCount superpages from the front of the queue into the given array
+/// \return The number of superpages popped
+inline size_t popFront(SuperpageQueue& queue, Superpage* superpages, size_t maxCount)
+{
+  size_t popped = 0;
+  while (popped < maxCount) {
+    auto superpage = queue.frontPtr();
+    if (superpage == nullptr) {
+      break;
+    }
+    superpages[popped] = *superpage;
+    queue.popFront();
+    popped++;
+  }
+  return popped;
+}
+
+/// Performs some basic checks on a superpage that is to be pushed into a buffer of the given size
+/// \return nullptr if the superpage is valid, else a static string describing the problem
+inline const char* getSuperpageError(const Superpage& superpage, size_t bufferSize)
+{
+  constexpr size_t sizeGranularity = 32 * 1024;
+
+  if (superpage.getSize() == 0) {
+    return "size == 0";
+  }
+
+  if ((superpage.getSize() % sizeGranularity) != 0) {
+    return "size not a multiple of 32 KiB";
+  }
+
+  if ((superpage.getOffset() + superpage.getSize()) > bufferSize) {
+    return "superpage out of range";
+  }
+
+  if ((superpage.getOffset() % 4) != 0) {
+    return "offset not 32-bit aligned";
+  }
+
+  return nullptr;
+}
+
+} // namespace roc
+} // namespace o2
+
+#endif // O2_READOUTCARD_SRC_SUPERPAGEQUEUE_H_
@@ -18,6 +18,7 @@
 #include <fstream>
 #include <sstream>
 #include <boost/format.hpp>
+#include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
 #include "ExceptionInternal.h"
 #include "Common/System.h"
@@ -61,6 +62,39 @@ int getNumaNode(const PciAddress& pciAddress)
   return result;
 }
 
+std::vector<int> getNumaNodeCpus(int numaNode)
+{
+  std::vector<int> cpus;
+  if (numaNode < 0) {
+    return cpus;
+  }
+
+  // The list has the form "0-7,16-23"
+  auto string = slurp((b::format("/sys/devices/system/node/node%d/cpulist") % numaNode).str());
+  b::trim(string);
+  if (string.empty()) {
+    return cpus;
+  }
+
+  std::vector<std::string> ranges;
+  b::split(ranges, string, b::is_any_of(","));
+  for (const auto& range : ranges) {
+    std::vector<std::string> bounds;
+    b::split(bounds, range, b::is_any_of("-"));
+    int first = 0;
+    int last = 0;
+    if (bounds.empty() || bounds.size() > 2 ||
+        !b::conversion::try_lexical_convert<int>(bounds.front(), first) ||
+        !b::conversion::try_lexical_convert<int>(bounds.back(), last)) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Failed to parse CPU list of numa node " + std::to_string(numaNode)));
+    }
+    for (int cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
 } // namespace Utilities
 } // namespace roc
 } // namespace o2
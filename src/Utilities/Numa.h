@@ -17,6 +17,7 @@
 #ifndef O2_READOUTCARD_SRC_UTILITIES_NUMA_H_
 #define O2_READOUTCARD_SRC_UTILITIES_NUMA_H_
 
+#include <vector>
 #include "ReadoutCard/ParameterTypes/PciAddress.h"
 
 namespace o2
@@ -28,6 +29,10 @@ namespace Utilities
 
 int getNumaNode(const PciAddress& pciAddress);
 
+/// Gets the CPUs of a NUMA node, as listed in `/sys/devices/system/node/node[N]/cpulist`
+/// \return The CPU numbers in increasing order, or an empty vector if the node does not exist
+std::vector<int> getNumaNodeCpus(int numaNode);
+
 } // namespace Utilities
 } // namespace roc
 } // namespace o2
@@ -0,0 +1,118 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+/// \file Polling.h
+/// \brief Helpers of the polling loops: backoff between unproductive polls, and counters with a single writer
+
+#ifndef O2_READOUTCARD_SRC_UTILITIES_POLLING_H_
+#define O2_READOUTCARD_SRC_UTILITIES_POLLING_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include "ReadoutCard/ParameterTypes/WaitPolicy.h"
+
+namespace o2
+{
+namespace roc
+{
+namespace Utilities
+{
+
+/// Adds to a counter that only one thread writes, while others may read it. A relaxed load and store is enough, and
+/// cheaper than an atomic read-modify-write.
+inline void addRelaxed(std::atomic<uint64_t>& counter, uint64_t value = 1)
+{
+  counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+/// Backs off between unproductive polls as set by a WaitPolicy: back-to-back polls first, then a yield between polls,
+/// then a sleep between polls
+class Backoff
+{
+ public:
+  /// What wait() did
+  enum class Step {
+    Spin,
+    Yield,
+    Sleep
+  };
+
+  explicit Backoff(const WaitPolicy& policy)
+    : mYieldStart(policy.spinPolls),
+      mSleepStart(mYieldStart + policy.yieldPolls),
+      mSleepTime(std::chrono::microseconds(policy.sleepMicroseconds))
+  {
+  }
+
+  /// Goes back to back-to-back polls, after a productive poll
+  void reset()
+  {
+    mEmptyPolls = 0;
+  }
+
+  /// Waits after an unproductive poll
+  /// \param maxSleep Longest sleep, for loops with a deadline
+  Step wait(std::chrono::steady_clock::duration maxSleep = std::chrono::steady_clock::duration::max())
+  {
+    auto emptyPolls = mEmptyPolls++;
+    if (emptyPolls >= mSleepStart) {
+      std::this_thread::sleep_for(std::min(mSleepTime, maxSleep));
+      return Step::Sleep;
+    } else if (emptyPolls >= mYieldStart) {
+      std::this_thread::yield();
+      return Step::Yield;
+    }
+    return Step::Spin;
+  }
+
+ private:
+  const uint64_t mYieldStart;
+  const uint64_t mSleepStart;
+  const std::chrono::steady_clock::duration mSleepTime;
+  uint64_t mEmptyPolls = 0;
+};
+
+/// Calls poll() until it returns true or the timeout expires, backing off between unproductive polls
+/// \param onEmptyPoll Called after each unproductive poll, with the step the backoff took, or with none when the
+///   timeout expired
+/// \return True if poll() returned true, false on timeout
+template <typename Poll, typename OnEmptyPoll>
+bool pollWithBackoff(const WaitPolicy& policy, std::chrono::microseconds timeout, Poll poll, OnEmptyPoll onEmptyPoll)
+{
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  Backoff backoff(policy);
+  while (true) {
+    if (poll()) {
+      return true;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (now >= deadline) {
+      onEmptyPoll(nullptr);
+      return false;
+    }
+    auto step = backoff.wait(deadline - now);
+    onEmptyPoll(&step);
+  }
+}
+
+template <typename Poll>
+bool pollWithBackoff(const WaitPolicy& policy, std::chrono::microseconds timeout, Poll poll)
+{
+  return pollWithBackoff(policy, timeout, poll, [](const Backoff::Step*) {});
+}
+
+} // namespace Utilities
+} // namespace roc
+} // namespace o2
+
+#endif // O2_READOUTCARD_SRC_UTILITIES_POLLING_H_
@@ -18,6 +18,7 @@
 #ifndef O2_READOUTCARD_SRC_UTILITIES_UTIL_H_
 #define O2_READOUTCARD_SRC_UTILITIES_UTIL_H_
 
+#include <cassert>
 #include <cstdint>
 #include <iomanip>
 #include <iostream>
@@ -0,0 +1,65 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file BenchBusAddressTranslator.cxx
+/// \brief Microbenchmark of the bus address translation, with synthetic scatter-gather lists. It only reports the time
+/// per lookup, and is not run by ctest.
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "SyntheticScatterGather.h"
+
+using namespace o2::roc::Pda;
+using namespace o2::roc::Pda::synthetic;
+
+int main()
+{
+  // 32 GiB of 2 MiB hugepages, translated at the superpage offsets of a run
+  constexpr size_t ENTRIES = 16384;
+  constexpr size_t LOOKUPS = 100000;
+  auto list = makeList(std::vector<size_t>(ENTRIES, 2 * MiB));
+  std::vector<size_t> offsets;
+  std::mt19937_64 random(42);
+  for (size_t i = 0; i < LOOKUPS; ++i) {
+    offsets.push_back((random() % (ENTRIES * 2)) * MiB);
+  }
+
+  // The sum keeps the lookups from being optimized away
+  uintptr_t sum = 0;
+  auto measure = [&](auto translate) {
+    auto start = std::chrono::steady_clock::now();
+    for (auto offset : offsets) {
+      sum += translate(offset).get_value_or(0);
+    }
+    auto nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return nanoseconds / offsets.size();
+  };
+
+  BusAddressTranslator uniform(list);
+  double uniformNs = measure([&](size_t offset) { return uniform.translate(offset); });
+
+  // Make the entries non-uniform without changing the lookups, to measure the binary search
+  auto mixed = list;
+  mixed.push_back(BusAddressTranslator::Entry{ 4 * MiB, list.back().addressUser + 2 * MiB, 0x10000 });
+  mixed.push_back(BusAddressTranslator::Entry{ 2 * MiB, list.back().addressUser + 6 * MiB, 0x20000 });
+  BusAddressTranslator search(mixed);
+  double searchNs = measure([&](size_t offset) { return search.translate(offset); });
+
+  // The linear scan is slow, so only a part of the lookups are timed
+  offsets.resize(LOOKUPS / 100);
+  double linearNs = measure([&](size_t offset) { return translateLinear(list, offset); });
+
+  std::cout << "ns per lookup over " << ENTRIES << " entries: uniform " << uniformNs << ", binary search " << searchNs
+            << ", linear scan " << linearNs << " (checksum " << sum << ")" << std::endl;
+  return 0;
+}
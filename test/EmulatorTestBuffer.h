@@ -0,0 +1,94 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file EmulatorTestBuffer.h
+/// \brief Buffer and parameters shared by the tests running on the software emulator DMA channels
+
+#ifndef O2_READOUTCARD_TEST_EMULATORTESTBUFFER_H_
+#define O2_READOUTCARD_TEST_EMULATORTESTBUFFER_H_
+
+#include <chrono>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "ReadoutCard/ChannelFactory.h"
+#include "ReadoutCard/DmaChannelInterface.h"
+#include "ReadoutCard/Parameters.h"
+
+namespace o2
+{
+namespace roc
+{
+namespace test
+{
+
+constexpr size_t SUPERPAGE_SIZE = 1024 * 1024;
+constexpr size_t SUPERPAGES = 8;
+constexpr size_t DMA_PAGE_SIZE = 8 * 1024;
+
+/// Buffer of equal superpages for emulator channels
+class EmulatorTestBuffer
+{
+ public:
+  explicit EmulatorTestBuffer(size_t superpageSize = SUPERPAGE_SIZE, size_t superpages = SUPERPAGES)
+    : mSuperpageSize(superpageSize), mSuperpages(superpages), mData(superpageSize * superpages)
+  {
+  }
+
+  buffer_parameters::Memory getMemory()
+  {
+    return { mData.data(), mData.size() };
+  }
+
+  const char* getData() const
+  {
+    return mData.data();
+  }
+
+  /// Parameters of an emulator channel using the buffer
+  Parameters makeParameters(Parameters::LinkMaskType links = { 0, 1 })
+  {
+    return Parameters::makeParameters(ChannelFactory::getDummySerialId(), 0)
+      .setBufferParameters(getMemory())
+      .setDmaPageSize(DMA_PAGE_SIZE)
+      .setLinkMask(links);
+  }
+
+  Superpage getSuperpage(size_t index) const
+  {
+    return Superpage(index * mSuperpageSize, mSuperpageSize);
+  }
+
+  /// Pushes every superpage of the buffer
+  void pushAll(DmaChannelInterface& channel) const
+  {
+    for (size_t i = 0; i < mSuperpages; ++i) {
+      BOOST_REQUIRE(channel.pushSuperpage(getSuperpage(i)));
+    }
+  }
+
+ private:
+  size_t mSuperpageSize;
+  size_t mSuperpages;
+  std::vector<char> mData;
+};
+
+/// Waits for a superpage to be ready and pops it
+inline Superpage waitAndPop(DmaChannelInterface& channel)
+{
+  BOOST_REQUIRE(channel.waitForReady(std::chrono::seconds(5)));
+  return channel.popSuperpage();
+}
+
+} // namespace test
+} // namespace roc
+} // namespace o2
+
+#endif // O2_READOUTCARD_TEST_EMULATORTESTBUFFER_H_
@@ -0,0 +1,72 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file FakeCruBar.h
+/// \brief Fake CRU BAR shared by the tests of the units reading the card registers
+
+#ifndef O2_READOUTCARD_TEST_FAKECRUBAR_H_
+#define O2_READOUTCARD_TEST_FAKECRUBAR_H_
+
+#include <map>
+#include "Cru/Constants.h"
+#include "ReadoutCard/RegisterReadWriteInterface.h"
+
+namespace o2
+{
+namespace roc
+{
+namespace test
+{
+
+/// BAR backed by a map of registers, counting the accesses
+class FakeCruBar : public RegisterReadWriteInterface
+{
+ public:
+  virtual uint32_t readRegister(int index) override
+  {
+    singleReads++;
+    return registers[index];
+  }
+
+  virtual void writeRegister(int index, uint32_t value) override
+  {
+    registers[index] = value;
+  }
+
+  virtual void modifyRegister(int, int, int, uint32_t) override
+  {
+  }
+
+  virtual void readRegisterBlock(int index, uint32_t* values, size_t count) override
+  {
+    blockReads++;
+    blockRegisters += count;
+    for (size_t i = 0; i < count; ++i) {
+      values[i] = registers[index + i];
+    }
+  }
+
+  void setSuperpageCount(uint32_t link, uint32_t count)
+  {
+    registers[Cru::Registers::LINK_SUPERPAGE_COUNT.get(link).index] = count;
+  }
+
+  std::map<int, uint32_t> registers;
+  size_t singleReads = 0;
+  size_t blockReads = 0;
+  size_t blockRegisters = 0;
+};
+
+} // namespace test
+} // namespace roc
+} // namespace o2
+
+#endif // O2_READOUTCARD_TEST_FAKECRUBAR_H_
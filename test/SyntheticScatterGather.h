@@ -0,0 +1,63 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file SyntheticScatterGather.h
+/// \brief Synthetic scatter-gather lists for the test and benchmark of the bus address translation
+
+#ifndef O2_READOUTCARD_TEST_SYNTHETICSCATTERGATHER_H_
+#define O2_READOUTCARD_TEST_SYNTHETICSCATTERGATHER_H_
+
+#include <vector>
+#include <boost/optional.hpp>
+#include "Pda/BusAddressTranslator.h"
+
+namespace o2
+{
+namespace roc
+{
+namespace Pda
+{
+namespace synthetic
+{
+
+constexpr size_t MiB = 1024 * 1024;
+constexpr uintptr_t USER_ADDRESS = 0x7f0000000000;
+
+/// Scatter-gather list of consecutive entries of the given sizes, scattered over the bus in reverse order
+inline std::vector<BusAddressTranslator::Entry> makeList(const std::vector<size_t>& sizes)
+{
+  std::vector<BusAddressTranslator::Entry> list;
+  uintptr_t user = USER_ADDRESS;
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    list.push_back(BusAddressTranslator::Entry{ sizes[i], user, 0x100000000 + (sizes.size() - i) * 64 * MiB });
+    user += sizes[i];
+  }
+  return list;
+}
+
+/// The linear scan that the translator replaces
+inline boost::optional<uintptr_t> translateLinear(const std::vector<BusAddressTranslator::Entry>& list, size_t offset)
+{
+  auto address = list.at(0).addressUser + offset;
+  for (const auto& entry : list) {
+    if (address >= entry.addressUser && address < entry.addressUser + entry.size) {
+      return entry.addressBus + (address - entry.addressUser);
+    }
+  }
+  return boost::none;
+}
+
+} // namespace synthetic
+} // namespace Pda
+} // namespace roc
+} // namespace o2
+
+#endif // O2_READOUTCARD_TEST_SYNTHETICSCATTERGATHER_H_
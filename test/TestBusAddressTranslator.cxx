@@ -0,0 +1,83 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestBusAddressTranslator.cxx
+/// \brief Tests of the bus address translation, with synthetic scatter-gather lists
+
+#define BOOST_TEST_MODULE RORC_TestBusAddressTranslator
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <random>
+#include <vector>
+#include "SyntheticScatterGather.h"
+
+using namespace o2::roc::Pda;
+using namespace o2::roc::Pda::synthetic;
+
+namespace
+{
+void checkAgainstLinear(const std::vector<BusAddressTranslator::Entry>& list, size_t bufferSize)
+{
+  BusAddressTranslator translator(list);
+  std::mt19937_64 random(42);
+  for (int i = 0; i < 10000; ++i) {
+    size_t offset = random() % (bufferSize + MiB);
+    BOOST_REQUIRE(translator.translate(offset) == translateLinear(list, offset));
+  }
+  // Entry boundaries
+  size_t offset = 0;
+  for (const auto& entry : list) {
+    BOOST_CHECK(translator.translate(offset) == translateLinear(list, offset));
+    BOOST_CHECK(translator.translate(offset + entry.size - 1) == translateLinear(list, offset + entry.size - 1));
+    offset += entry.size;
+  }
+  BOOST_CHECK(!translator.translate(bufferSize));
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TestUniformEntries)
+{
+  auto list = makeList(std::vector<size_t>(64, 2 * MiB));
+  BOOST_CHECK(BusAddressTranslator(list).isUniform());
+  checkAgainstLinear(list, 64 * 2 * MiB);
+
+  // A shorter last entry keeps the lookup uniform
+  list = makeList({ 2 * MiB, 2 * MiB, 2 * MiB, MiB });
+  BOOST_CHECK(BusAddressTranslator(list).isUniform());
+  checkAgainstLinear(list, 7 * MiB);
+}
+
+BOOST_AUTO_TEST_CASE(TestMixedEntries)
+{
+  // Mixed 2 MiB and 1 GiB hugepages, as with a buffer spanning both
+  std::vector<size_t> sizes;
+  size_t bufferSize = 0;
+  for (int i = 0; i < 40; ++i) {
+    sizes.push_back(i % 5 == 0 ? 1024 * MiB : 2 * MiB);
+    bufferSize += sizes.back();
+  }
+  auto list = makeList(sizes);
+  BOOST_CHECK(!BusAddressTranslator(list).isUniform());
+  checkAgainstLinear(list, bufferSize);
+}
+
+BOOST_AUTO_TEST_CASE(TestUnorderedEntries)
+{
+  // Entries listed out of userspace order are found too
+  auto list = makeList({ 2 * MiB, 2 * MiB, 2 * MiB });
+  std::swap(list[1], list[2]);
+  BusAddressTranslator translator(list);
+  BOOST_CHECK(translator.isUniform());
+  BOOST_CHECK(translator.translate(3 * MiB) == translateLinear(list, 3 * MiB));
+  BOOST_CHECK(translator.translate(5 * MiB) == translateLinear(list, 5 * MiB));
+  BOOST_CHECK(!BusAddressTranslator().translate(0));
+}
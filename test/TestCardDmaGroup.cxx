@@ -0,0 +1,136 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestCardDmaGroup.cxx
+/// \brief Tests for the CardDmaGroup, using emulator DMA channels
+
+#define BOOST_TEST_MODULE RORC_TestCardDmaGroup
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <map>
+#include <vector>
+#include "EmulatorTestBuffer.h"
+#include "ReadoutCard/CardDmaGroup.h"
+#include "ReadoutCard/ChannelFactory.h"
+#include "ReadoutCard/Exception.h"
+
+using namespace o2::roc;
+using namespace o2::roc::test;
+
+namespace
+{
+constexpr size_t CHANNELS = 3;
+
+/// Buffers and parameters of emulator channels, one per endpoint
+struct Fixture {
+  Fixture() : buffers(CHANNELS)
+  {
+    for (auto& buffer : buffers) {
+      parameters.push_back(buffer.makeParameters());
+    }
+  }
+
+  /// Pushes every superpage of the given channels
+  void pushAll(CardDmaGroup& group, const std::vector<size_t>& channels)
+  {
+    for (auto channel : channels) {
+      for (size_t i = 0; i < SUPERPAGES; ++i) {
+        BOOST_REQUIRE(group.pushSuperpage(channel, buffers[channel].getSuperpage(i)));
+      }
+    }
+  }
+
+  std::vector<EmulatorTestBuffer> buffers;
+  std::vector<Parameters> parameters;
+};
+
+/// Pops superpages until the given amount was ready, recycling each one to its channel
+std::map<size_t, size_t> readout(CardDmaGroup& group, size_t superpages)
+{
+  std::map<size_t, size_t> perChannel;
+  for (size_t i = 0; i < superpages; ++i) {
+    BOOST_REQUIRE(group.waitForReady(std::chrono::seconds(5)));
+    auto ready = group.tryPopSuperpage();
+    BOOST_REQUIRE(ready);
+    BOOST_REQUIRE(ready->superpage.isReady());
+    BOOST_CHECK_EQUAL(ready->superpage.getReceived(), SUPERPAGE_SIZE);
+    BOOST_CHECK(ready->pciAddress == group.getChannel(ready->channel).getPciAddress());
+    perChannel[ready->channel]++;
+    BOOST_REQUIRE(group.pushSuperpage(ready->channel, Superpage(ready->superpage.getOffset(), SUPERPAGE_SIZE)));
+  }
+  return perChannel;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TestMergedReadyQueue)
+{
+  Fixture fixture;
+  CardDmaGroup group(fixture.parameters);
+  BOOST_CHECK_EQUAL(group.getChannelCount(), CHANNELS);
+
+  // Nothing is queued before DMA starts
+  BOOST_CHECK(!group.pushSuperpage(0, Superpage(0, SUPERPAGE_SIZE)));
+  BOOST_CHECK_THROW(group.pushSuperpage(CHANNELS, Superpage(0, SUPERPAGE_SIZE)), ParameterException);
+
+  group.startDma();
+  fixture.pushAll(group, { 0, 1, 2 });
+  auto perChannel = readout(group, 4 * CHANNELS * SUPERPAGES);
+  group.stopDma();
+
+  // Every channel delivered to the merged queue
+  BOOST_CHECK_EQUAL(perChannel.size(), CHANNELS);
+  auto statistics = group.getStatistics();
+  BOOST_CHECK_GE(statistics.superpagesDelivered, 4 * CHANNELS * SUPERPAGES);
+  BOOST_CHECK_GE(statistics.superpagesPushed, statistics.superpagesDelivered);
+  BOOST_CHECK_GT(statistics.passes, 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestStopReclaimsSuperpages)
+{
+  Fixture fixture;
+  CardDmaGroup group(fixture.parameters);
+  group.startDma();
+  fixture.pushAll(group, { 0, 1, 2 });
+  group.stopDma();
+
+  // Every pushed superpage comes back, filled or not
+  size_t popped = 0;
+  while (auto ready = group.tryPopSuperpage()) {
+    popped++;
+  }
+  BOOST_CHECK_EQUAL(popped, CHANNELS * SUPERPAGES);
+  BOOST_CHECK(!group.pushSuperpage(0, Superpage(0, SUPERPAGE_SIZE)));
+}
+
+BOOST_AUTO_TEST_CASE(TestReadinessPolicy)
+{
+  Fixture fixture;
+  std::vector<std::shared_ptr<DmaChannelInterface>> channels;
+  for (const auto& parameters : fixture.parameters) {
+    channels.push_back(ChannelFactory().getDmaChannel(parameters));
+  }
+  CardDmaGroup::Options options;
+  options.pollPolicy = CardDmaGroup::PollPolicy::Readiness;
+  CardDmaGroup group(channels, options);
+
+  // Only the first and last channels are supplied; the idle one is never polled
+  group.startDma();
+  fixture.pushAll(group, { 0, 2 });
+  auto perChannel = readout(group, 4 * SUPERPAGES);
+  group.stopDma();
+
+  BOOST_CHECK_EQUAL(perChannel.count(1), 0);
+  BOOST_CHECK_GT(perChannel[0], 0);
+  BOOST_CHECK_GT(perChannel[2], 0);
+  BOOST_CHECK_THROW(CardDmaGroup(std::vector<std::shared_ptr<DmaChannelInterface>>{}, options), ParameterException);
+}
@@ -0,0 +1,128 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestCompletionRing.cxx
+/// \brief Tests for the CRORC superpage completion reader, with the firmware simulated in host memory
+
+#define BOOST_TEST_MODULE RORC_TestCompletionRing
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include "Crorc/CompletionRing.h"
+
+using namespace o2::roc;
+
+namespace
+{
+/// Superpage info buffer, with the firmware writes
+struct Firmware {
+  Firmware() : ring(&layout)
+  {
+    ring.reset();
+  }
+
+  /// Old firmware: only the size of the last superpage and the 8-bit counter
+  void fillCounter(uint32_t size)
+  {
+    layout.size = size;
+    layout.count = (layout.count + 1) & 0xff;
+  }
+
+  /// Firmware writing the ring
+  void fillRing(uint32_t size)
+  {
+    layout.ringMagic = CompletionRing::RING_MAGIC;
+    layout.sizes[layout.producerIndex % CompletionRing::RING_ENTRIES] = size;
+    layout.producerIndex = layout.producerIndex + 1;
+  }
+
+  std::vector<boost::optional<uint32_t>> consume(size_t maxSuperpages = 1000)
+  {
+    std::vector<boost::optional<uint32_t>> sizes;
+    size_t consumed = ring.consume(maxSuperpages, [&](boost::optional<uint32_t> size) { sizes.push_back(size); });
+    BOOST_CHECK_EQUAL(consumed, sizes.size());
+    return sizes;
+  }
+
+  CompletionRing::Layout layout;
+  CompletionRing ring;
+};
+
+using Sizes = std::vector<boost::optional<uint32_t>>;
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TestCounterScheme)
+{
+  Firmware firmware;
+  BOOST_CHECK(firmware.consume().empty());
+
+  // Several superpages filled between two polls: only the size of the last one is known
+  firmware.fillCounter(0x2000);
+  firmware.fillCounter(0x2000);
+  firmware.fillCounter(0x800);
+  BOOST_CHECK(firmware.consume() == Sizes({ boost::none, boost::none, 0x800u }));
+  BOOST_CHECK(!firmware.ring.isRingActive());
+  BOOST_CHECK(firmware.consume().empty());
+
+  // The counter wraps around
+  for (int i = 0; i < 300; ++i) {
+    firmware.fillCounter(0x2000);
+    BOOST_CHECK(firmware.consume() == Sizes({ 0x2000u }));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestCounterSchemeLimited)
+{
+  Firmware firmware;
+  firmware.fillCounter(0x2000);
+  firmware.fillCounter(0x100);
+
+  // The superpages not handed out are kept for the next call
+  BOOST_CHECK(firmware.consume(1) == Sizes({ boost::none }));
+  BOOST_CHECK(firmware.consume(1) == Sizes({ 0x100u }));
+}
+
+BOOST_AUTO_TEST_CASE(TestRingScheme)
+{
+  Firmware firmware;
+  firmware.fillRing(0x100);
+  firmware.fillRing(0x200);
+  firmware.fillRing(0x300);
+  BOOST_CHECK(firmware.consume(2) == Sizes({ 0x100u, 0x200u }));
+  BOOST_CHECK(firmware.ring.isRingActive());
+  BOOST_CHECK(firmware.consume() == Sizes({ 0x300u }));
+
+  // The ring and the producer index wrap around
+  for (uint32_t i = 0; i < 3 * CompletionRing::RING_ENTRIES; ++i) {
+    firmware.fillRing(i);
+    firmware.fillRing(i + 1);
+    BOOST_CHECK(firmware.consume() == Sizes({ i, i + 1 }));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestRingSchemeWithCounter)
+{
+  // Firmware writing the ring may keep updating the counter, the ring is preferred
+  Firmware firmware;
+  firmware.fillCounter(0x300);
+  firmware.fillRing(0x100);
+  firmware.fillRing(0x300);
+  BOOST_CHECK(firmware.consume() == Sizes({ 0x100u, 0x300u }));
+  BOOST_CHECK(firmware.ring.isRingActive());
+
+  // Reset forgets the scheme
+  firmware.ring.reset();
+  BOOST_CHECK(!firmware.ring.isRingActive());
+  firmware.fillCounter(0x100);
+  BOOST_CHECK(firmware.consume() == Sizes({ 0x100u }));
+  BOOST_CHECK(!firmware.ring.isRingActive());
+}
@@ -93,3 +93,26 @@ BOOST_AUTO_TEST_CASE(TestGetEventSize)
   BOOST_CHECK_EQUAL(getMemsize(reinterpret_cast<const char*>(link18Test2.data())), 256);
   BOOST_CHECK_EQUAL(getMemsize(reinterpret_cast<const char*>(link21Test1.data())), 256);
 }
+
+BOOST_AUTO_TEST_CASE(TestSetters)
+{
+  std::vector<uint32_t> rdh = link18Test1;
+  char* data = reinterpret_cast<char*>(rdh.data());
+
+  setLinkId(data, 21);
+  setMemsize(data, 0x2000);
+  setPacketCounter(data, 0xab);
+  setOffset(data, 0x2000);
+  setOrbit(data, 0x12345678);
+  setTriggerType(data, 1 << 9);
+
+  BOOST_CHECK_EQUAL(getLinkId(data), 21);
+  BOOST_CHECK_EQUAL(getMemsize(data), 0x2000);
+  BOOST_CHECK_EQUAL(getPacketCounter(data), 0xab);
+  BOOST_CHECK_EQUAL(getOffset(data), 0x2000);
+  BOOST_CHECK_EQUAL(getOrbit(data), 0x12345678);
+  BOOST_CHECK_EQUAL(getTriggerType(data), 1 << 9);
+
+  // The fields sharing the words are untouched
+  BOOST_CHECK_EQUAL(rdh[3] & 0xffff0000, link18Test1[3] & 0xffff0000);
+}
@@ -0,0 +1,128 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestEmulatorDmaChannel.cxx
+/// \brief Tests for the software emulator DMA channel, which needs no card
+
+#define BOOST_TEST_MODULE RORC_TestEmulatorDmaChannel
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <map>
+#include <vector>
+#include "DataFormat.h"
+#include "Emulator/EmulatorDmaChannel.h"
+#include "EmulatorTestBuffer.h"
+#include "Factory/ChannelFactoryUtils.h"
+
+using namespace o2::roc;
+using namespace o2::roc::test;
+
+namespace
+{
+struct Fixture {
+  Parameters makeParameters()
+  {
+    return buffer.makeParameters({ 0, 3 });
+  }
+
+  /// Pushes all superpages and waits until they are all ready
+  std::vector<Superpage> readAll(DmaChannelInterface& channel)
+  {
+    buffer.pushAll(channel);
+    std::vector<Superpage> ready;
+    while (ready.size() < SUPERPAGES) {
+      ready.push_back(waitAndPop(channel));
+    }
+    return ready;
+  }
+
+  const char* getPage(const Superpage& superpage, size_t page)
+  {
+    return buffer.getData() + superpage.getOffset() + page * DMA_PAGE_SIZE;
+  }
+
+  EmulatorTestBuffer buffer;
+};
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TestFactoryReturnsEmulator)
+{
+  Fixture fixture;
+  auto channel = ChannelFactoryUtils::dmaChannelFactoryHelper<DmaChannelInterface>(fixture.makeParameters());
+  BOOST_CHECK(nullptr != dynamic_cast<EmulatorDmaChannel*>(channel.get()));
+  BOOST_CHECK(channel->getCardType() == CardType::Cru);
+}
+
+BOOST_AUTO_TEST_CASE(TestPushIgnoredBeforeStart)
+{
+  Fixture fixture;
+  EmulatorDmaChannel channel(fixture.makeParameters());
+  BOOST_CHECK(!channel.pushSuperpage(Superpage(0, SUPERPAGE_SIZE)));
+  BOOST_CHECK_EQUAL(channel.getReadyQueueSize(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestRdhPattern)
+{
+  Fixture fixture;
+  EmulatorDmaChannel channel(fixture.makeParameters().setDataSource(DataSource::Ddg));
+  channel.startDma();
+  auto superpages = fixture.readAll(channel);
+  channel.stopDma();
+
+  std::map<int, uint32_t> packetCounters;
+  for (const auto& superpage : superpages) {
+    BOOST_REQUIRE(superpage.isReady());
+    BOOST_REQUIRE_EQUAL(superpage.getReceived(), SUPERPAGE_SIZE);
+    BOOST_REQUIRE(superpage.getLink() == 0 || superpage.getLink() == 3);
+
+    for (size_t i = 0; i < SUPERPAGE_SIZE / DMA_PAGE_SIZE; ++i) {
+      auto page = fixture.getPage(superpage, i);
+      BOOST_CHECK_EQUAL(DataFormat::getLinkId(page), uint32_t(superpage.getLink()));
+      BOOST_CHECK_EQUAL(DataFormat::getMemsize(page), DMA_PAGE_SIZE);
+      BOOST_CHECK_EQUAL(DataFormat::getOffset(page), DMA_PAGE_SIZE);
+      BOOST_CHECK_EQUAL(DataFormat::getPacketCounter(page), packetCounters[superpage.getLink()]++ % 256);
+    }
+  }
+  // The superpages are spread over both links
+  BOOST_CHECK(packetCounters[0] > 0);
+  BOOST_CHECK(packetCounters[3] > 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestStopReturnsUnfilledSuperpages)
+{
+  Fixture fixture;
+  // Slow enough that the superpages can't all be filled before DMA stops
+  EmulatorDmaChannel channel(fixture.makeParameters().setEmulatorDataRate(SUPERPAGE_SIZE));
+  channel.startDma();
+  fixture.buffer.pushAll(channel);
+  channel.stopDma();
+
+  auto statistics = channel.getStatistics();
+  BOOST_CHECK_EQUAL(statistics.bufferSize, SUPERPAGES * SUPERPAGE_SIZE);
+  BOOST_CHECK_EQUAL(statistics.superpagesReady, SUPERPAGES);
+  BOOST_CHECK_EQUAL(statistics.getBytesInDriver(), SUPERPAGES * SUPERPAGE_SIZE);
+
+  size_t unfilled = 0;
+  for (size_t i = 0; i < SUPERPAGES; ++i) {
+    auto superpage = channel.tryPopSuperpage();
+    BOOST_REQUIRE(superpage);
+    unfilled += superpage->isReady() ? 0 : 1;
+  }
+  BOOST_CHECK(unfilled > 0);
+  BOOST_CHECK(!channel.tryPopSuperpage());
+  BOOST_CHECK(channel.isTransferQueueEmpty());
+
+  // All the superpages are back with the user
+  statistics = channel.getStatistics();
+  BOOST_CHECK_EQUAL(statistics.getBytesInDriver(), 0);
+  BOOST_CHECK_EQUAL(statistics.getBytesHeldByUser(), SUPERPAGES * SUPERPAGE_SIZE);
+}
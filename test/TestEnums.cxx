@@ -16,6 +16,8 @@
 
 #include "ReadoutCard/CardType.h"
 #include "ReadoutCard/ParameterTypes/DataSource.h"
+#include "ReadoutCard/ParameterTypes/LinkSchedulerPolicy.h"
+#include "ReadoutCard/ParameterTypes/PushVerification.h"
 #include "ReadoutCard/ParameterTypes/ResetLevel.h"
 
 #define BOOST_TEST_MODULE RORC_TestEnums
@@ -46,6 +48,17 @@ BOOST_AUTO_TEST_CASE(EnumDataSourceConversion)
   checkEnumConversion<DataSource>({ DataSource::Diu, DataSource::Fee, DataSource::Internal, DataSource::Siu });
 }
 
+BOOST_AUTO_TEST_CASE(EnumLinkSchedulerPolicyConversion)
+{
+  checkEnumConversion<LinkSchedulerPolicy>({ LinkSchedulerPolicy::FreeSlot, LinkSchedulerPolicy::RateWeighted,
+                                             LinkSchedulerPolicy::Controlled });
+}
+
+BOOST_AUTO_TEST_CASE(EnumPushVerificationConversion)
+{
+  checkEnumConversion<PushVerification>({ PushVerification::Always, PushVerification::SizeOnly, PushVerification::Sampled });
+}
+
 BOOST_AUTO_TEST_CASE(EnumResetLevelConversion)
 {
   checkEnumConversion<ResetLevel>({ ResetLevel::Nothing, ResetLevel::Internal, ResetLevel::InternalSiu });
@@ -0,0 +1,154 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestInFlightController.cxx
+/// \brief Deterministic simulation of the InFlightController, with synthetic link rates
+
+#define BOOST_TEST_MODULE RORC_TestInFlightController
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include "Cru/InFlightController.h"
+#include "ReadoutCard/Exception.h"
+
+using namespace o2::roc;
+
+namespace
+{
+/// A simulated link. It fills `rate` superpages per update as long as it has superpages, and a filled superpage comes
+/// back to it `turnaround` updates later, so it needs rate * turnaround superpages in flight. With fewer, its FIFO runs
+/// empty, it completes only what it holds per turnaround, and the rest of its data is dropped.
+struct SimulatedLink {
+  size_t rate;
+  size_t turnaround;
+
+  size_t getNeed() const
+  {
+    return rate * turnaround;
+  }
+};
+
+/// Results of a simulation, over its last updates
+struct Results {
+  std::vector<size_t> starvedUpdates;
+  std::vector<size_t> targetSum;
+  size_t measuredUpdates;
+
+  double getMeanTarget(size_t link) const
+  {
+    return double(targetSum[link]) / measuredUpdates;
+  }
+};
+
+/// Runs the controller against the links, and measures the given amount of final updates
+Results simulate(InFlightController& controller, const std::vector<SimulatedLink>& links, size_t updates,
+                 size_t measuredUpdates)
+{
+  Results results{ std::vector<size_t>(links.size()), std::vector<size_t>(links.size()), measuredUpdates };
+  for (size_t update = 0; update < updates; ++update) {
+    std::vector<InFlightController::LinkObservation> observations(links.size());
+    uint64_t droppedPackets = 0;
+    for (size_t link = 0; link < links.size(); ++link) {
+      const auto target = controller.getTarget(link);
+      const bool starved = target < links[link].getNeed();
+      observations[link].completions = starved ? target / links[link].turnaround : links[link].rate;
+      observations[link].fifoEmptyEvents = starved ? 1 : 0;
+      droppedPackets += links[link].rate - observations[link].completions;
+
+      if (update + measuredUpdates >= updates) {
+        results.starvedUpdates[link] += starved ? 1 : 0;
+        results.targetSum[link] += target;
+      }
+    }
+    controller.update(observations, droppedPackets);
+  }
+  return results;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TestConvergence)
+{
+  const std::vector<SimulatedLink> links = { { 8, 2 }, { 4, 2 }, { 1, 3 }, { 0, 2 } };
+  InFlightController controller(links.size(), { 2, 64 });
+  auto results = simulate(controller, links, 2000, 1000);
+
+  for (size_t link = 0; link < links.size(); ++link) {
+    BOOST_TEST_MESSAGE("link " << link << ": need " << links[link].getNeed() << ", mean target "
+                               << results.getMeanTarget(link) << ", starved " << results.starvedUpdates[link] << "/1000");
+    // Rarely short of superpages, and without holding many more than needed
+    BOOST_CHECK_LE(results.starvedUpdates[link], 10);
+    BOOST_CHECK_LE(results.getMeanTarget(link), 1.5 * links[link].getNeed() + 2);
+  }
+  // The idle link is down to the minimum
+  BOOST_CHECK_EQUAL(controller.getTarget(3), 2);
+}
+
+BOOST_AUTO_TEST_CASE(TestRateIncrease)
+{
+  std::vector<SimulatedLink> links = { { 1, 2 } };
+  InFlightController controller(links.size(), { 1, 64 });
+  simulate(controller, links, 1000, 1);
+  BOOST_CHECK_LT(controller.getTarget(0), 8);
+
+  // The link gets busy: its target grows by half per update until it has enough superpages
+  links[0].rate = 16;
+  auto results = simulate(controller, links, 100, 100);
+  BOOST_CHECK_LE(results.starvedUpdates[0], 10);
+  BOOST_CHECK_GE(controller.getTarget(0), links[0].getNeed());
+}
+
+BOOST_AUTO_TEST_CASE(TestBounds)
+{
+  // The maximum holds even when the link needs more
+  const std::vector<SimulatedLink> links = { { 8, 2 }, { 0, 1 } };
+  InFlightController controller(links.size(), { 4, 6 });
+  BOOST_CHECK_EQUAL(controller.getTarget(0), 6);
+  auto results = simulate(controller, links, 500, 500);
+  BOOST_CHECK_EQUAL(results.getMeanTarget(0), 6);
+  BOOST_CHECK_EQUAL(controller.getTarget(1), 4);
+
+  controller.reset();
+  BOOST_CHECK_EQUAL(controller.getTarget(1), 6);
+
+  BOOST_CHECK_THROW(InFlightController(1, { 0, 4 }), ParameterException);
+  BOOST_CHECK_THROW(InFlightController(1, { 5, 4 }), ParameterException);
+}
+
+BOOST_AUTO_TEST_CASE(TestDroppedPacketsAttribution)
+{
+  InFlightController controller(3, { 1, 16 });
+  std::vector<InFlightController::LinkObservation> observations(3);
+
+  // Without a FIFO empty event, drops are blamed on the links that used up their target
+  observations[0].completions = 16;
+  observations[1].completions = 2;
+  auto decisions = controller.update(observations, 100);
+  BOOST_CHECK(decisions.empty()); // Already at the maximum
+
+  for (int i = 0; i < 40; ++i) {
+    controller.update(std::vector<InFlightController::LinkObservation>(3), 0);
+  }
+  BOOST_REQUIRE_EQUAL(controller.getTarget(0), 6);
+  observations[0].completions = 6;
+  decisions = controller.update(observations, 100);
+  BOOST_REQUIRE_EQUAL(decisions.size(), 1);
+  BOOST_CHECK_EQUAL(decisions[0].link, 0);
+  BOOST_CHECK_EQUAL(decisions[0].reason, InFlightController::Decision::DroppedPackets);
+  BOOST_CHECK_EQUAL(decisions[0].target, 9);
+
+  // A FIFO empty event takes precedence
+  observations[2].fifoEmptyEvents = 1;
+  decisions = controller.update(observations, 100);
+  BOOST_REQUIRE_EQUAL(decisions.size(), 1);
+  BOOST_CHECK_EQUAL(decisions[0].link, 2);
+  BOOST_CHECK_EQUAL(decisions[0].reason, InFlightController::Decision::FifoEmpty);
+}
@@ -0,0 +1,78 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestLinkCounters.cxx
+/// \brief Tests for the per-link DMA statistics counters
+
+#define BOOST_TEST_MODULE RORC_TestLinkCounters
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "LinkCounters.h"
+
+using namespace o2::roc;
+
+BOOST_AUTO_TEST_CASE(TestBuckets)
+{
+  BOOST_CHECK_EQUAL(LinkCounters::getBucket(0), 0);
+  BOOST_CHECK_EQUAL(LinkCounters::getBucket(999), 0);
+  BOOST_CHECK_EQUAL(LinkCounters::getBucket(1000), 1);
+  BOOST_CHECK_EQUAL(LinkCounters::getBucket(1999), 1);
+  BOOST_CHECK_EQUAL(LinkCounters::getBucket(2000), 2);
+  BOOST_CHECK_EQUAL(LinkCounters::getBucket(1000000), 10);
+  BOOST_CHECK_EQUAL(LinkCounters::getBucket(uint64_t(1) << 62), LinkStatistics::FILL_TIME_BUCKETS - 1);
+}
+
+BOOST_AUTO_TEST_CASE(TestCounts)
+{
+  LinkCounters counters(3, 4);
+  auto statistics = counters.get();
+  BOOST_CHECK_EQUAL(statistics.linkId, 3);
+  BOOST_CHECK_EQUAL(statistics.firmwareCapacity, 4);
+  BOOST_CHECK_EQUAL(statistics.superpagesInFirmware, 0);
+
+  // Superpages complete in push order, and their fill time is taken from their own push
+  counters.pushed(0);
+  counters.pushed(1000000);
+  counters.pushed(2000000);
+  counters.filled(100, 1500); // pushed at 0: 1.5 us
+  counters.filled(200, 1000000 + 5000); // pushed at 1 ms: 5 us
+  statistics = counters.get();
+  BOOST_CHECK_EQUAL(statistics.superpagesPushed, 3);
+  BOOST_CHECK_EQUAL(statistics.superpagesFilled, 2);
+  BOOST_CHECK_EQUAL(statistics.bytesReceived, 300);
+  BOOST_CHECK_EQUAL(statistics.superpagesInFirmware, 1);
+  BOOST_CHECK_EQUAL(statistics.fillTimes[1], 1);
+  BOOST_CHECK_EQUAL(statistics.fillTimes[3], 1);
+
+  counters.reclaimed();
+  statistics = counters.get();
+  BOOST_CHECK_EQUAL(statistics.superpagesReclaimed, 1);
+  BOOST_CHECK_EQUAL(statistics.superpagesInFirmware, 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestPushTimesWrapAround)
+{
+  LinkCounters counters(0, 2);
+  uint64_t now = 0;
+  for (int i = 0; i < 100; ++i) {
+    counters.pushed(now);
+    counters.pushed(now + 1000000);
+    // 500 us, then 1.5 ms after its push at 1 ms
+    counters.filled(8192, now + 500000);
+    counters.filled(8192, now + 2500000);
+    now += 10000000;
+  }
+  auto statistics = counters.get();
+  BOOST_CHECK_EQUAL(statistics.superpagesFilled, 200);
+  BOOST_CHECK_EQUAL(statistics.fillTimes[LinkCounters::getBucket(500000)], 100);
+  BOOST_CHECK_EQUAL(statistics.fillTimes[LinkCounters::getBucket(1500000)], 100);
+}
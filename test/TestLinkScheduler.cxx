@@ -0,0 +1,235 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestLinkScheduler.cxx
+/// \brief Tests for the policies deciding which CRU link gets the next superpage
+
+#define BOOST_TEST_MODULE RORC_TestLinkScheduler
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include "Cru/LinkScheduler.h"
+
+using namespace o2::roc;
+
+namespace
+{
+constexpr size_t LINKS = 4;
+constexpr size_t CAPACITY = 16;
+
+/// Takes all the slots the scheduler grants, counting the superpages in flight per link
+void takeAll(LinkScheduler& scheduler, std::vector<size_t>& inFlight)
+{
+  while (scheduler.getAvailable() > 0) {
+    int link = scheduler.takeSlot();
+    BOOST_REQUIRE(link >= 0);
+    inFlight[link]++;
+    BOOST_REQUIRE(inFlight[link] <= CAPACITY);
+  }
+  BOOST_CHECK_EQUAL(scheduler.takeSlot(), -1);
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TestFreeSlotSpreadsEvenly)
+{
+  FreeSlotLinkScheduler scheduler(LINKS, CAPACITY);
+  BOOST_CHECK_EQUAL(scheduler.getAvailable(), LINKS * CAPACITY);
+
+  // The first slots go round-robin over the links
+  for (size_t i = 0; i < 2 * LINKS; ++i) {
+    BOOST_CHECK_EQUAL(scheduler.takeSlot(), int(i % LINKS));
+  }
+
+  std::vector<size_t> inFlight(LINKS, 2);
+  takeAll(scheduler, inFlight);
+  for (auto count : inFlight) {
+    BOOST_CHECK_EQUAL(count, CAPACITY);
+  }
+
+  // Freed slots are handed out again in order
+  scheduler.releaseSlot(3, true);
+  scheduler.releaseSlot(1, true);
+  BOOST_CHECK_EQUAL(scheduler.getAvailable(), 2);
+  BOOST_CHECK_EQUAL(scheduler.takeSlot(), 3);
+  BOOST_CHECK_EQUAL(scheduler.takeSlot(), 1);
+  BOOST_CHECK_EQUAL(scheduler.takeSlot(), -1);
+
+  scheduler.reset();
+  BOOST_CHECK_EQUAL(scheduler.getAvailable(), LINKS * CAPACITY);
+}
+
+BOOST_AUTO_TEST_CASE(TestRateWeightedFollowsActiveLink)
+{
+  RateWeightedLinkScheduler scheduler(LINKS, CAPACITY);
+  std::vector<size_t> inFlight(LINKS, 0);
+
+  // Until rates are known, every link gets the minimum
+  takeAll(scheduler, inFlight);
+  for (auto count : inFlight) {
+    BOOST_CHECK_EQUAL(count, RateWeightedLinkScheduler::MIN_IN_FLIGHT);
+  }
+
+  // Only link 0 completes superpages
+  for (int round = 0; round < 100; ++round) {
+    while (inFlight[0] > 0) {
+      scheduler.releaseSlot(0, true);
+      inFlight[0]--;
+    }
+    takeAll(scheduler, inFlight);
+  }
+
+  BOOST_CHECK_EQUAL(scheduler.getTarget(0), CAPACITY);
+  BOOST_CHECK_EQUAL(inFlight[0], CAPACITY);
+  for (size_t link = 1; link < LINKS; ++link) {
+    BOOST_CHECK_EQUAL(scheduler.getTarget(link), RateWeightedLinkScheduler::MIN_IN_FLIGHT);
+    BOOST_CHECK_EQUAL(inFlight[link], RateWeightedLinkScheduler::MIN_IN_FLIGHT);
+  }
+
+  // Reclaiming superpages does not count as completions
+  scheduler.releaseSlot(2, false);
+  inFlight[2]--;
+  takeAll(scheduler, inFlight);
+  BOOST_CHECK_EQUAL(inFlight[2], RateWeightedLinkScheduler::MIN_IN_FLIGHT);
+}
+
+BOOST_AUTO_TEST_CASE(TestRateWeightedSharesByRate)
+{
+  RateWeightedLinkScheduler scheduler(LINKS, CAPACITY);
+  std::vector<size_t> inFlight(LINKS, 0);
+  takeAll(scheduler, inFlight);
+
+  // All links complete at the same rate, so all end up with a full queue, like the free slot policy
+  for (int round = 0; round < 100; ++round) {
+    for (size_t link = 0; link < LINKS; ++link) {
+      if (inFlight[link] > 0) {
+        scheduler.releaseSlot(link, true);
+        inFlight[link]--;
+      }
+    }
+    takeAll(scheduler, inFlight);
+  }
+
+  for (size_t link = 0; link < LINKS; ++link) {
+    BOOST_CHECK_EQUAL(scheduler.getTarget(link), CAPACITY);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestSlotsTakenOnLink)
+{
+  FreeSlotLinkScheduler freeSlot(LINKS, CAPACITY);
+  std::vector<size_t> inFlight(LINKS, 0);
+
+  // Slots taken on a link directly are no longer handed out
+  for (size_t i = 0; i < CAPACITY; ++i) {
+    freeSlot.takeSlotOnLink(2);
+  }
+  inFlight[2] = CAPACITY;
+  BOOST_CHECK_EQUAL(freeSlot.getAvailable(), (LINKS - 1) * CAPACITY);
+  takeAll(freeSlot, inFlight);
+
+  freeSlot.releaseSlot(2, true);
+  BOOST_CHECK_EQUAL(freeSlot.takeSlot(), 2);
+
+  RateWeightedLinkScheduler rateWeighted(LINKS, CAPACITY);
+  rateWeighted.takeSlotOnLink(1);
+  BOOST_CHECK_EQUAL(rateWeighted.getAvailable(), LINKS * RateWeightedLinkScheduler::MIN_IN_FLIGHT - 1);
+
+  // Going over the target does not take slots from the other links
+  for (size_t i = 0; i < CAPACITY - 1; ++i) {
+    rateWeighted.takeSlotOnLink(1);
+  }
+  BOOST_CHECK_EQUAL(rateWeighted.getAvailable(), (LINKS - 1) * RateWeightedLinkScheduler::MIN_IN_FLIGHT);
+}
+
+BOOST_AUTO_TEST_CASE(TestSlotTakenOnLinkReleasedFirst)
+{
+  // A superpage pushed to a link completes before the free slots are handed out: the link must not get an extra slot
+  FreeSlotLinkScheduler scheduler(LINKS, CAPACITY);
+  scheduler.takeSlotOnLink(3);
+  scheduler.releaseSlot(3, true);
+  BOOST_CHECK_EQUAL(scheduler.getAvailable(), LINKS * CAPACITY);
+
+  std::vector<size_t> inFlight(LINKS, 0);
+  takeAll(scheduler, inFlight);
+  for (auto count : inFlight) {
+    BOOST_CHECK_EQUAL(count, CAPACITY);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestControlled)
+{
+  ControlledLinkScheduler scheduler(LINKS, CAPACITY, { 2, 8 });
+  BOOST_CHECK_EQUAL(scheduler.getBounds().maxInFlight, 8);
+  std::vector<size_t> inFlight(LINKS, 0);
+
+  // Every link starts at the maximum
+  takeAll(scheduler, inFlight);
+  for (auto count : inFlight) {
+    BOOST_CHECK_EQUAL(count, 8);
+  }
+
+  // Only link 0 completes superpages: the idle links are lowered to the minimum
+  for (int round = 0; round < 100; ++round) {
+    for (int i = 0; i < 4; ++i) {
+      scheduler.releaseSlot(0, true);
+      inFlight[0]--;
+    }
+    takeAll(scheduler, inFlight);
+    scheduler.control(std::vector<uint64_t>(LINKS), 0);
+  }
+  for (size_t link = 1; link < LINKS; ++link) {
+    BOOST_CHECK_EQUAL(scheduler.getTarget(link), 2);
+  }
+  BOOST_CHECK_EQUAL(scheduler.getAvailable(), 0);
+
+  // The slots of an idle link come back once its in-flight count drops below the lowered target
+  for (size_t i = 0; i < 6; ++i) {
+    scheduler.releaseSlot(3, false);
+  }
+  inFlight[3] -= 6;
+  BOOST_CHECK_EQUAL(scheduler.getAvailable(), 0);
+  scheduler.releaseSlot(3, false);
+  inFlight[3]--;
+  BOOST_CHECK_EQUAL(scheduler.getAvailable(), 1);
+  BOOST_CHECK_EQUAL(scheduler.takeSlot(), 3);
+  inFlight[3]++;
+
+  // A FIFO empty event raises the target of its link at once, and the new slots go to it
+  for (size_t i = 0; i < 6; ++i) {
+    scheduler.releaseSlot(1, false);
+  }
+  inFlight[1] -= 6;
+  BOOST_CHECK_EQUAL(scheduler.getAvailable(), 0);
+  std::vector<uint64_t> fifoEmptyEvents(LINKS, 0);
+  fifoEmptyEvents[1] = 1;
+  auto decisions = scheduler.control(fifoEmptyEvents, 0);
+  BOOST_REQUIRE_EQUAL(decisions.size(), 1);
+  BOOST_CHECK_EQUAL(decisions[0].link, 1);
+  BOOST_CHECK_EQUAL(decisions[0].target, 3);
+  BOOST_CHECK_EQUAL(scheduler.getAvailable(), 1);
+  BOOST_CHECK_EQUAL(scheduler.takeSlot(), 1);
+  BOOST_CHECK_EQUAL(scheduler.takeSlot(), -1);
+
+  scheduler.reset();
+  BOOST_CHECK_EQUAL(scheduler.getTarget(1), 8);
+}
+
+BOOST_AUTO_TEST_CASE(TestCreate)
+{
+  auto freeSlot = LinkScheduler::create(LinkSchedulerPolicy::FreeSlot, LINKS, CAPACITY);
+  BOOST_CHECK(dynamic_cast<FreeSlotLinkScheduler*>(freeSlot.get()) != nullptr);
+  auto rateWeighted = LinkScheduler::create(LinkSchedulerPolicy::RateWeighted, LINKS, CAPACITY);
+  BOOST_CHECK(dynamic_cast<RateWeightedLinkScheduler*>(rateWeighted.get()) != nullptr);
+  auto controlled = LinkScheduler::create(LinkSchedulerPolicy::Controlled, LINKS, CAPACITY);
+  BOOST_REQUIRE(dynamic_cast<ControlledLinkScheduler*>(controlled.get()) != nullptr);
+  BOOST_CHECK_EQUAL(controlled->getAvailable(), LINKS * CAPACITY);
+}
@@ -0,0 +1,121 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestPdaDmaBuffer.cxx
+/// \brief Tests for the sharing of PDA buffer registrations between channels, against stubs of the PDA functions
+
+#define BOOST_TEST_MODULE RORC_TestPdaDmaBuffer
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include <pda.h>
+#include "DmaBufferProvider/PdaDmaBufferProvider.h"
+#include "Pda/PdaDmaBuffer.h"
+
+using namespace o2::roc;
+
+namespace
+{
+/// Calls made to the PDA stubs
+struct {
+  std::vector<uint64_t> registeredIds;
+  size_t deletes = 0;
+  DMABuffer_SGNode node;
+} stub;
+} // namespace
+
+// The stubs take the place of the PDA library functions, so that no device is needed
+extern "C" {
+PdaDebugReturnCode PciDevice_registerDMABuffer(PciDevice*, const uint64_t index, void* start, const size_t size,
+                                               DMABuffer** buffer)
+{
+  stub.registeredIds.push_back(index);
+  stub.node = { start, reinterpret_cast<void*>(0x100000000), start, size, nullptr };
+  *buffer = reinterpret_cast<DMABuffer*>(&stub.node);
+  return PDA_SUCCESS;
+}
+
+PdaDebugReturnCode PciDevice_getDMABuffer(PciDevice*, const uint64_t, DMABuffer**)
+{
+  return PDA_SUCCESS + 1;
+}
+
+PdaDebugReturnCode PciDevice_deleteDMABuffer(PciDevice*, DMABuffer*)
+{
+  stub.deletes++;
+  return PDA_SUCCESS;
+}
+
+PdaDebugReturnCode DMABuffer_getSGList(DMABuffer* buffer, DMABuffer_SGNode** list)
+{
+  *list = reinterpret_cast<DMABuffer_SGNode*>(buffer);
+  return PDA_SUCCESS;
+}
+}
+
+namespace
+{
+struct Fixture {
+  Fixture()
+  {
+    stub = {};
+  }
+
+  std::vector<char> buffer = std::vector<char>(4 * 1024 * 1024);
+  int devices[2] = {};
+  PciDevice* device = reinterpret_cast<PciDevice*>(&devices[0]);
+  PciDevice* otherDevice = reinterpret_cast<PciDevice*>(&devices[1]);
+  SerialId serialId{ 1234, 0 };
+};
+} // namespace
+
+BOOST_FIXTURE_TEST_CASE(TestSharedRegistration, Fixture)
+{
+  auto first = Pda::PdaDmaBuffer::getShared(device, buffer.data(), buffer.size(), 10, serialId, false);
+  auto second = Pda::PdaDmaBuffer::getShared(device, buffer.data(), buffer.size(), 11, serialId, false);
+  BOOST_CHECK(first == second);
+  BOOST_CHECK(stub.registeredIds == std::vector<uint64_t>({ 10 }));
+  BOOST_CHECK_EQUAL(second->getDmaBufferId(), 10);
+
+  // The registration outlives the user that made it
+  first.reset();
+  BOOST_CHECK_EQUAL(stub.deletes, 0);
+  second.reset();
+  BOOST_CHECK_EQUAL(stub.deletes, 1);
+
+  // And is made again by the next user
+  auto third = Pda::PdaDmaBuffer::getShared(device, buffer.data(), buffer.size(), 11, serialId, false);
+  BOOST_CHECK(stub.registeredIds == std::vector<uint64_t>({ 10, 11 }));
+}
+
+BOOST_FIXTURE_TEST_CASE(TestRegistrationPerDevice, Fixture)
+{
+  auto first = Pda::PdaDmaBuffer::getShared(device, buffer.data(), buffer.size(), 10, serialId, false);
+  auto second = Pda::PdaDmaBuffer::getShared(otherDevice, buffer.data(), buffer.size(), 10, serialId, false);
+  BOOST_CHECK(first != second);
+  BOOST_CHECK_EQUAL(stub.registeredIds.size(), 2);
+}
+
+BOOST_FIXTURE_TEST_CASE(TestProviderSharing, Fixture)
+{
+  // Channels must not free the buffers by ID while another one still uses the registration
+  auto first = std::make_unique<PdaDmaBufferProvider>(device, buffer.data(), buffer.size(), 10, serialId, false);
+  BOOST_CHECK(!first->isRegistrationShared());
+  {
+    PdaDmaBufferProvider second(device, buffer.data(), buffer.size(), 11, serialId, false);
+    BOOST_CHECK(first->isRegistrationShared());
+    BOOST_CHECK(second.isRegistrationShared());
+  }
+  BOOST_CHECK(!first->isRegistrationShared());
+  first.reset();
+  BOOST_CHECK_EQUAL(stub.deletes, 1);
+}
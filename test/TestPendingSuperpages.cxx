@@ -0,0 +1,98 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestPendingSuperpages.cxx
+/// \brief Tests for the superpages waiting for the driver thread to push them to the CRU links
+
+#define BOOST_TEST_MODULE RORC_TestPendingSuperpages
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <map>
+#include <vector>
+#include "Cru/PendingSuperpages.h"
+
+using namespace o2::roc;
+
+namespace
+{
+Superpage makeSuperpage(size_t index, int link)
+{
+  Superpage superpage(index * 32 * 1024, 32 * 1024);
+  superpage.setLink(link);
+  return superpage;
+}
+
+/// Targets with a given amount of room, recording the superpages pushed to each, the scheduler being -1
+struct Targets {
+  bool tryPush(const Superpage& superpage)
+  {
+    if (room[superpage.getLink()] == 0) {
+      return false;
+    }
+    room[superpage.getLink()]--;
+    pushed[superpage.getLink()].push_back(superpage.getOffset() / (32 * 1024));
+    return true;
+  }
+
+  std::map<int, size_t> room;
+  std::map<int, std::vector<size_t>> pushed;
+};
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TestStalledLink)
+{
+  PendingSuperpages pending(16);
+  Targets targets;
+  targets.room = { { -1, 8 }, { 1, 0 }, { 2, 8 } };
+  auto tryPush = [&](const Superpage& superpage) { return targets.tryPush(superpage); };
+
+  // Link 1 is full, the superpages behind its own still go to the other link and to the scheduler
+  BOOST_REQUIRE(pending.write(makeSuperpage(0, 1)));
+  BOOST_REQUIRE(pending.write(makeSuperpage(1, 2)));
+  BOOST_REQUIRE(pending.write(makeSuperpage(2, -1)));
+  BOOST_REQUIRE(pending.write(makeSuperpage(3, 1)));
+  BOOST_REQUIRE(pending.write(makeSuperpage(4, 2)));
+  BOOST_CHECK_EQUAL(pending.push(tryPush), 3);
+  BOOST_CHECK(targets.pushed[2] == std::vector<size_t>({ 1, 4 }));
+  BOOST_CHECK(targets.pushed[-1] == std::vector<size_t>({ 2 }));
+  BOOST_CHECK_EQUAL(pending.getSetAsideCount(), 2);
+
+  // A later superpage of the link waits behind the ones set aside, even if the link has room by then
+  BOOST_REQUIRE(pending.write(makeSuperpage(5, 1)));
+  targets.room[1] = 1;
+  BOOST_CHECK_EQUAL(pending.push(tryPush), 1);
+  BOOST_CHECK(targets.pushed[1] == std::vector<size_t>({ 0 }));
+  BOOST_CHECK_EQUAL(pending.getSetAsideCount(), 2);
+
+  targets.room[1] = 8;
+  BOOST_CHECK_EQUAL(pending.push(tryPush), 2);
+  BOOST_CHECK(targets.pushed[1] == std::vector<size_t>({ 0, 3, 5 }));
+  BOOST_CHECK_EQUAL(pending.getSetAsideCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestTakeAll)
+{
+  PendingSuperpages pending(16);
+  Targets targets;
+  targets.room = { { -1, 0 }, { 1, 0 } };
+  BOOST_REQUIRE(pending.write(makeSuperpage(0, 1)));
+  BOOST_REQUIRE(pending.write(makeSuperpage(1, -1)));
+  pending.push([&](const Superpage& superpage) { return targets.tryPush(superpage); });
+  BOOST_REQUIRE(pending.write(makeSuperpage(2, 1)));
+
+  // The superpages set aside come first, so that each target keeps its order
+  std::vector<size_t> taken;
+  pending.takeAll([&](const Superpage& superpage) { taken.push_back(superpage.getOffset() / (32 * 1024)); });
+  BOOST_CHECK(taken == std::vector<size_t>({ 0, 1, 2 }));
+  BOOST_CHECK_EQUAL(pending.getSetAsideCount(), 0);
+  BOOST_CHECK_EQUAL(pending.push([](const Superpage&) { return true; }), 0);
+}
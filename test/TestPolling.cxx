@@ -0,0 +1,68 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestPolling.cxx
+/// \brief Tests for the backoff of the polling loops
+
+#define BOOST_TEST_MODULE RORC_TestPolling
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include "Utilities/Polling.h"
+
+using namespace o2::roc;
+using Utilities::Backoff;
+
+BOOST_AUTO_TEST_CASE(TestBackoffSteps)
+{
+  WaitPolicy policy;
+  policy.spinPolls = 2;
+  policy.yieldPolls = 1;
+  policy.sleepMicroseconds = 1;
+  Backoff backoff(policy);
+
+  std::vector<Backoff::Step> steps;
+  for (int i = 0; i < 4; ++i) {
+    steps.push_back(backoff.wait());
+  }
+  BOOST_CHECK(steps == std::vector<Backoff::Step>({ Backoff::Step::Spin, Backoff::Step::Spin, Backoff::Step::Yield,
+                                                    Backoff::Step::Sleep }));
+
+  // A productive poll goes back to spinning
+  backoff.reset();
+  BOOST_CHECK(backoff.wait() == Backoff::Step::Spin);
+}
+
+BOOST_AUTO_TEST_CASE(TestPollWithBackoff)
+{
+  WaitPolicy policy;
+  policy.spinPolls = 1;
+  policy.yieldPolls = 1;
+  policy.sleepMicroseconds = 1;
+
+  int polls = 0;
+  int emptyPolls = 0;
+  BOOST_CHECK(Utilities::pollWithBackoff(
+    policy, std::chrono::seconds(5), [&] { return ++polls == 5; },
+    [&](const Backoff::Step* step) {
+      BOOST_CHECK(step);
+      emptyPolls++;
+    }));
+  BOOST_CHECK_EQUAL(emptyPolls, 4);
+
+  // The last unproductive poll reports the timeout
+  bool timedOut = false;
+  BOOST_CHECK(!Utilities::pollWithBackoff(
+    policy, std::chrono::microseconds(100), [] { return false; },
+    [&](const Backoff::Step* step) { timedOut = !step; }));
+  BOOST_CHECK(timedOut);
+}
@@ -0,0 +1,66 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestRegisterLock.cxx
+/// \brief Tests for the per-card register lock
+
+#define BOOST_TEST_MODULE RORC_TestRegisterLock
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <thread>
+#include "Crorc/RegisterLock.h"
+
+using namespace o2::roc;
+
+BOOST_AUTO_TEST_CASE(TestSharedPerCard)
+{
+  auto a = RegisterLock::get("01:00.0");
+  auto b = RegisterLock::get("01:00.0");
+  auto c = RegisterLock::get("02:00.0");
+  BOOST_CHECK(a == b);
+  BOOST_CHECK(a != c);
+
+  // Locks of different cards can be held at the same time
+  RegisterLock::Statistics statistics;
+  auto lockA = a->acquire(statistics);
+  auto lockC = c->acquire(statistics);
+  BOOST_CHECK_EQUAL(statistics.acquisitions, 2);
+  BOOST_CHECK_EQUAL(statistics.contentions, 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestReleasedWhenUnused)
+{
+  std::weak_ptr<RegisterLock> weak = RegisterLock::get("03:00.0");
+  BOOST_CHECK(weak.expired());
+}
+
+BOOST_AUTO_TEST_CASE(TestContention)
+{
+  auto lock = RegisterLock::get("04:00.0");
+  RegisterLock::Statistics holderStatistics;
+  RegisterLock::Statistics waiterStatistics;
+
+  auto held = lock->acquire(holderStatistics);
+  std::thread waiter([&] {
+    auto acquired = lock->acquire(waiterStatistics);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  held.unlock();
+  waiter.join();
+
+  BOOST_CHECK_EQUAL(holderStatistics.contentions, 0);
+  BOOST_CHECK_EQUAL(waiterStatistics.acquisitions, 1);
+  BOOST_CHECK_EQUAL(waiterStatistics.contentions, 1);
+  BOOST_CHECK_GE(waiterStatistics.maxWaitNanoseconds, 10000000);
+  BOOST_CHECK_EQUAL(waiterStatistics.totalWaitNanoseconds, waiterStatistics.maxWaitNanoseconds);
+}
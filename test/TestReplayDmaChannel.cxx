@@ -0,0 +1,144 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestReplayDmaChannel.cxx
+/// \brief Tests for the DMA channel replaying recorded data
+
+#define BOOST_TEST_MODULE RORC_TestReplayDmaChannel
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include "DataFormat.h"
+#include "Emulator/ReplayDmaChannel.h"
+#include "EmulatorTestBuffer.h"
+
+using namespace o2::roc;
+
+namespace
+{
+constexpr size_t SUPERPAGE_SIZE = 32 * 1024;
+constexpr size_t SUPERPAGES = 4;
+constexpr size_t PAGE_SIZE = 8 * 1024;
+
+/// Records pages of alternating links 0 and 2, one orbit apart, with a payload word holding the page number
+struct RecordedFile {
+  RecordedFile(size_t pages, uint32_t orbitStep = 1)
+    : path((boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string())
+  {
+    std::ofstream stream(path, std::ios::binary);
+    std::vector<char> page(PAGE_SIZE);
+    for (uint32_t i = 0; i < pages; ++i) {
+      std::fill(page.begin(), page.end(), 0);
+      DataFormat::setOffset(page.data(), PAGE_SIZE);
+      DataFormat::setMemsize(page.data(), PAGE_SIZE);
+      DataFormat::setLinkId(page.data(), (i % 2) * 2);
+      DataFormat::setOrbit(page.data(), i * orbitStep);
+      std::memcpy(&page[DataFormat::getHeaderSize()], &i, sizeof(i));
+      stream.write(page.data(), page.size());
+    }
+  }
+
+  ~RecordedFile()
+  {
+    boost::filesystem::remove(path);
+  }
+
+  std::string path;
+};
+
+struct Fixture {
+  Fixture() : buffer(SUPERPAGE_SIZE, SUPERPAGES) {}
+
+  Parameters makeParameters(const RecordedFile& file)
+  {
+    return buffer.makeParameters().setReplayFiles({ file.path });
+  }
+
+  /// Page number written in the payload of a page of a superpage
+  uint32_t getPageNumber(const Superpage& superpage, size_t page)
+  {
+    uint32_t number;
+    std::memcpy(&number, buffer.getData() + superpage.getOffset() + page * PAGE_SIZE + DataFormat::getHeaderSize(), sizeof(number));
+    return number;
+  }
+
+  test::EmulatorTestBuffer buffer;
+};
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TestPagesGoToTheirLink)
+{
+  RecordedFile file(8);
+  Fixture fixture;
+  ReplayDmaChannel channel(fixture.makeParameters(file));
+  BOOST_CHECK(channel.getDataTakingLinks() == std::vector<uint32_t>({ 0, 2 }));
+
+  channel.startDma();
+  fixture.buffer.pushAll(channel);
+  for (size_t i = 0; i < 2; ++i) {
+    auto superpage = test::waitAndPop(channel);
+    BOOST_REQUIRE(superpage.isReady());
+    BOOST_CHECK_EQUAL(superpage.getReceived(), SUPERPAGE_SIZE);
+
+    // Pages are packed in recorded order, link 0 got the even pages and link 2 the odd ones
+    for (size_t page = 0; page < SUPERPAGE_SIZE / PAGE_SIZE; ++page) {
+      BOOST_CHECK_EQUAL(fixture.getPageNumber(superpage, page), page * 2 + (superpage.getLink() == 2 ? 1 : 0));
+    }
+  }
+  channel.stopDma();
+
+  // The replay ended, so the other two superpages were returned unfilled
+  for (size_t i = 0; i < 2; ++i) {
+    auto superpage = channel.tryPopSuperpage();
+    BOOST_REQUIRE(superpage);
+    BOOST_CHECK(!superpage->isReady());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestLoop)
+{
+  RecordedFile file(4);
+  Fixture fixture;
+  ReplayDmaChannel channel(fixture.makeParameters(file).setReplayLoopEnabled(true));
+
+  channel.startDma();
+  fixture.buffer.pushAll(channel);
+  for (size_t i = 0; i < SUPERPAGES; ++i) {
+    auto superpage = test::waitAndPop(channel);
+    BOOST_REQUIRE(superpage.isReady());
+    BOOST_CHECK_EQUAL(superpage.getReceived(), SUPERPAGE_SIZE);
+    // Each link has two pages, which repeat
+    BOOST_CHECK_EQUAL(fixture.getPageNumber(superpage, 0), fixture.getPageNumber(superpage, 2));
+  }
+  channel.stopDma();
+}
+
+BOOST_AUTO_TEST_CASE(TestRealTimePacing)
+{
+  // Orbits 1000 apart, so the last page of the first superpage of link 0 is due after 6000 orbits, about 530 ms
+  RecordedFile file(8, 1000);
+  Fixture fixture;
+  ReplayDmaChannel channel(fixture.makeParameters(file).setReplaySpeed(1.0));
+
+  auto start = std::chrono::steady_clock::now();
+  channel.startDma();
+  fixture.buffer.pushAll(channel);
+  test::waitAndPop(channel);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  channel.stopDma();
+
+  BOOST_CHECK(elapsed >= std::chrono::nanoseconds(6000 * ReplayDmaChannel::ORBIT_NANOSECONDS));
+}
@@ -0,0 +1,110 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestRestartTracker.cxx
+/// \brief Tests for the decision to reset the CRU at DMA start, and the superpage counters the links start from
+
+#define BOOST_TEST_MODULE RORC_TestRestartTracker
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "Cru/RestartTracker.h"
+#include "FakeCruBar.h"
+
+using namespace o2::roc;
+using test::FakeCruBar;
+
+namespace
+{
+/// Tracker with fast restart enabled, on a card whose links 2 and 5 have counted superpages
+struct Fixture {
+  Fixture()
+  {
+    bar.setSuperpageCount(2, 40);
+    bar.setSuperpageCount(5, 70);
+    links.set(2);
+    links.set(5);
+  }
+
+  FakeCruBar bar;
+  SuperpageCountReader reader{ bar, true };
+  RestartTracker tracker{ reader, true };
+  SuperpageCountReader::LinkMask links;
+};
+} // namespace
+
+BOOST_FIXTURE_TEST_CASE(TestFirstStart, Fixture)
+{
+  // Nothing is known of the descriptors the card holds
+  BOOST_CHECK(tracker.start());
+  BOOST_CHECK_EQUAL(tracker.readStartCounts(links), 0);
+  BOOST_CHECK_EQUAL(bar.blockReads, 0);
+  BOOST_CHECK_EQUAL(tracker.getStartCount(2), 0);
+  BOOST_CHECK_EQUAL(tracker.getStartCount(5), 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(TestCleanStop, Fixture)
+{
+  tracker.start();
+
+  // The card carries on counting from where it stopped
+  BOOST_CHECK(!tracker.start());
+  BOOST_CHECK_EQUAL(tracker.readStartCounts(links), 4); // Links 2 to 5
+  BOOST_CHECK_EQUAL(bar.blockReads, 1);
+  BOOST_CHECK_EQUAL(tracker.getStartCount(2), 40);
+  BOOST_CHECK_EQUAL(tracker.getStartCount(5), 70);
+}
+
+BOOST_FIXTURE_TEST_CASE(TestStopWithReclaimedSuperpages, Fixture)
+{
+  tracker.start();
+  tracker.descriptorsLeft();
+
+  BOOST_CHECK(tracker.start());
+  BOOST_CHECK_EQUAL(tracker.readStartCounts(links), 0);
+  BOOST_CHECK_EQUAL(tracker.getStartCount(2), 0);
+
+  // The reset cleared the descriptors
+  BOOST_CHECK(!tracker.start());
+}
+
+BOOST_FIXTURE_TEST_CASE(TestStaleRemovedLink, Fixture)
+{
+  tracker.start();
+  tracker.readStartCounts(links);
+
+  // A link removed while the card held its descriptors, then a clean stop
+  tracker.descriptorsLeft();
+  BOOST_CHECK(tracker.start());
+  BOOST_CHECK_EQUAL(tracker.getStartCount(5), 0);
+
+  // Unless the card was reset in between
+  tracker.descriptorsLeft();
+  tracker.cardReset();
+  BOOST_CHECK(!tracker.start());
+}
+
+BOOST_AUTO_TEST_CASE(TestFastRestartDisabled)
+{
+  FakeCruBar bar;
+  SuperpageCountReader reader(bar, false);
+  RestartTracker tracker(reader, false);
+  SuperpageCountReader::LinkMask links;
+  links.set(0);
+  bar.setSuperpageCount(0, 10);
+
+  for (int i = 0; i < 3; ++i) {
+    BOOST_CHECK(tracker.start());
+    BOOST_CHECK_EQUAL(tracker.readStartCounts(links), 0);
+    BOOST_CHECK_EQUAL(tracker.getStartCount(0), 0);
+  }
+  BOOST_CHECK_EQUAL(bar.singleReads, 0);
+}
@@ -0,0 +1,138 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestSharedSuperpagePool.cxx
+/// \brief Tests for the SharedSuperpagePool, using emulator DMA channels sharing a buffer
+
+#define BOOST_TEST_MODULE RORC_TestSharedSuperpagePool
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <set>
+#include <vector>
+#include "Emulator/EmulatorDmaChannel.h"
+#include "EmulatorTestBuffer.h"
+#include "ReadoutCard/Exception.h"
+#include "ReadoutCard/SharedSuperpagePool.h"
+
+using namespace o2::roc;
+using namespace o2::roc::test;
+
+namespace
+{
+/// Two channels with the same buffer
+struct Fixture {
+  Fixture()
+    : memory(buffer.getMemory()),
+      channel0(buffer.makeParameters()),
+      channel1(buffer.makeParameters()),
+      pool({ &channel0, &channel1 }, memory, SUPERPAGE_SIZE)
+  {
+    channel0.startDma();
+    channel1.startDma();
+  }
+
+  ~Fixture()
+  {
+    channel0.stopDma();
+    channel1.stopDma();
+  }
+
+  SharedSuperpagePool::Handle waitAndAcquire(size_t channel)
+  {
+    auto handle = pool.acquire(channel, std::chrono::seconds(5));
+    BOOST_REQUIRE(handle);
+    BOOST_CHECK_EQUAL(handle.getChannel(), channel);
+    return handle;
+  }
+
+  EmulatorTestBuffer buffer;
+  buffer_parameters::Memory memory;
+  EmulatorDmaChannel channel0;
+  EmulatorDmaChannel channel1;
+  SharedSuperpagePool pool;
+};
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TestSharing)
+{
+  Fixture fixture;
+  BOOST_CHECK_EQUAL(fixture.pool.getSuperpageCount(), SUPERPAGES);
+  BOOST_CHECK_EQUAL(fixture.pool.getQuota(0), SUPERPAGES / 2);
+  BOOST_CHECK_EQUAL(fixture.pool.getQuota(1), SUPERPAGES / 2);
+
+  // Both channels fill superpages of the one buffer, and never hold more than their quota
+  std::set<size_t> offsets;
+  for (size_t i = 0; i < 2 * SUPERPAGES; ++i) {
+    for (size_t channel = 0; channel < 2; ++channel) {
+      auto handle = fixture.waitAndAcquire(channel);
+      BOOST_CHECK(handle->isReady());
+      BOOST_CHECK(handle.getData() == fixture.buffer.getData() + handle->getOffset());
+      offsets.insert(handle->getOffset());
+      BOOST_CHECK_LE(fixture.pool.getStatistics(channel).held, SUPERPAGES / 2);
+    }
+  }
+  // The channels took their superpages from the whole buffer, not from fixed halves
+  BOOST_CHECK_GT(offsets.size(), SUPERPAGES / 2);
+
+  for (size_t channel = 0; channel < 2; ++channel) {
+    auto statistics = fixture.pool.getStatistics(channel);
+    BOOST_CHECK_EQUAL(statistics.superpagesAcquired, 2 * SUPERPAGES);
+    BOOST_CHECK_EQUAL(statistics.superpagesReleased, 2 * SUPERPAGES);
+    BOOST_CHECK_LE(statistics.peakHeld, SUPERPAGES / 2);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestQuotaResize)
+{
+  Fixture fixture;
+  // A busy channel gets most of the buffer
+  fixture.pool.setQuota(0, SUPERPAGES - 2);
+  fixture.pool.setQuota(1, 2);
+
+  std::vector<SharedSuperpagePool::Handle> held;
+  while (held.size() < SUPERPAGES - 2) {
+    held.push_back(fixture.waitAndAcquire(0));
+  }
+  BOOST_CHECK_EQUAL(fixture.pool.refill(0), 0);
+  BOOST_CHECK_GT(fixture.pool.getStatistics(0).starvedRefills, 0);
+  BOOST_CHECK_EQUAL(fixture.pool.refill(1), 2);
+  BOOST_CHECK_EQUAL(fixture.pool.getFreeCount(), 0);
+
+  // Lowering the quota of a channel holding more keeps it from being refilled until it drops below
+  fixture.pool.setQuota(0, 1);
+  held.pop_back();
+  BOOST_CHECK_EQUAL(fixture.pool.getFreeCount(), 1);
+  BOOST_CHECK_EQUAL(fixture.pool.refill(0), 0);
+  BOOST_CHECK_EQUAL(fixture.pool.getStatistics(0).held, SUPERPAGES - 3);
+
+  // The freed superpage goes to the other channel once its quota is raised
+  fixture.pool.setQuota(1, 3);
+  BOOST_CHECK_EQUAL(fixture.pool.refill(1), 1);
+  BOOST_CHECK_EQUAL(fixture.pool.getStatistics(1).held, 3);
+}
+
+BOOST_AUTO_TEST_CASE(TestInvalidParameters)
+{
+  EmulatorTestBuffer buffer;
+  auto memory = buffer.getMemory();
+  EmulatorDmaChannel channel(buffer.makeParameters());
+
+  BOOST_CHECK_THROW(SharedSuperpagePool({}, memory, SUPERPAGE_SIZE), ParameterException);
+  BOOST_CHECK_THROW(SharedSuperpagePool({ &channel, nullptr }, memory, SUPERPAGE_SIZE), ParameterException);
+  BOOST_CHECK_THROW(SharedSuperpagePool({ &channel }, memory, 1000), ParameterException);
+  BOOST_CHECK_THROW(SharedSuperpagePool({ &channel }, memory, 2 * SUPERPAGES * SUPERPAGE_SIZE), ParameterException);
+
+  SharedSuperpagePool pool({ &channel }, memory, SUPERPAGE_SIZE);
+  BOOST_CHECK_EQUAL(pool.getQuota(0), SUPERPAGES);
+  BOOST_CHECK_THROW(pool.setQuota(1, 1), ParameterException);
+}
@@ -0,0 +1,84 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestSuperpage.cxx
+/// \brief Tests for the packed Superpage struct
+
+#define BOOST_TEST_MODULE RORC_TestSuperpage
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "ReadoutCard/Exception.h"
+#include "ReadoutCard/Superpage.h"
+
+using namespace o2::roc;
+
+BOOST_AUTO_TEST_CASE(TestDefaults)
+{
+  Superpage superpage;
+  BOOST_CHECK_EQUAL(superpage.getOffset(), 0);
+  BOOST_CHECK_EQUAL(superpage.getSize(), 0);
+  BOOST_CHECK_EQUAL(superpage.getReceived(), 0);
+  BOOST_CHECK(!superpage.isReady());
+  BOOST_CHECK_EQUAL(superpage.getLink(), -1);
+  BOOST_CHECK_EQUAL(superpage.getSequence(), 0);
+  BOOST_CHECK_EQUAL(superpage.getArrivalTime(), 0);
+  BOOST_CHECK(superpage.getUserData() == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(TestFields)
+{
+  int userData = 0;
+  const size_t offset = (size_t(1) << 47) + 4096; // Large buffers still fit in the packed offset
+  Superpage superpage(offset, 1024 * 1024, &userData);
+  superpage.setReceived(512 * 1024);
+  superpage.setReady(true);
+  superpage.setLink(23);
+  superpage.setSequence(0xffff);
+  superpage.setArrivalTime(uint64_t(1) << 54);
+
+  BOOST_CHECK_EQUAL(superpage.getOffset(), offset);
+  BOOST_CHECK_EQUAL(superpage.getSize(), 1024 * 1024);
+  BOOST_CHECK_EQUAL(superpage.getReceived(), 512 * 1024);
+  BOOST_CHECK(superpage.isReady());
+  BOOST_CHECK(!superpage.isFilled());
+  BOOST_CHECK_EQUAL(superpage.getLink(), 23);
+  BOOST_CHECK_EQUAL(superpage.getSequence(), 0xffff);
+  BOOST_CHECK_EQUAL(superpage.getArrivalTime(), uint64_t(1) << 54);
+  BOOST_CHECK(superpage.getUserData() == &userData);
+
+  superpage.setLink();
+  BOOST_CHECK_EQUAL(superpage.getLink(), -1);
+}
+
+BOOST_AUTO_TEST_CASE(TestFieldLimits)
+{
+  // The largest values that fit
+  Superpage superpage(Superpage::MAX_OFFSET, Superpage::MAX_SIZE);
+  superpage.setReceived(Superpage::MAX_SIZE);
+  superpage.setArrivalTime(Superpage::MAX_ARRIVAL_TIME);
+  BOOST_CHECK_EQUAL(superpage.getOffset(), Superpage::MAX_OFFSET);
+  BOOST_CHECK_EQUAL(superpage.getSize(), Superpage::MAX_SIZE);
+  BOOST_CHECK(superpage.isFilled());
+  BOOST_CHECK_EQUAL(superpage.getArrivalTime(), Superpage::MAX_ARRIVAL_TIME);
+
+  // One more throws, instead of wrapping into a wrong descriptor
+  BOOST_CHECK_THROW(Superpage(Superpage::MAX_OFFSET + 1, 1024), OutOfRangeException);
+  BOOST_CHECK_THROW(Superpage(0, Superpage::MAX_SIZE + 1), OutOfRangeException);
+  BOOST_CHECK_THROW(superpage.setOffset(Superpage::MAX_OFFSET + 1), OutOfRangeException);
+  BOOST_CHECK_THROW(superpage.setSize(Superpage::MAX_SIZE + 1), OutOfRangeException);
+  BOOST_CHECK_THROW(superpage.setReceived(Superpage::MAX_SIZE + 1), OutOfRangeException);
+  BOOST_CHECK_THROW(superpage.setArrivalTime(Superpage::MAX_ARRIVAL_TIME + 1), OutOfRangeException);
+
+  // The superpage is left as it was
+  BOOST_CHECK_EQUAL(superpage.getOffset(), Superpage::MAX_OFFSET);
+  BOOST_CHECK_EQUAL(superpage.getSize(), Superpage::MAX_SIZE);
+}
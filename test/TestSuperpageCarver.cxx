@@ -0,0 +1,143 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestSuperpageCarver.cxx
+/// \brief Tests for the SuperpageCarver, with synthetic scatter-gather lists
+
+#define BOOST_TEST_MODULE RORC_TestSuperpageCarver
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include "DmaBufferProvider/SuperpageCarver.h"
+
+using namespace o2::roc;
+
+namespace
+{
+constexpr size_t MiB = 1024 * 1024;
+constexpr uintptr_t USER_ADDRESS = 0x7f0000000000;
+
+/// Buffer made of consecutive scatter-gather entries, given by their size and bus address
+class SyntheticBuffer : public DmaBufferProviderInterface
+{
+ public:
+  struct Entry {
+    size_t size;
+    uintptr_t bus;
+  };
+
+  SyntheticBuffer(std::vector<Entry> entries) : mEntries(entries)
+  {
+    for (const auto& entry : mEntries) {
+      mSize += entry.size;
+    }
+  }
+
+  virtual uintptr_t getAddress() const override
+  {
+    return USER_ADDRESS;
+  }
+
+  virtual size_t getSize() const override
+  {
+    return mSize;
+  }
+
+  virtual size_t getScatterGatherListSize() const override
+  {
+    return mEntries.size();
+  }
+
+  virtual size_t getScatterGatherEntrySize(int index) const override
+  {
+    return mEntries.at(index).size;
+  }
+
+  virtual uintptr_t getScatterGatherEntryAddress(int index) const override
+  {
+    uintptr_t address = USER_ADDRESS;
+    for (int i = 0; i < index; ++i) {
+      address += mEntries[i].size;
+    }
+    return address;
+  }
+
+  virtual uintptr_t getBusOffsetAddress(size_t offset) const override
+  {
+    for (const auto& entry : mEntries) {
+      if (offset < entry.size) {
+        return entry.bus + offset;
+      }
+      offset -= entry.size;
+    }
+    return 0;
+  }
+
+ private:
+  std::vector<Entry> mEntries;
+  size_t mSize = 0;
+};
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TestContiguousBuffer)
+{
+  // With the IOMMU, the buffer is a single entry
+  SyntheticBuffer buffer({ { 64 * MiB, 0x100000000 } });
+  auto regions = SuperpageCarver::getContiguousRegions(buffer);
+  BOOST_REQUIRE_EQUAL(regions.size(), 1);
+  BOOST_CHECK_EQUAL(regions[0].offset, 0);
+  BOOST_CHECK_EQUAL(regions[0].size, 64 * MiB);
+  BOOST_CHECK_EQUAL(SuperpageCarver::carve(regions, 8 * MiB).size(), 8);
+  BOOST_CHECK_EQUAL(SuperpageCarver::carve(regions, 3 * MiB).size(), 21);
+}
+
+BOOST_AUTO_TEST_CASE(TestAdjacentHugepagesMerge)
+{
+  // Four 2 MiB hugepages: the first two and the last two are adjacent on the bus
+  SyntheticBuffer buffer({ { 2 * MiB, 0x10000000 },
+                           { 2 * MiB, 0x10200000 },
+                           { 2 * MiB, 0x50000000 },
+                           { 2 * MiB, 0x50200000 } });
+  auto regions = SuperpageCarver::getContiguousRegions(buffer);
+  BOOST_REQUIRE_EQUAL(regions.size(), 2);
+  BOOST_CHECK_EQUAL(regions[1].offset, 4 * MiB);
+  BOOST_CHECK_EQUAL(regions[1].size, 4 * MiB);
+
+  BOOST_CHECK(SuperpageCarver::carve(regions, 4 * MiB) == std::vector<size_t>({ 0, 4 * MiB }));
+  // A 3 MiB superpage fits in each region, wasting 1 MiB of each
+  BOOST_CHECK(SuperpageCarver::carve(regions, 3 * MiB) == std::vector<size_t>({ 0, 4 * MiB }));
+  BOOST_CHECK(SuperpageCarver::carve(regions, 8 * MiB).empty());
+}
+
+BOOST_AUTO_TEST_CASE(TestNoSuperpageStraddlesEntries)
+{
+  // Hugepages in reverse bus order are adjacent in userspace only
+  SyntheticBuffer buffer({ { 2 * MiB, 0x30000000 }, { 2 * MiB, 0x20000000 }, { 2 * MiB, 0x10000000 } });
+  auto regions = SuperpageCarver::getContiguousRegions(buffer);
+  BOOST_CHECK_EQUAL(regions.size(), 3);
+
+  auto offsets = SuperpageCarver::carve(regions, 1 * MiB);
+  BOOST_CHECK_EQUAL(offsets.size(), 6);
+  for (auto offset : offsets) {
+    // Contiguous in bus address space from the start to the last byte
+    BOOST_CHECK_EQUAL(buffer.getBusOffsetAddress(offset + MiB - 1), buffer.getBusOffsetAddress(offset) + MiB - 1);
+  }
+  BOOST_CHECK(SuperpageCarver::carve(regions, 4 * MiB).empty());
+}
+
+BOOST_AUTO_TEST_CASE(TestEmptyBuffer)
+{
+  SyntheticBuffer buffer({});
+  auto regions = SuperpageCarver::getContiguousRegions(buffer);
+  BOOST_CHECK(regions.empty());
+  BOOST_CHECK(SuperpageCarver::carve(regions, MiB).empty());
+}
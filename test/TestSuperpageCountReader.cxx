@@ -0,0 +1,87 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestSuperpageCountReader.cxx
+/// \brief Tests for the batched reading of the CRU superpage counters, against a fake BAR
+
+#define BOOST_TEST_MODULE RORC_TestSuperpageCountReader
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "Cru/SuperpageCountReader.h"
+#include "FakeCruBar.h"
+
+using namespace o2::roc;
+using test::FakeCruBar;
+
+namespace
+{
+SuperpageCountReader::LinkMask makeMask(std::initializer_list<uint32_t> links)
+{
+  SuperpageCountReader::LinkMask mask;
+  for (auto link : links) {
+    mask.set(link);
+  }
+  return mask;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TestReadPerLink)
+{
+  FakeCruBar bar;
+  for (uint32_t link = 0; link < Cru::MAX_LINKS; ++link) {
+    bar.setSuperpageCount(link, 100 + link);
+  }
+
+  SuperpageCountReader reader(bar, false);
+  BOOST_CHECK_EQUAL(reader.read(makeMask({ 1, 4, 11 })), 3);
+  BOOST_CHECK_EQUAL(bar.singleReads, 3);
+  BOOST_CHECK_EQUAL(bar.blockReads, 0);
+  BOOST_CHECK_EQUAL(reader.getSuperpageCount(1), 101);
+  BOOST_CHECK_EQUAL(reader.getSuperpageCount(4), 104);
+  BOOST_CHECK_EQUAL(reader.getSuperpageCount(11), 111);
+  BOOST_CHECK_EQUAL(reader.getSuperpageCount(2), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestReadBatched)
+{
+  FakeCruBar bar;
+  for (uint32_t link = 0; link < Cru::MAX_LINKS; ++link) {
+    bar.setSuperpageCount(link, 100 + link);
+  }
+
+  SuperpageCountReader reader(bar, true);
+  BOOST_CHECK_EQUAL(reader.read(makeMask({ 3, 5, 9 })), 7);
+  BOOST_CHECK_EQUAL(bar.singleReads, 0);
+  BOOST_CHECK_EQUAL(bar.blockReads, 1);
+  BOOST_CHECK_EQUAL(bar.blockRegisters, 7); // Links 3 to 9
+  BOOST_CHECK_EQUAL(reader.getSuperpageCount(3), 103);
+  BOOST_CHECK_EQUAL(reader.getSuperpageCount(5), 105);
+  BOOST_CHECK_EQUAL(reader.getSuperpageCount(9), 109);
+
+  // Counters outside of the block keep their value
+  bar.setSuperpageCount(3, 200);
+  bar.setSuperpageCount(15, 215);
+  BOOST_CHECK_EQUAL(reader.read(makeMask({ 15 })), 1);
+  BOOST_CHECK_EQUAL(bar.blockRegisters, 8);
+  BOOST_CHECK_EQUAL(reader.getSuperpageCount(3), 103);
+  BOOST_CHECK_EQUAL(reader.getSuperpageCount(15), 215);
+}
+
+BOOST_AUTO_TEST_CASE(TestReadNoLinks)
+{
+  FakeCruBar bar;
+  SuperpageCountReader batched(bar, true);
+  SuperpageCountReader perLink(bar, false);
+  BOOST_CHECK_EQUAL(batched.read({}), 0);
+  BOOST_CHECK_EQUAL(perLink.read({}), 0);
+  BOOST_CHECK_EQUAL(bar.singleReads + bar.blockReads, 0);
+}
@@ -0,0 +1,145 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestSuperpagePool.cxx
+/// \brief Tests for the SuperpagePool, using the emulator DMA channel
+
+#define BOOST_TEST_MODULE RORC_TestSuperpagePool
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <set>
+#include <vector>
+#include "Emulator/EmulatorDmaChannel.h"
+#include "EmulatorTestBuffer.h"
+#include "ReadoutCard/Exception.h"
+#include "ReadoutCard/SuperpagePool.h"
+
+using namespace o2::roc;
+using namespace o2::roc::test;
+
+namespace
+{
+struct Fixture {
+  Fixture() : memory(buffer.getMemory()), channel(buffer.makeParameters({ 0, 3 })) {}
+
+  SuperpagePool::Handle waitAndAcquire(SuperpagePool& pool)
+  {
+    auto handle = pool.acquire(std::chrono::seconds(5));
+    BOOST_REQUIRE(handle);
+    return handle;
+  }
+
+  EmulatorTestBuffer buffer;
+  buffer_parameters::Memory memory;
+  EmulatorDmaChannel channel;
+};
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TestCarving)
+{
+  Fixture fixture;
+  SuperpagePool pool(fixture.channel, fixture.memory, SUPERPAGE_SIZE);
+  BOOST_CHECK_EQUAL(pool.getSuperpageCount(), SUPERPAGES);
+  BOOST_CHECK_EQUAL(pool.getFreeCount(), SUPERPAGES);
+
+  // Superpages past the end of the buffer are not carved
+  SuperpagePool odd(fixture.channel, fixture.memory, 3 * SUPERPAGE_SIZE);
+  BOOST_CHECK_EQUAL(odd.getSuperpageCount(), SUPERPAGES / 3);
+
+  BOOST_CHECK_THROW(SuperpagePool(fixture.channel, fixture.memory, 1000), ParameterException);
+  BOOST_CHECK_THROW(SuperpagePool(fixture.channel, fixture.memory, 2 * SUPERPAGES * SUPERPAGE_SIZE), ParameterException);
+  BOOST_CHECK_THROW(SuperpagePool(fixture.channel, fixture.memory, std::map<uint32_t, size_t>{}), ParameterException);
+}
+
+BOOST_AUTO_TEST_CASE(TestRecycling)
+{
+  Fixture fixture;
+  SuperpagePool pool(fixture.channel, fixture.memory, SUPERPAGE_SIZE);
+
+  // Nothing is pushed before DMA starts
+  BOOST_CHECK_EQUAL(pool.refill(), 0);
+  BOOST_CHECK(!pool.tryAcquire());
+
+  fixture.channel.startDma();
+  std::set<size_t> offsets;
+  for (size_t i = 0; i < 3 * SUPERPAGES; ++i) {
+    auto handle = fixture.waitAndAcquire(pool);
+    BOOST_CHECK(handle->isReady());
+    BOOST_CHECK_EQUAL(handle->getReceived(), SUPERPAGE_SIZE);
+    BOOST_CHECK(handle.getData() == fixture.buffer.getData() + handle->getOffset());
+    offsets.insert(handle->getOffset());
+  }
+  fixture.channel.stopDma();
+
+  // Every superpage was used, and went back to the pool
+  BOOST_CHECK_EQUAL(offsets.size(), SUPERPAGES);
+  auto statistics = pool.getStatistics();
+  BOOST_CHECK_EQUAL(statistics.superpagesAcquired, 3 * SUPERPAGES);
+  BOOST_CHECK_EQUAL(statistics.superpagesReleased, 3 * SUPERPAGES);
+  BOOST_CHECK_GE(statistics.superpagesPushed, 3 * SUPERPAGES);
+}
+
+BOOST_AUTO_TEST_CASE(TestBackpressure)
+{
+  Fixture fixture;
+  SuperpagePool pool(fixture.channel, fixture.memory, SUPERPAGE_SIZE);
+  fixture.channel.startDma();
+
+  // The user holds every superpage, so none can be pushed
+  std::vector<SuperpagePool::Handle> held;
+  while (held.size() < SUPERPAGES) {
+    held.push_back(fixture.waitAndAcquire(pool));
+  }
+  BOOST_CHECK_EQUAL(pool.getFreeCount(), 0);
+  BOOST_CHECK_EQUAL(pool.refill(), 0);
+  BOOST_CHECK_GT(pool.getStatistics().starvedRefills, 0);
+
+  // A released superpage is pushed again by the next refill
+  held.back().release();
+  BOOST_CHECK(!held.back());
+  BOOST_CHECK_EQUAL(pool.getFreeCount(), 1);
+  BOOST_CHECK_EQUAL(pool.refill(), 1);
+  BOOST_CHECK_EQUAL(pool.getFreeCount(), 0);
+
+  // Moving a handle does not release it
+  auto moved = std::move(held.front());
+  BOOST_CHECK(moved);
+  BOOST_CHECK_EQUAL(pool.getFreeCount(), 0);
+  fixture.channel.stopDma();
+}
+
+BOOST_AUTO_TEST_CASE(TestLinkSizes)
+{
+  Fixture fixture;
+  SuperpagePool pool(fixture.channel, fixture.memory, { { 0, SUPERPAGE_SIZE }, { 3, SUPERPAGE_SIZE / 2 } });
+  // Each link gets half of the buffer
+  BOOST_CHECK_EQUAL(pool.getSuperpageCount(), SUPERPAGES / 2 + SUPERPAGES);
+
+  fixture.channel.startDma();
+  size_t superpagesOfLink3 = 0;
+  for (size_t i = 0; i < 2 * SUPERPAGES; ++i) {
+    auto handle = fixture.waitAndAcquire(pool);
+    BOOST_REQUIRE(handle->isReady());
+    if (handle->getLink() == 3) {
+      superpagesOfLink3++;
+      BOOST_CHECK_EQUAL(handle->getSize(), SUPERPAGE_SIZE / 2);
+      BOOST_CHECK_GE(handle->getOffset(), SUPERPAGES * SUPERPAGE_SIZE / 2);
+    } else {
+      BOOST_CHECK_EQUAL(handle->getLink(), 0);
+      BOOST_CHECK_EQUAL(handle->getSize(), SUPERPAGE_SIZE);
+      BOOST_CHECK_LT(handle->getOffset(), SUPERPAGES * SUPERPAGE_SIZE / 2);
+    }
+  }
+  fixture.channel.stopDma();
+  BOOST_CHECK_GT(superpagesOfLink3, 0);
+}
@@ -0,0 +1,84 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestSuperpageQueue.cxx
+/// \brief Tests for the non-throwing superpage queue operations used by the DMA channels
+
+#define BOOST_TEST_MODULE RORC_TestSuperpageQueue
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "SuperpageQueue.h"
+
+using namespace o2::roc;
+
+namespace
+{
+constexpr size_t SUPERPAGE_SIZE = 1024 * 1024;
+constexpr size_t BUFFER_SIZE = 16 * SUPERPAGE_SIZE;
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TestTryPeekAndPopEmptyQueue)
+{
+  SuperpageQueue queue{ 4 };
+  BOOST_CHECK(!tryPeekFront(queue));
+  BOOST_CHECK(!tryPopFront(queue));
+
+  Superpage superpages[2];
+  BOOST_CHECK_EQUAL(popFront(queue, superpages, 2), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestTryPeekDoesNotPop)
+{
+  SuperpageQueue queue{ 4 };
+  queue.write(Superpage(SUPERPAGE_SIZE, SUPERPAGE_SIZE));
+
+  auto peeked = tryPeekFront(queue);
+  BOOST_REQUIRE(peeked);
+  BOOST_CHECK_EQUAL(peeked->getOffset(), SUPERPAGE_SIZE);
+  BOOST_CHECK_EQUAL(queue.sizeGuess(), 1);
+
+  auto popped = tryPopFront(queue);
+  BOOST_REQUIRE(popped);
+  BOOST_CHECK_EQUAL(popped->getOffset(), SUPERPAGE_SIZE);
+  BOOST_CHECK(queue.isEmpty());
+}
+
+BOOST_AUTO_TEST_CASE(TestPopFrontKeepsOrder)
+{
+  SuperpageQueue queue{ 8 };
+  for (size_t i = 0; i < 5; ++i) {
+    queue.write(Superpage(i * SUPERPAGE_SIZE, SUPERPAGE_SIZE));
+  }
+
+  Superpage superpages[3];
+  BOOST_CHECK_EQUAL(popFront(queue, superpages, 3), 3);
+  for (size_t i = 0; i < 3; ++i) {
+    BOOST_CHECK_EQUAL(superpages[i].getOffset(), i * SUPERPAGE_SIZE);
+  }
+
+  // Only two are left, so the batch is short
+  BOOST_CHECK_EQUAL(popFront(queue, superpages, 3), 2);
+  BOOST_CHECK_EQUAL(superpages[0].getOffset(), 3 * SUPERPAGE_SIZE);
+  BOOST_CHECK_EQUAL(superpages[1].getOffset(), 4 * SUPERPAGE_SIZE);
+  BOOST_CHECK(queue.isEmpty());
+}
+
+BOOST_AUTO_TEST_CASE(TestSuperpageValidation)
+{
+  BOOST_CHECK(getSuperpageError(Superpage(0, SUPERPAGE_SIZE), BUFFER_SIZE) == nullptr);
+  BOOST_CHECK(getSuperpageError(Superpage(BUFFER_SIZE - SUPERPAGE_SIZE, SUPERPAGE_SIZE), BUFFER_SIZE) == nullptr);
+
+  BOOST_CHECK(getSuperpageError(Superpage(0, 0), BUFFER_SIZE) != nullptr);
+  BOOST_CHECK(getSuperpageError(Superpage(0, 1000), BUFFER_SIZE) != nullptr);
+  BOOST_CHECK(getSuperpageError(Superpage(BUFFER_SIZE, SUPERPAGE_SIZE), BUFFER_SIZE) != nullptr);
+  BOOST_CHECK(getSuperpageError(Superpage(2, SUPERPAGE_SIZE), BUFFER_SIZE) != nullptr);
+}
@@ -0,0 +1,150 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestSuperpageSizeReader.cxx
+/// \brief Tests for the reading of the CRU superpage size FIFO, against a fake BAR
+
+#define BOOST_TEST_MODULE RORC_TestSuperpageSizeReader
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <deque>
+#include "Cru/SuperpageSizeReader.h"
+
+using namespace o2::roc;
+
+namespace
+{
+constexpr uint32_t LINK = 2;
+
+/// BAR with the superpage size FIFO of one link. After a write pops an entry, the register keeps showing the previous
+/// one for a configurable amount of reads, like when the PCIe bus is not fast enough.
+class FakeSizeFifo : public RegisterReadWriteInterface
+{
+ public:
+  virtual uint32_t readRegister(int index) override
+  {
+    BOOST_REQUIRE_EQUAL(index, Cru::Registers::LINK_SUPERPAGE_SIZE.get(LINK).index);
+    if (staleReads > 0) {
+      staleReads--;
+    } else {
+      visible = popped;
+    }
+    return visible;
+  }
+
+  virtual void writeRegister(int index, uint32_t) override
+  {
+    BOOST_REQUIRE_EQUAL(index, Cru::Registers::LINK_SUPERPAGE_SIZE.get(LINK).index);
+    BOOST_REQUIRE(!entries.empty());
+    popped = entries.front();
+    entries.pop_front();
+    staleReads = lag;
+    writes++;
+  }
+
+  virtual void modifyRegister(int, int, int, uint32_t) override
+  {
+  }
+
+  /// Adds superpages completed by the firmware, with their index following the previous ones
+  void complete(size_t count, uint32_t size)
+  {
+    for (size_t i = 0; i < count; ++i) {
+      entries.push_back(size == 0 ? 0 : (size | (nextIndex << 24)));
+      nextIndex = (nextIndex + 1) % 256;
+    }
+  }
+
+  std::deque<uint32_t> entries;
+  uint32_t nextIndex = 0;
+  uint32_t popped = 0;
+  uint32_t visible = 0;
+  int lag = 0;
+  int staleReads = 0;
+  size_t writes = 0;
+};
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TestReadInOrder)
+{
+  FakeSizeFifo fifo;
+  SuperpageSizeReader reader(fifo);
+  SuperpageSizeReader::Statistics statistics;
+  uint32_t sizes[300];
+
+  // Enough superpages to wrap the 8-bit index around
+  for (int i = 0; i < 300; ++i) {
+    fifo.complete(1, 1000 + i);
+  }
+  BOOST_CHECK_EQUAL(reader.read(LINK, sizes, 100, statistics), 100);
+  BOOST_CHECK_EQUAL(reader.read(LINK, sizes + 100, 200, statistics), 200);
+  for (int i = 0; i < 300; ++i) {
+    BOOST_CHECK_EQUAL(sizes[i], 1000 + i);
+  }
+  BOOST_CHECK_EQUAL(statistics.reads, 300);
+  BOOST_CHECK_EQUAL(statistics.indexLags, 0);
+  BOOST_CHECK_EQUAL(fifo.writes, 300);
+}
+
+BOOST_AUTO_TEST_CASE(TestReadWithLag)
+{
+  FakeSizeFifo fifo;
+  fifo.lag = 3;
+  SuperpageSizeReader reader(fifo);
+  SuperpageSizeReader::Statistics statistics;
+  uint32_t sizes[4];
+
+  fifo.complete(4, 8192);
+  fifo.visible = 8192 | (200 << 24); // Stale entry with another index
+  BOOST_CHECK_EQUAL(reader.read(LINK, sizes, 4, statistics), 4);
+  BOOST_CHECK_EQUAL(statistics.indexLags, 3 * 4);
+  BOOST_CHECK_EQUAL(statistics.reads, 4 * 4);
+  BOOST_CHECK_EQUAL(statistics.budgetExhausted, 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestRetryBudget)
+{
+  FakeSizeFifo fifo;
+  fifo.lag = 10;
+  SuperpageSizeReader reader(fifo, 5);
+  SuperpageSizeReader::Statistics statistics;
+  uint32_t sizes[2];
+
+  fifo.complete(2, 4096);
+  fifo.visible = 4096 | (200 << 24); // Stale entry with another index
+  BOOST_CHECK_EQUAL(reader.read(LINK, sizes, 2, statistics), 0);
+  BOOST_CHECK_EQUAL(statistics.budgetExhausted, 1);
+  BOOST_CHECK_EQUAL(fifo.writes, 1);
+
+  // Once the lag is over, the next call resumes with the entry already popped, without skipping it
+  fifo.lag = 0;
+  BOOST_CHECK_EQUAL(reader.read(LINK, sizes, 2, statistics), 2);
+  BOOST_CHECK_EQUAL(fifo.writes, 2);
+  BOOST_CHECK_EQUAL(sizes[0], 4096);
+  BOOST_CHECK_EQUAL(sizes[1], 4096);
+  BOOST_CHECK(fifo.entries.empty());
+}
+
+BOOST_AUTO_TEST_CASE(TestSizeNotReported)
+{
+  // Firmware < v3.4.0 reports 0, without index
+  FakeSizeFifo fifo;
+  SuperpageSizeReader reader(fifo);
+  SuperpageSizeReader::Statistics statistics;
+  uint32_t sizes[3];
+
+  fifo.complete(3, 0);
+  BOOST_CHECK_EQUAL(reader.read(LINK, sizes, 3, statistics), 3);
+  BOOST_CHECK_EQUAL(sizes[0], 0);
+  BOOST_CHECK_EQUAL(sizes[2], 0);
+  BOOST_CHECK_EQUAL(statistics.indexLags, 0);
+}